@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/time.h> // Para gettimeofday
+
+// Lecturas de un entorno global compartido por varios hilos: tabla normal
+// protegida por un mutex frente a la tabla concurrente (zynkEnvInitConcurrent),
+// donde los lectores no toman ningún cerrojo. Un hilo escritor cambia valores
+// durante toda la medida.
+// Uso: bench-concurrent [hilos máximos] [segundos por medida]
+// Compilar: gcc -O2 -pthread bench-concurrent.c src/libzynk.a -o bench-concurrent
+#include "src/zynk.h"
+
+#define NUM_NAMES 1024
+#define WRITE_EVERY_US 100 // el escritor cambia un nombre cada 100 µs
+#define BATCH 256 // lecturas por sección de lectura
+
+static char names[NUM_NAMES][32];
+static ArenaManager manager;
+static ZynkEnv locked_env, concurrent_env;
+static pthread_mutex_t env_mutex = PTHREAD_MUTEX_INITIALIZER;
+static atomic_bool running;
+static atomic_long errors;
+
+static double now(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+typedef struct {
+    bool concurrent;
+    unsigned seed;
+    long reads;
+} Reader;
+
+static void *reader(void *arg) {
+    Reader *r = arg;
+    ZynkRcuReader *slot = r->concurrent ? zynkRcuRegister(&concurrent_env) : NULL;
+    if (r->concurrent && slot == NULL) {
+        fprintf(stderr, "Error: no quedan huecos de lector.\n");
+        return NULL;
+    }
+    long reads = 0;
+    // una sección de lectura por lote, como la que abriría un hilo por petición
+    while (atomic_load_explicit(&running, memory_order_relaxed)) {
+        if (r->concurrent) zynkRcuReadLock(slot);
+        for (int i = 0; i < BATCH; ++i) {
+            const char *name = names[rand_r(&r->seed) % NUM_NAMES];
+            Value v;
+            if (r->concurrent) {
+                v = zynkTableGet(&concurrent_env, name);
+            } else {
+                pthread_mutex_lock(&env_mutex);
+                v = zynkTableGet(&locked_env, name);
+                pthread_mutex_unlock(&env_mutex);
+            }
+            if (v.type != ZYNK_NUMBER) atomic_fetch_add(&errors, 1);
+        }
+        if (r->concurrent) zynkRcuReadUnlock(slot);
+        reads += BATCH;
+    }
+    zynkRcuUnregister(slot);
+    r->reads = reads;
+    return NULL;
+}
+
+static void *writer(void *arg) {
+    bool concurrent = *(bool *)arg;
+    ZynkRcuReader *slot = concurrent ? zynkRcuRegister(&concurrent_env) : NULL;
+    unsigned seed = 7;
+    struct timespec pause = {0, WRITE_EVERY_US * 1000};
+    while (atomic_load_explicit(&running, memory_order_relaxed)) {
+        nanosleep(&pause, NULL);
+        const char *name = names[rand_r(&seed) % NUM_NAMES];
+        Value v = zynkNumber(rand_r(&seed));
+        if (concurrent) {
+            zynkRcuReadLock(slot);
+            zynkTableSet(&manager, &concurrent_env, name, v);
+            zynkRcuReadUnlock(slot);
+        } else {
+            pthread_mutex_lock(&env_mutex);
+            zynkTableSet(&manager, &locked_env, name, v);
+            pthread_mutex_unlock(&env_mutex);
+        }
+    }
+    zynkRcuUnregister(slot);
+    return NULL;
+}
+
+static double measure(bool concurrent, int threads, double seconds) {
+    pthread_t ids[64], writer_id;
+    Reader readers[64];
+    atomic_store(&running, true);
+    pthread_create(&writer_id, NULL, writer, &concurrent);
+    for (int t = 0; t < threads; ++t) {
+        readers[t].concurrent = concurrent;
+        readers[t].seed = (unsigned)t + 1;
+        readers[t].reads = 0;
+        pthread_create(&ids[t], NULL, reader, &readers[t]);
+    }
+    double start = now();
+    while (now() - start < seconds) {
+        struct timespec ts = {0, 10000000};
+        nanosleep(&ts, NULL);
+    }
+    atomic_store(&running, false);
+    long total = 0;
+    for (int t = 0; t < threads; ++t) {
+        pthread_join(ids[t], NULL);
+        total += readers[t].reads;
+    }
+    pthread_join(writer_id, NULL);
+    return total / (now() - start) / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+    int max_threads = argc > 1 ? atoi(argv[1]) : 8;
+    double seconds = argc > 2 ? atof(argv[2]) : 1.0;
+    if (max_threads < 1 || max_threads > 63 || seconds <= 0) {
+        fprintf(stderr, "Uso: %s [hilos máximos (1-63)] [segundos por medida]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    size_t memory_size = 256 * 1024 * 1024;
+    size_t num_arenas = 1 << 14;
+    uint8_t *memory = malloc(memory_size);
+    Arena *arenas = malloc(sizeof(Arena) * num_arenas);
+    if (memory == NULL || arenas == NULL || !sysarena_init(&manager, memory, arenas, memory_size, num_arenas)) {
+        fprintf(stderr, "Error: Fallo en la asignación de memoria.\n");
+        return EXIT_FAILURE;
+    }
+    locked_env.local = NULL;
+    if (!zynkEnvInit(&locked_env, NUM_NAMES * 2, NULL, &manager) ||
+        !zynkEnvInitConcurrent(&concurrent_env, NULL, &manager)) {
+        fprintf(stderr, "Error: no se pudo crear el entorno.\n");
+        return EXIT_FAILURE;
+    }
+    static const char *name_list[NUM_NAMES];
+    static Value values[NUM_NAMES];
+    size_t made = 0;
+    for (int i = 0; i < NUM_NAMES; ++i) {
+        sprintf(names[i], "config_%d", i);
+        name_list[i] = names[i];
+        values[i] = zynkNumber(i);
+        made += zynkTableNew(&concurrent_env, names[i], values[i], &manager);
+    }
+    if (made != NUM_NAMES || zynkTableNewMany(&locked_env, name_list, values, NUM_NAMES, &manager) != NUM_NAMES) {
+        fprintf(stderr, "Error: no caben los nombres en las arenas.\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("--- %d nombres, una escritura cada %d µs ---\n", NUM_NAMES, WRITE_EVERY_US);
+    printf("%6s %16s %16s\n", "hilos", "mutex (M/s)", "RCU (M/s)");
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        double locked = measure(false, threads, seconds);
+        double rcu = measure(true, threads, seconds);
+        printf("%6d %16.2f %16.2f\n", threads, locked, rcu);
+    }
+    long bad = atomic_load(&errors);
+    if (bad != 0) {
+        printf("Error: %ld lecturas no devolvieron un número.\n", bad);
+        return EXIT_FAILURE;
+    }
+    printf("Todas las lecturas devolvieron un número.\n");
+    return EXIT_SUCCESS;
+}
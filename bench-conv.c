@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/time.h> // Para gettimeofday
+
+// Compara tostring/tonumber (src/runtime/convert.c) con el camino de libc:
+// snprintf + zynkCreateString y strtod.
+// Compilar: gcc -O2 bench-conv.c src/libzynk.a -o bench-conv
+#include "src/zynk.h"
+
+#define MEMORY_SIZE (1 << 20)
+#define NUM_ARENAS 4096
+// cada cadena ocupa 3 arenas y sysarena no reutiliza lo liberado,
+// así que se reinicia el gestor cada BATCH cadenas
+#define BATCH 1000
+
+static double now(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint64_t next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+int main(int argc, char *argv[]) {
+    unsigned long count = 1000000;
+    if (argc == 2) count = strtoul(argv[1], NULL, 10);
+    if (count == 0) {
+        fprintf(stderr, "Uso: %s [num_numeros]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    ArenaManager manager;
+    uint8_t *memory = malloc(MEMORY_SIZE);
+    Arena *arenas = malloc(sizeof(Arena) * NUM_ARENAS);
+    double *numbers = malloc(sizeof(double) * count);
+    char (*texts)[32] = malloc(32 * count);
+    if (memory == NULL || arenas == NULL || numbers == NULL || texts == NULL) {
+        fprintf(stderr, "Error: Fallo en la asignación de memoria.\n");
+        return EXIT_FAILURE;
+    }
+
+    // mitad enteros, mitad decimales "de usuario"
+    for (unsigned long i = 0; i < count; ++i) {
+        if (i & 1) numbers[i] = (double)(next_random() % 100000);
+        else numbers[i] = (double)(next_random() % 10000000) / 1000.0;
+        snprintf(texts[i], sizeof(texts[i]), "%.15g", numbers[i]);
+    }
+
+    printf("--- Conversión de %lu números ---\n", count);
+
+    double start = now();
+    size_t total_len = 0;
+    for (unsigned long i = 0; i < count; ++i) {
+        char text[32];
+        snprintf(text, sizeof(text), "%.17g", numbers[i]);
+        if (i % BATCH == 0) sysarena_init(&manager, memory, arenas, MEMORY_SIZE, NUM_ARENAS);
+        Value str = zynkCreateString(&manager, text);
+        total_len += str.as.obj->obj.string->len;
+    }
+    double libc_format = now() - start;
+
+    start = now();
+    size_t zynk_len_total = 0;
+    for (unsigned long i = 0; i < count; ++i) {
+        if (i % BATCH == 0) sysarena_init(&manager, memory, arenas, MEMORY_SIZE, NUM_ARENAS);
+        Value str = zynkNumberToString(&manager, numbers[i]);
+        zynk_len_total += str.as.obj->obj.string->len;
+    }
+    double zynk_format = now() - start;
+
+    // solo el formateo, sin crear cadenas
+    start = now();
+    for (unsigned long i = 0; i < count; ++i) {
+        char text[32];
+        total_len += snprintf(text, sizeof(text), "%.17g", numbers[i]);
+    }
+    double libc_digits = now() - start;
+
+    start = now();
+    for (unsigned long i = 0; i < count; ++i) {
+        char text[ZYNK_NUMBER_CHARS];
+        zynk_len_total += zynk_format_number(numbers[i], text);
+    }
+    double zynk_digits = now() - start;
+
+    start = now();
+    double sum_libc = 0;
+    for (unsigned long i = 0; i < count; ++i) {
+        sum_libc += strtod(texts[i], NULL);
+    }
+    double libc_parse = now() - start;
+
+    start = now();
+    double sum_zynk = 0;
+    for (unsigned long i = 0; i < count; ++i) {
+        double value;
+        if (zynk_parse_number(texts[i], strlen(texts[i]), &value)) sum_zynk += value;
+    }
+    double zynk_parse = now() - start;
+
+    printf("snprintf + zynkCreateString: %.3f s\n", libc_format);
+    printf("zynkNumberToString:          %.3f s\n", zynk_format);
+    printf("snprintf (solo):             %.3f s\n", libc_digits);
+    printf("zynk_format_number (solo):   %.3f s\n", zynk_digits);
+    printf("strtod:                      %.3f s\n", libc_parse);
+    printf("zynk_parse_number:           %.3f s\n", zynk_parse);
+    printf("Bytes: %zu (libc) %zu (zynk)\n", total_len, zynk_len_total);
+    printf("Sumas (deben coincidir): %.17g %.17g\n", sum_libc, sum_zynk);
+
+    free(texts);
+    free(numbers);
+    free(arenas);
+    free(memory);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <sys/time.h> // Para gettimeofday
+
+// zynk_hash_bytes (wyhash con semilla) frente al DJB2 anterior:
+// rendimiento por longitud y longitud de sondeo en una tabla de
+// direccionamiento abierto como la de ZynkEnvTable (índice = hash % cap).
+// Uso: bench-hash [ficheros de código de los que sacar identificadores]
+// Compilar: gcc -O2 bench-hash.c src/libzynk.a -o bench-hash
+#include "src/zynk.h"
+
+#define MAX_IDENTS 100000
+#define CAPACITY 1024
+#define ADVERSARIAL 600
+
+static double now(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+// el hash de antes, tal cual
+static uint32_t djb2_old(const char *str, uint32_t len) {
+    unsigned long hash = 5381;
+    for (uint32_t i = 0; i < len; ++i) {
+        int c = (unsigned char)str[i];
+        hash = ((hash << 5) + hash) ^ (c ^ (c << 8) ^ (c << 16) ^ (c << 24));
+    }
+    return hash;
+}
+
+static uint32_t zynk_new(const char *str, uint32_t len) {
+    return zynk_hash_bytes(str, len);
+}
+
+typedef uint32_t (*HashFn)(const char *str, uint32_t len);
+
+static char *idents[MAX_IDENTS];
+static size_t num_idents = 0;
+
+static int seen(const char *name) {
+    for (size_t i = 0; i < num_idents; ++i) {
+        if (strcmp(idents[i], name) == 0) return 1;
+    }
+    return 0;
+}
+
+static void load_identifiers(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        fprintf(stderr, "Aviso: no se puede abrir %s\n", path);
+        return;
+    }
+    char word[128];
+    size_t len = 0;
+    int c;
+    while ((c = fgetc(f)) != EOF && num_idents < MAX_IDENTS) {
+        if (isalnum(c) || c == '_') {
+            if (len < sizeof(word) - 1) word[len++] = (char)c;
+            continue;
+        }
+        if (len > 0 && !isdigit((unsigned char)word[0])) {
+            word[len] = '\0';
+            if (!seen(word)) idents[num_idents++] = strdup(word);
+        }
+        len = 0;
+    }
+    fclose(f);
+}
+
+// inserta n claves y devuelve el histograma de sondeos por clave
+static void probe_stats(const char *label, HashFn hash, char **keys, size_t n) {
+    static const char *table[CAPACITY];
+    size_t histogram[6] = {0}; // 1, 2, 3-4, 5-8, 9-16, >16
+    size_t total = 0, worst = 0;
+    for (size_t i = 0; i < CAPACITY; ++i) table[i] = NULL;
+
+    for (size_t k = 0; k < n; ++k) {
+        uint32_t index = hash(keys[k], (uint32_t)strlen(keys[k])) % CAPACITY;
+        size_t probes = 1;
+        while (table[index] != NULL) {
+            index = (index + 1) % CAPACITY;
+            probes++;
+        }
+        table[index] = keys[k];
+        total += probes;
+        if (probes > worst) worst = probes;
+        int bucket = probes <= 1 ? 0 : probes <= 2 ? 1 : probes <= 4 ? 2 : probes <= 8 ? 3 : probes <= 16 ? 4 : 5;
+        histogram[bucket]++;
+    }
+    printf("  %-6s media %6.2f  máx %5zu  |", label, (double)total / n, worst);
+    for (int b = 0; b < 6; ++b) printf(" %5.1f%%", 100.0 * histogram[b] / n);
+    printf("\n");
+}
+
+int main(int argc, char *argv[]) {
+    const char *default_files[] = {
+        "src/runtime/funcs.c", "src/runtime/search.c", "src/runtime/sort.c", "src/runtime/map.c",
+        "src/runtime/memory.c", "src/runtime/convert.c", "src/runtime/utf8.c", "src/runtime/memo.c",
+        "src/runtime/zynk_enviroment.c", "src/runtime/object_mng.c", "README.md",
+    };
+    if (argc > 1) {
+        for (int i = 1; i < argc; ++i) load_identifiers(argv[i]);
+    } else {
+        for (size_t i = 0; i < sizeof(default_files) / sizeof(default_files[0]); ++i) load_identifiers(default_files[i]);
+    }
+    printf("Semilla: %016llx\n", (unsigned long long)zynk_hash_get_seed());
+
+    // --- rendimiento ---
+    printf("--- Rendimiento (GB/s) ---\n%8s %10s %10s\n", "bytes", "djb2", "wyhash");
+    static char data[4096];
+    for (size_t i = 0; i < sizeof(data); ++i) data[i] = (char)('a' + i % 26);
+    size_t lengths[] = {4, 8, 16, 32, 64, 256, 4096};
+    volatile uint32_t sink = 0;
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); ++l) {
+        uint32_t len = (uint32_t)lengths[l];
+        unsigned long reps = (1ul << 28) / len;
+        if (reps > 20000000) reps = 20000000;
+        double t[2];
+        HashFn fns[2] = {djb2_old, zynk_new};
+        for (int f = 0; f < 2; ++f) {
+            double start = now();
+            for (unsigned long r = 0; r < reps; ++r) sink += fns[f](data + (r & 7), len - (r & 7 && len > 8 ? 1 : 0));
+            t[f] = now() - start;
+        }
+        printf("%8u %10.2f %10.2f\n", len, (double)len * reps / t[0] / 1e9, (double)len * reps / t[1] / 1e9);
+    }
+
+    // --- identificadores reales ---
+    if (num_idents == 0) {
+        fprintf(stderr, "Error: no hay identificadores.\n");
+        return EXIT_FAILURE;
+    }
+    printf("--- Sondeos, %zu identificadores, tabla de %d ---\n", num_idents, CAPACITY);
+    printf("  %-6s %6s %6s %6s  | %6s %6s %6s %6s %6s %6s\n", "", "", "", "", "1", "2", "3-4", "5-8", "9-16", ">16");
+    size_t loads[] = {CAPACITY / 2, CAPACITY * 3 / 4, CAPACITY * 9 / 10};
+    for (size_t l = 0; l < 3; ++l) {
+        size_t n = loads[l] < num_idents ? loads[l] : num_idents;
+        printf(" carga %.0f%% (%zu claves):\n", 100.0 * n / CAPACITY, n);
+        probe_stats("djb2", djb2_old, idents, n);
+        probe_stats("wyhash", zynk_new, idents, n);
+    }
+
+    // --- claves elegidas para colisionar con djb2 ---
+    static char *evil[ADVERSARIAL];
+    size_t found = 0;
+    char name[16];
+    srand(1);
+    while (found < ADVERSARIAL) {
+        int len = 6 + rand() % 6;
+        name[0] = 'v';
+        for (int i = 1; i < len; ++i) name[i] = "abcdefghijklmnopqrstuvwxyz_0123456789"[rand() % 37];
+        name[len] = '\0';
+        if (djb2_old(name, (uint32_t)len) % CAPACITY == 0) evil[found++] = strdup(name);
+    }
+    printf("--- %d claves con djb2 %% %d == 0 (sin conocer la semilla) ---\n", ADVERSARIAL, CAPACITY);
+    probe_stats("djb2", djb2_old, evil, ADVERSARIAL);
+    probe_stats("wyhash", zynk_new, evil, ADVERSARIAL);
+
+    (void)sink;
+    return EXIT_SUCCESS;
+}
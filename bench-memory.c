@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/time.h> // Para gettimeofday
+
+// Primitivas de memoria de zynk (memory.c) frente a las de libc, con
+// tamaños de 1 B a 1 MB.
+// Compilar: gcc -O2 bench-memory.c src/libzynk.a -o bench-memory
+#include "src/zynk.h"
+
+#define MAX_SIZE (1 << 20)
+#define BYTES_PER_TEST (1u << 28) // ~256 MB movidos por medida
+
+static double now(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static volatile uint64_t sink; // evita que el compilador borre los bucles
+
+static double gbps(size_t size, unsigned long reps, double seconds) {
+    return (double)size * reps / seconds / 1e9;
+}
+
+int main(void) {
+    uint8_t *src = malloc(MAX_SIZE + 64);
+    uint8_t *dst = malloc(MAX_SIZE + 64);
+    if (src == NULL || dst == NULL) {
+        fprintf(stderr, "Error: Fallo en la asignación de memoria.\n");
+        return EXIT_FAILURE;
+    }
+    for (size_t i = 0; i < MAX_SIZE + 64; ++i) src[i] = (uint8_t)('a' + i % 26);
+    memcpy(dst, src, MAX_SIZE + 64);
+
+    zynk_memory_init();
+    printf("--- Implementación elegida: %s ---\n", zynk_memory_impl());
+    printf("%8s | %9s %9s | %9s %9s | %9s %9s | %9s %9s\n", "tamaño",
+           "zynk_cpy", "memcpy", "zynk_move", "memmove", "zynk_cmp", "memcmp", "zynk_len", "strlen");
+
+    for (size_t size = 1; size <= MAX_SIZE; size *= 4) {
+        unsigned long reps = BYTES_PER_TEST / size;
+        if (reps > 20000000) reps = 20000000;
+        double t[8];
+        double start;
+
+        start = now();
+        for (unsigned long r = 0; r < reps; ++r) { zynk_cpy(dst + (r & 7), src, (uint32_t)size); sink += dst[0]; }
+        t[0] = now() - start;
+        start = now();
+        for (unsigned long r = 0; r < reps; ++r) { memcpy(dst + (r & 7), src, size); sink += dst[0]; }
+        t[1] = now() - start;
+
+        start = now();
+        for (unsigned long r = 0; r < reps; ++r) { zynk_move(dst + 1, dst, (uint32_t)size); sink += dst[1]; }
+        t[2] = now() - start;
+        start = now();
+        for (unsigned long r = 0; r < reps; ++r) { memmove(dst + 1, dst, size); sink += dst[1]; }
+        t[3] = now() - start;
+
+        memcpy(dst, src, size);
+        start = now();
+        for (unsigned long r = 0; r < reps; ++r) sink += zynk_strcmp((const char *)dst, (const char *)src, (uint32_t)size);
+        t[4] = now() - start;
+        start = now();
+        for (unsigned long r = 0; r < reps; ++r) sink += memcmp(dst, src, size);
+        t[5] = now() - start;
+
+        dst[size] = '\0';
+        start = now();
+        for (unsigned long r = 0; r < reps; ++r) sink += zynk_len((const char *)dst, '\0');
+        t[6] = now() - start;
+        start = now();
+        for (unsigned long r = 0; r < reps; ++r) sink += strlen((const char *)dst);
+        t[7] = now() - start;
+
+        printf("%8zu |", size);
+        for (int i = 0; i < 8; ++i) printf(" %7.2f%s", gbps(size, reps, t[i]), (i % 2) ? " |" : "  ");
+        printf("\n");
+    }
+    printf("(GB/s)\n");
+
+    free(src);
+    free(dst);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <sys/time.h> // Para gettimeofday
+
+// Bucle de intérprete típico (contador, comparación, suma) con la API de
+// Value fuera de línea y con su versión static inline (value_inline.h).
+// Compilar: gcc -O2 bench-values.c src/libzynk.a -o bench-values
+#include "src/zynk.h"
+
+static double now(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+// Los paréntesis en el nombre evitan la macro: llamada real a la biblioteca
+static Value loop_calls(long iterations) {
+    Value sum = (zynkNumber)(0);
+    Value step = (zynkNumber)(1.5);
+    Value limit = (zynkNumber)((double)iterations);
+    for (Value i = (zynkNumber)(0); (zynkValuesLess)(i, limit); i = (zynkValuesAdd)(i, (zynkNumber)(1))) {
+        sum = (zynkValuesAdd)(sum, (zynkValuesMul)(i, step));
+        if ((zynkValuesGreater)(sum, (zynkNumber)(1e12))) sum = (zynkValuesSub)(sum, (zynkNumber)(1e12));
+    }
+    return sum;
+}
+
+static Value loop_inline(long iterations) {
+    Value sum = zynkNumber(0);
+    Value step = zynkNumber(1.5);
+    Value limit = zynkNumber((double)iterations);
+    for (Value i = zynkNumber(0); zynkValuesLess(i, limit); i = zynkValuesAdd(i, zynkNumber(1))) {
+        sum = zynkValuesAdd(sum, zynkValuesMul(i, step));
+        if (zynkValuesGreater(sum, zynkNumber(1e12))) sum = zynkValuesSub(sum, zynkNumber(1e12));
+    }
+    return sum;
+}
+
+int main(int argc, char *argv[]) {
+    long iterations = 100000000;
+    if (argc == 2) iterations = strtol(argv[1], NULL, 10);
+    if (iterations <= 0) {
+        fprintf(stderr, "Uso: %s [iteraciones]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+#ifndef ZYNK_INLINE_VALUES
+    printf("Aviso: ZYNK_INLINE_VALUES está desactivado en common.h, ambos bucles llaman a la biblioteca.\n");
+#endif
+
+    printf("--- %ld iteraciones ---\n", iterations);
+
+    double start = now();
+    Value a = loop_calls(iterations);
+    double calls = now() - start;
+
+    start = now();
+    Value b = loop_inline(iterations);
+    double inlined = now() - start;
+
+    printf("Fuera de línea: %.3f s (%.1f M iter/s)\n", calls, iterations / calls / 1e6);
+    printf("Inline:         %.3f s (%.1f M iter/s)\n", inlined, iterations / inlined / 1e6);
+    printf("Resultados (deben coincidir): %.17g %.17g\n", a.as.number, b.as.number);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,317 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/time.h> // Para gettimeofday
+
+// Los mismos programas en la máquina virtual de registros (zynkCreateFunction)
+// y en un intérprete que recorre el árbol sintáctico, como el que un programa
+// anfitrión montaría sobre la API de entornos: cada variable es un nombre en
+// la tabla del marco de la llamada (zynkFramePush) y cada operación es un nodo.
+// Donde hay JIT (x86-64) también se mide el código nativo (zynkCompileFunction).
+// Uso: bench-vm [repeticiones]
+// Compilar: gcc -O2 bench-vm.c src/libzynk.a -o bench-vm
+#include "src/zynk.h"
+
+#define LOOP_N 1000000
+#define FIB_N 24
+#define ARRAY_N 100000
+
+static ArenaManager manager;
+static ZynkEnv globals;
+static ZynkFramePool pool;
+
+static double now(void) {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+// --- Intérprete de árbol ---
+
+typedef enum { N_NUM, N_VAR, N_SET, N_BIN, N_WHILE, N_IF, N_BLOCK, N_RETURN, N_CALL, N_INDEX } Kind;
+
+typedef struct Node {
+    Kind kind;
+    char op; // N_BIN: + - * <
+    double num;
+    const char *name;
+    struct Node *a, *b, *c;
+    struct Node **list;
+    int len;
+} Node;
+
+typedef struct {
+    const char *name;
+    const char *params[4];
+    int arity;
+    Node *body;
+} AstFunction;
+
+static AstFunction ast_funcs[8];
+static int ast_count;
+
+static Node *node(Kind kind) {
+    Node *n = calloc(1, sizeof(Node));
+    n->kind = kind;
+    return n;
+}
+static Node *num(double v) { Node *n = node(N_NUM); n->num = v; return n; }
+static Node *var(const char *name) { Node *n = node(N_VAR); n->name = name; return n; }
+static Node *set(const char *name, Node *v) { Node *n = node(N_SET); n->name = name; n->a = v; return n; }
+static Node *bin(char op, Node *a, Node *b) { Node *n = node(N_BIN); n->op = op; n->a = a; n->b = b; return n; }
+static Node *loop(Node *cond, Node *body) { Node *n = node(N_WHILE); n->a = cond; n->b = body; return n; }
+static Node *cond(Node *c, Node *then) { Node *n = node(N_IF); n->a = c; n->b = then; return n; }
+static Node *ret(Node *v) { Node *n = node(N_RETURN); n->a = v; return n; }
+static Node *index_of(Node *a, Node *i) { Node *n = node(N_INDEX); n->a = a; n->b = i; return n; }
+static Node *call1(const char *name, Node *arg) { Node *n = node(N_CALL); n->name = name; n->a = arg; return n; }
+static Node *block(int len, Node **items) {
+    Node *n = node(N_BLOCK);
+    n->len = len;
+    n->list = malloc(sizeof(Node *) * len);
+    memcpy(n->list, items, sizeof(Node *) * len);
+    return n;
+}
+
+static Value ast_call(const char *name, Value *args, int argc);
+
+// devuelve true cuando se ejecuta un return
+static bool exec(Node *n, ZynkEnv *env, Value *out) {
+    switch (n->kind) {
+        case N_NUM: *out = zynkNumber(n->num); return false;
+        case N_VAR: *out = zynkTableGet(env, n->name); return false;
+        case N_SET: {
+            Value v;
+            exec(n->a, env, &v);
+            if (!zynkTableSet(&manager, env, n->name, v)) zynkTableNew(env, n->name, v, &manager);
+            return false;
+        }
+        case N_BIN: {
+            Value a, b;
+            exec(n->a, env, &a);
+            exec(n->b, env, &b);
+            switch (n->op) {
+                case '+': *out = zynkValuesAdd(a, b); break;
+                case '-': *out = zynkValuesSub(a, b); break;
+                case '*': *out = zynkValuesMul(a, b); break;
+                default: *out = zynkBool(zynkValuesLess(a, b)); break;
+            }
+            return false;
+        }
+        case N_WHILE: {
+            Value c;
+            for (exec(n->a, env, &c); zynkValuesTrue(c); exec(n->a, env, &c)) {
+                if (exec(n->b, env, out)) return true;
+            }
+            return false;
+        }
+        case N_IF: {
+            Value c;
+            exec(n->a, env, &c);
+            return zynkValuesTrue(c) && exec(n->b, env, out);
+        }
+        case N_BLOCK:
+            for (int i = 0; i < n->len; ++i) {
+                if (exec(n->list[i], env, out)) return true;
+            }
+            return false;
+        case N_RETURN: exec(n->a, env, out); return true;
+        case N_INDEX: {
+            Value a, i;
+            exec(n->a, env, &a);
+            exec(n->b, env, &i);
+            *out = zynkArrayGet(a, i);
+            return false;
+        }
+        case N_CALL: {
+            Value arg;
+            exec(n->a, env, &arg);
+            *out = ast_call(n->name, &arg, 1);
+            return false;
+        }
+    }
+    return false;
+}
+
+static Value ast_call(const char *name, Value *args, int argc) {
+    AstFunction *f = NULL;
+    for (int i = 0; i < ast_count; ++i) {
+        if (strcmp(ast_funcs[i].name, name) == 0) f = &ast_funcs[i];
+    }
+    ZynkEnv frame;
+    if (f == NULL || argc != f->arity || !zynkFramePush(&pool, &frame, &globals)) return zynkNull();
+    for (int i = 0; i < argc; ++i) zynkTableNew(&frame, f->params[i], args[i], &manager);
+    Value result = zynkNull();
+    exec(f->body, &frame, &result);
+    zynkFramePop(&pool, &frame);
+    return result;
+}
+
+static void ast_define(const char *name, const char *p0, const char *p1, Node *body) {
+    AstFunction *f = &ast_funcs[ast_count++];
+    f->name = name;
+    f->params[0] = p0;
+    f->params[1] = p1;
+    f->arity = p1 != NULL ? 2 : 1;
+    f->body = body;
+}
+
+static void build_ast(void) {
+    // sum(n): s=0; i=0; while (i<n) { s=s+i*2; i=i+1 } return s
+    Node *sum_loop[] = {set("s", bin('+', var("s"), bin('*', var("i"), num(2)))), set("i", bin('+', var("i"), num(1)))};
+    Node *sum_body[] = {set("s", num(0)), set("i", num(0)), loop(bin('<', var("i"), var("n")), block(2, sum_loop)), ret(var("s"))};
+    ast_define("sum", "n", NULL, block(4, sum_body));
+    // fib(n): if (n<2) return n; return fib(n-1)+fib(n-2)
+    Node *fib_body[] = {cond(bin('<', var("n"), num(2)), ret(var("n"))),
+                        ret(bin('+', call1("fib", bin('-', var("n"), num(1))), call1("fib", bin('-', var("n"), num(2)))))};
+    ast_define("fib", "n", NULL, block(2, fib_body));
+    // asum(a, n): s=0; i=0; while (i<n) { s=s+a[i]; i=i+1 } return s
+    Node *asum_loop[] = {set("s", bin('+', var("s"), index_of(var("a"), var("i")))), set("i", bin('+', var("i"), num(1)))};
+    Node *asum_body[] = {set("s", num(0)), set("i", num(0)), loop(bin('<', var("i"), var("n")), block(2, asum_loop)), ret(var("s"))};
+    ast_define("asum", "a", "n", block(4, asum_body));
+}
+
+// --- Los mismos programas en bytecode ---
+
+static Value vm_sum, vm_fib, vm_asum;
+static Value jit_sum, jit_fib, jit_asum;
+static bool with_jit;
+
+// con jit el código se compila, sin él las funciones se quedan en la VM
+static bool build_vm(bool jit, Value *sum, Value *fib, Value *asum) {
+    Value sum_k[] = {zynkNumber(0), zynkNumber(2), zynkNumber(1)};
+    // R0=n R1=s R2=i R3=temporal R4=2 R5=1
+    uint32_t sum_code[] = {
+        ZYNK_ABX(ZYNK_OP_LOADK, 1, 0),
+        ZYNK_ABX(ZYNK_OP_LOADK, 2, 0),
+        ZYNK_ABX(ZYNK_OP_LOADK, 4, 1),
+        ZYNK_ABX(ZYNK_OP_LOADK, 5, 2),
+        ZYNK_ABC(ZYNK_OP_LT, 3, 2, 0),
+        ZYNK_ABX(ZYNK_OP_JMPIFNOT, 3, 4),
+        ZYNK_ABC(ZYNK_OP_MUL, 3, 2, 4),
+        ZYNK_ABC(ZYNK_OP_ADD, 1, 1, 3),
+        ZYNK_ABC(ZYNK_OP_ADD, 2, 2, 5),
+        ZYNK_ABX(ZYNK_OP_JMP, 0, -6),
+        ZYNK_ABC(ZYNK_OP_RETURN, 1, 0, 0),
+    };
+    *sum = zynkCreateFunction(&manager, "sum", 1, 6, sum_code, 11, sum_k, 3);
+
+    Value fib_name = zynkCreateString(&manager, "fib");
+    Value fib_k[] = {zynkNumber(2), zynkNumber(1), fib_name};
+    // R0=n R1=constante R2=resultado R3=fib R4=argumento R5=fib(n-2)
+    uint32_t fib_code[] = {
+        ZYNK_ABX(ZYNK_OP_LOADK, 1, 0),
+        ZYNK_ABC(ZYNK_OP_LT, 2, 0, 1),
+        ZYNK_ABX(ZYNK_OP_JMPIFNOT, 2, 1),
+        ZYNK_ABC(ZYNK_OP_RETURN, 0, 0, 0),
+        ZYNK_ABX(ZYNK_OP_GETGLOBAL, 3, 2),
+        ZYNK_ABX(ZYNK_OP_LOADK, 1, 1),
+        ZYNK_ABC(ZYNK_OP_SUB, 4, 0, 1),
+        ZYNK_ABC(ZYNK_OP_CALL, 2, 3, 1),
+        ZYNK_ABX(ZYNK_OP_GETGLOBAL, 3, 2),
+        ZYNK_ABX(ZYNK_OP_LOADK, 1, 0),
+        ZYNK_ABC(ZYNK_OP_SUB, 4, 0, 1),
+        ZYNK_ABC(ZYNK_OP_CALL, 5, 3, 1),
+        ZYNK_ABC(ZYNK_OP_ADD, 2, 2, 5),
+        ZYNK_ABC(ZYNK_OP_RETURN, 2, 0, 0),
+    };
+    *fib = zynkCreateFunction(&manager, "fib", 1, 6, fib_code, 14, fib_k, 3);
+    zynk_release(fib_name, &manager);
+
+    Value asum_k[] = {zynkNumber(0), zynkNumber(1)};
+    // R0=a R1=n R2=s R3=i R4=temporal R5=1
+    uint32_t asum_code[] = {
+        ZYNK_ABX(ZYNK_OP_LOADK, 2, 0),
+        ZYNK_ABX(ZYNK_OP_LOADK, 3, 0),
+        ZYNK_ABX(ZYNK_OP_LOADK, 5, 1),
+        ZYNK_ABC(ZYNK_OP_LT, 4, 3, 1),
+        ZYNK_ABX(ZYNK_OP_JMPIFNOT, 4, 4),
+        ZYNK_ABC(ZYNK_OP_GETINDEX, 4, 0, 3),
+        ZYNK_ABC(ZYNK_OP_ADD, 2, 2, 4),
+        ZYNK_ABC(ZYNK_OP_ADD, 3, 3, 5),
+        ZYNK_ABX(ZYNK_OP_JMP, 0, -6),
+        ZYNK_ABC(ZYNK_OP_RETURN, 2, 0, 0),
+    };
+    *asum = zynkCreateFunction(&manager, "asum", 2, 6, asum_code, 10, asum_k, 2);
+    if (sum->type != ZYNK_OBJ || fib->type != ZYNK_OBJ || asum->type != ZYNK_OBJ) return false;
+    Value all[] = {*sum, *fib, *asum};
+    for (int i = 0; i < 3; ++i) {
+        if (jit) {
+            if (!zynkCompileFunction(&manager, all[i])) return false;
+        } else {
+            all[i].as.obj->obj.function->calls = ZYNK_JIT_THRESHOLD; // nunca se compila
+        }
+    }
+    return true;
+}
+
+// fib se llama a sí misma a través del global
+static void use_fib(Value fib) {
+    if (!zynkTableSet(&manager, &globals, "fib", fib)) zynkTableNew(&globals, "fib", fib, &manager);
+}
+
+static bool same_number(Value a, Value b) {
+    return a.type == ZYNK_NUMBER && b.type == ZYNK_NUMBER && a.as.number == b.as.number;
+}
+
+// milisegundos por llamada
+static double measure(Value func, Value *args, int argc, int reps, Value *result) {
+    double start = now();
+    for (int r = 0; r < reps; ++r) *result = zynkCallValue(&manager, &globals, func, argc, args);
+    return (now() - start) / reps * 1000;
+}
+
+static void compare(const char *label, const char *name, Value *args, int argc, Value vm_func, Value jit_func, int reps) {
+    Value ast_result = zynkNull(), vm_result, jit_result;
+    double start = now();
+    for (int r = 0; r < reps; ++r) ast_result = ast_call(name, args, argc);
+    double ast_time = (now() - start) / reps * 1000;
+    if (vm_func.as.obj == vm_fib.as.obj) use_fib(vm_fib);
+    double vm_time = measure(vm_func, args, argc, reps, &vm_result);
+    bool same = same_number(ast_result, vm_result);
+    printf("%-22s %12.2f %12.2f %8.1fx", label, ast_time, vm_time, ast_time / vm_time);
+    if (with_jit) {
+        if (jit_func.as.obj == jit_fib.as.obj) use_fib(jit_fib);
+        double jit_time = measure(jit_func, args, argc, reps, &jit_result);
+        same = same && same_number(ast_result, jit_result);
+        printf(" %12.2f %8.1fx", jit_time, ast_time / jit_time);
+    }
+    printf("  %s\n", same ? "" : "ERROR: resultados distintos");
+}
+
+int main(int argc, char *argv[]) {
+    int reps = argc > 1 ? atoi(argv[1]) : 3;
+    if (reps < 1) {
+        fprintf(stderr, "Uso: %s [repeticiones]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    size_t memory_size = 64 * 1024 * 1024;
+    size_t num_arenas = 1 << 14;
+    uint8_t *memory = malloc(memory_size);
+    Arena *arenas = malloc(sizeof(Arena) * num_arenas);
+    if (memory == NULL || arenas == NULL || !sysarena_init(&manager, memory, arenas, memory_size, num_arenas)) {
+        fprintf(stderr, "Error: Fallo en la asignación de memoria.\n");
+        return EXIT_FAILURE;
+    }
+    globals.local = NULL;
+    if (!zynkEnvInit(&globals, 64, NULL, &manager) || !zynkFramePoolInit(&pool, &manager, 8, 64) ||
+        !build_vm(false, &vm_sum, &vm_fib, &vm_asum)) {
+        fprintf(stderr, "Error: no se pudo preparar el entorno.\n");
+        return EXIT_FAILURE;
+    }
+    with_jit = build_vm(true, &jit_sum, &jit_fib, &jit_asum);
+    build_ast();
+    Value array = zynkCreateArray(&manager, ARRAY_N);
+    for (int i = 0; i < ARRAY_N; ++i) zynkArrayPush(&manager, array, zynkNumber(i % 100));
+
+    printf("%-22s %12s %12s %9s", "programa", "árbol (ms)", "VM (ms)", "mejora");
+    if (with_jit) printf(" %12s %9s", "JIT (ms)", "mejora");
+    printf("\n");
+    Value n = zynkNumber(LOOP_N);
+    compare("bucle (1e6 vueltas)", "sum", &n, 1, vm_sum, jit_sum, reps);
+    Value f = zynkNumber(FIB_N);
+    compare("fib(24) recursivo", "fib", &f, 1, vm_fib, jit_fib, reps);
+    Value args[] = {array, zynkNumber(ARRAY_N)};
+    compare("suma de array (1e5)", "asum", args, 2, vm_asum, jit_asum, reps);
+    return EXIT_SUCCESS;
+}
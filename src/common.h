@@ -14,7 +14,27 @@
 // Customizable def's
 
 #define TABLE_CAPACITY 1024
+#define TABLE_MAX_LOAD 80 // percent of full+deleted slots before an env table rehashes
+#define TABLE_REHASH_STEP 16 // old slots moved by each table operation while rehashing
+#define FRAME_NAME_BYTES 16 // name buffer of a pooled frame table, per slot
 #define END_CHAR '\0'
 #define GROW_NUM 8
 
+// Comment this out to build without the OS dependent parts (mmap, pread...)
+#define ZYNK_POSIX
+
+// Comment this out to call the out-of-line Value API (zynkNumber,
+// zynkValuesAdd...) instead of the static inline one in value_inline.h
+#define ZYNK_INLINE_VALUES
+
+// Comment this out to run every ObjFunction on the VM. Otherwise, on x86-64
+// POSIX builds, a function called ZYNK_JIT_THRESHOLD times is compiled to
+// native code (runtime/jit.h)
+#define ZYNK_JIT
+#define ZYNK_JIT_THRESHOLD 1000
+
+// Uncomment to count how deep env lookups go and how many tables the bloom
+// filters skip (zynkEnvGetStats)
+// #define ZYNK_ENV_STATS
+
 #endif
@@ -1,12 +1,45 @@
 #ifndef NATIVES_H
 #define NATIVES_H
 #include "zynk.h"
-// Add forward declarations of your native funcs here
+// Add forward declarations of your native funcs here. A native returns a new
+// reference: whatever it hands back out of an array or map is retained first.
 void init_native_funcs(ArenaManager *manager, ZynkEnv *env);
 Value libzynk_len(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
 Value libzynk_push(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
 Value libzynk_pop(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
 Value libzynk_get_index(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
 Value libzynk_set_index(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_copy(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_map(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_map_get(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_map_set(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_map_delete(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_map_has(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_map_keys(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_map_next(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_buffer(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_buffer_slice(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_buffer_get(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_buffer_set(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_utf8_valid(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_utf8_len(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_utf8_index(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_utf8_sub(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_find(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_rfind(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_count(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_split(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_replace(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_tostring(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_tonumber(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_sort(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_memoize(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_memo_stats(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_memo_clear(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+#ifdef ZYNK_POSIX
+Value libzynk_buffer_map(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_buffer_read(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+Value libzynk_buffer_write(ArenaManager *manager, ZynkEnv *env, ZynkArray *args);
+#endif
 
 #endif
@@ -1,33 +1,24 @@
+#define ZYNK_BUILDING_ABI // keep the exported symbols, value_inline.h has the bodies
 #include "types.h"
 #include "assign.h"
 #include <stdbool.h>
 #include <stdint.h>
 #include <stddef.h>
 #include "../common.h"
+#include "value_inline.h"
 
-inline void initVal(Value *val) {
-  // something here to initialize values
-}
-
-Value zynkNull() {
-  Value ret;
-  ret.type=ZYNK_NULL;
-  initVal(&ret); 
-  return ret;
+Value zynkNull(void) {
+  return zynkInlineNull();
 }
 
 Value zynkBool(bool tf) {
-  Value ret;
-  ret.type=ZYNK_BOOL;
-  ret.as.boolean=tf;
-  initVal(&ret);
-  return ret;
+  return zynkInlineBool(tf);
 }
 
 Value zynkNumber(double number) {
-  Value ret;
-  ret.type=ZYNK_NUMBER;
-  ret.as.number=number;
-  initVal(&ret);
-  return ret;
+  return zynkInlineNumber(number);
+}
+
+Value zynkByte(uint8_t byte) {
+  return zynkInlineByte(byte);
 }
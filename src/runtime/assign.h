@@ -6,8 +6,9 @@
 #include <stdint.h>
 #include <stddef.h>
 
-Value zynkNull();
+Value zynkNull(void);
 Value zynkBool(bool tf);
 Value zynkNumber(double number);
+Value zynkByte(uint8_t byte);
 
 #endif
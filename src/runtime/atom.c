@@ -0,0 +1,155 @@
+// Code under LGPL
+#include "atom.h"
+#include "../common.h"
+#include "hash.h"
+#include "memory.h"
+#include "realloc.h"
+#include "../sysarena/sysarena.h"
+
+#define ATOM_BLOCK 4096 // bytes of names per allocation
+#define ATOM_MIN_SLOTS 128
+
+// names are packed into blocks, chained so zynkAtomsFree can find them
+typedef struct AtomBlock {
+  struct AtomBlock *next;
+} AtomBlock;
+
+static ZynkAtomInfo *infos; // indexed by atom, infos[0] unused
+static uint32_t count; // atoms made so far, the last one is `count`
+static uint32_t info_cap;
+static ZynkAtom *slots; // open addressing on the hash, ZYNK_ATOM_NONE when empty
+static uint32_t slot_cap; // power of two, at most half full
+static AtomBlock *blocks;
+static size_t block_used; // bytes of the newest block in use
+static size_t block_size;
+
+// slot holding the name, or the empty one where it would go
+static uint32_t find_slot(const char *name, uint32_t len, uint32_t hash) {
+  uint32_t mask=slot_cap-1;
+  uint32_t pos=hash & mask;
+  while (slots[pos]!=ZYNK_ATOM_NONE) {
+    ZynkAtomInfo *info=&infos[slots[pos]];
+    if (info->hash==hash && info->len==len && zynk_strcmp(info->name, name, len)) {
+      return pos;
+    }
+    pos=(pos+1) & mask;
+  }
+  return pos;
+}
+
+static bool grow_slots(ArenaManager *manager) {
+  uint32_t cap=slot_cap==0 ? ATOM_MIN_SLOTS : slot_cap*2;
+  ZynkAtom *fresh=(ZynkAtom *)sysarena_alloc(manager, cap*sizeof(ZynkAtom));
+  if (fresh==NULL) {
+    return false;
+  }
+  for (uint32_t i=0;i<cap;i++) fresh[i]=ZYNK_ATOM_NONE;
+  if (slots!=NULL) sysarena_free(manager, slots);
+  slots=fresh;
+  slot_cap=cap;
+  for (ZynkAtom atom=1;atom<=count;atom++) {
+    slots[find_slot(infos[atom].name, infos[atom].len, infos[atom].hash)]=atom;
+  }
+  return true;
+}
+
+static char *store_name(ArenaManager *manager, const char *name, uint32_t len) {
+  size_t need=(size_t)len+1;
+  if (blocks==NULL || block_used+need>block_size) {
+    size_t size=sizeof(AtomBlock)+need>ATOM_BLOCK ? sizeof(AtomBlock)+need : ATOM_BLOCK;
+    AtomBlock *block=(AtomBlock *)sysarena_alloc(manager, size);
+    if (block==NULL) {
+      return NULL;
+    }
+    block->next=blocks;
+    blocks=block;
+    block_used=sizeof(AtomBlock);
+    block_size=size;
+  }
+  char *copy=(char *)blocks+block_used;
+  zynk_cpy((uint8_t *)copy, (const uint8_t *)name, len);
+  copy[len]=END_CHAR;
+  block_used+=need;
+  return copy;
+}
+
+ZynkAtom zynkAtomIntern(ArenaManager *manager, const char *name) {
+  if (manager==NULL || name==NULL) {
+    return ZYNK_ATOM_NONE;
+  }
+  uint32_t len=zynk_len(name, END_CHAR);
+  uint32_t hash=zynk_hash_bytes(name, len);
+  if ((count+1)*2>slot_cap && !grow_slots(manager)) {
+    return ZYNK_ATOM_NONE;
+  }
+  uint32_t pos=find_slot(name, len, hash);
+  if (slots[pos]!=ZYNK_ATOM_NONE) {
+    return slots[pos];
+  }
+  if (count+1>=info_cap) {
+    uint32_t cap=info_cap==0 ? ATOM_MIN_SLOTS : info_cap*2;
+    ZynkAtomInfo *fresh=(ZynkAtomInfo *)reallocate(manager, (uint8_t *)infos, info_cap*sizeof(ZynkAtomInfo), cap*sizeof(ZynkAtomInfo));
+    if (fresh==NULL) {
+      return ZYNK_ATOM_NONE;
+    }
+    infos=fresh;
+    info_cap=cap;
+  }
+  char *copy=store_name(manager, name, len);
+  if (copy==NULL) {
+    return ZYNK_ATOM_NONE;
+  }
+  ZynkAtom atom=++count;
+  infos[atom].name=copy;
+  infos[atom].hash=hash;
+  infos[atom].len=len;
+  slots[pos]=atom;
+  return atom;
+}
+
+ZynkAtom zynkAtomFind(const char *name) {
+  if (name==NULL || count==0) {
+    return ZYNK_ATOM_NONE;
+  }
+  uint32_t len=zynk_len(name, END_CHAR);
+  return slots[find_slot(name, len, zynk_hash_bytes(name, len))];
+}
+
+const ZynkAtomInfo *zynk_atom_info(ZynkAtom atom) {
+  if (atom==ZYNK_ATOM_NONE || atom>count) {
+    return NULL;
+  }
+  return &infos[atom];
+}
+
+const char *zynkAtomName(ZynkAtom atom) {
+  const ZynkAtomInfo *info=zynk_atom_info(atom);
+  return info==NULL ? NULL : info->name;
+}
+
+uint32_t zynkAtomCount(void) {
+  return count;
+}
+
+void zynkAtomsFree(ArenaManager *manager) {
+  if (manager==NULL) {
+    return;
+  }
+  while (blocks!=NULL) {
+    AtomBlock *next=blocks->next;
+    sysarena_free(manager, blocks);
+    blocks=next;
+  }
+  if (infos!=NULL) sysarena_free(manager, infos);
+  if (slots!=NULL) sysarena_free(manager, slots);
+  infos=NULL;
+  slots=NULL;
+  count=0;
+  info_cap=0;
+  slot_cap=0;
+  block_used=0;
+  block_size=0;
+}
+
+#undef ATOM_BLOCK
+#undef ATOM_MIN_SLOTS
@@ -0,0 +1,32 @@
+#ifndef ZYNK_ATOM
+#define ZYNK_ATOM
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "types.h" // not common.h: it includes zynk_enviroment.h, which needs ZynkAtom
+
+// Symbol table of the runtime: every name interned once gets a dense
+// integer atom, 1, 2, 3... in order, and its bytes are stored a single time
+// for the whole process. An atom stays valid until zynkAtomsFree, which
+// drops them all and starts numbering over at 1, so an atom kept from before
+// names something else afterwards: free the env tables keyed by them first.
+// Intern every atom with the same manager.
+typedef uint32_t ZynkAtom;
+#define ZYNK_ATOM_NONE 0
+
+typedef struct {
+  const char *name; // interned, compare the pointer to tell atoms apart
+  uint32_t hash; // zynk_hash_bytes(name, len), as env tables hash it
+  uint32_t len;
+} ZynkAtomInfo;
+
+ZynkAtom zynkAtomIntern(ArenaManager *manager, const char *name);
+ZynkAtom zynkAtomFind(const char *name); // ZYNK_ATOM_NONE if never interned
+const char *zynkAtomName(ZynkAtom atom); // NULL for unknown atoms
+uint32_t zynkAtomCount(void);
+void zynkAtomsFree(ArenaManager *manager);
+
+const ZynkAtomInfo *zynk_atom_info(ZynkAtom atom);
+
+#endif
@@ -0,0 +1,155 @@
+// Code under LGPL
+#ifdef __unix__
+#define _POSIX_C_SOURCE 200809L // pread, pwrite and friends under -std=c11
+#endif
+
+#include "buffer.h"
+#include "assign.h"
+#include "../sysarena/sysarena.h"
+#include "value_inline.h"
+
+#ifdef ZYNK_POSIX
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define IS_BUFFER(val) (val.type==ZYNK_OBJ && val.as.obj!=NULL && val.as.obj->type==ObjBuffer)
+#define AS_BUFFER(val) (val.as.obj->obj.buffer)
+
+// no copy, the slice points into the bytes of buffer_val
+Value zynkBufferSlice(ArenaManager *manager, Value buffer_val, size_t start, size_t end) {
+  if (!IS_BUFFER(buffer_val)) return zynkNull();
+  ZynkBuffer *buffer=AS_BUFFER(buffer_val);
+
+  if (end>buffer->len) end=buffer->len;
+  if (start>end) start=end;
+
+  // slices of slices point straight to the owner
+  ZynkObj *owner=(buffer->parent!=NULL) ? buffer->parent : buffer_val.as.obj;
+  uint8_t *data=(buffer->data!=NULL) ? buffer->data+start : NULL;
+  return zynkCreateBufferView(manager, data, end-start, owner, false);
+}
+
+Value zynkBufferGet(Value buffer_val, Value index_val) {
+  if (!IS_BUFFER(buffer_val) || index_val.type!=ZYNK_NUMBER) return zynkNull();
+  ZynkBuffer *buffer=AS_BUFFER(buffer_val);
+  if (index_val.as.number<0 || index_val.as.number>=(double)buffer->len) return zynkNull();
+  return zynkByte(buffer->data[(size_t)index_val.as.number]);
+}
+
+bool zynkBufferSet(Value buffer_val, Value index_val, Value byte_val) {
+  if (!IS_BUFFER(buffer_val) || index_val.type!=ZYNK_NUMBER) return false;
+  ZynkBuffer *buffer=AS_BUFFER(buffer_val);
+  if (buffer->readonly) return false;
+  if (index_val.as.number<0 || index_val.as.number>=(double)buffer->len) return false;
+
+  uint8_t byte;
+  switch (byte_val.type) {
+    case ZYNK_BYTE: byte=byte_val.as.byte; break;
+    case ZYNK_NUMBER: byte=(uint8_t)(int64_t)byte_val.as.number; break;
+    default: return false;
+  }
+  buffer->data[(size_t)index_val.as.number]=byte;
+  return true;
+}
+
+bool freeBuffer(ArenaManager *manager, ZynkBuffer *buffer) {
+  if (buffer==NULL) return true;
+  if (buffer->parent!=NULL) {
+    Value parent;
+    parent.type=ZYNK_OBJ;
+    parent.as.obj=buffer->parent;
+    zynk_release(parent, manager);
+  } else if (buffer->mapped) {
+#ifdef ZYNK_POSIX
+    if (buffer->data!=NULL) munmap(buffer->data, buffer->len);
+#endif
+  } else if (buffer->data!=NULL) {
+    sysarena_free(manager, buffer->data);
+  }
+  sysarena_free(manager, buffer);
+  return true;
+}
+
+#ifdef ZYNK_POSIX
+
+// read-only private mapping, the pages are loaded on demand by the OS
+Value zynkBufferMapFile(ArenaManager *manager, const char *path) {
+  if (manager==NULL || path==NULL) return zynkNull();
+
+  int fd=open(path, O_RDONLY);
+  if (fd<0) return zynkNull();
+
+  struct stat st;
+  if (fstat(fd, &st)!=0) {
+    close(fd);
+    return zynkNull();
+  }
+
+  size_t len=(size_t)st.st_size;
+  uint8_t *data=NULL;
+  if (len>0) {
+    void *map=mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map==MAP_FAILED) {
+      close(fd);
+      return zynkNull();
+    }
+    data=(uint8_t *)map;
+  }
+  close(fd); // the mapping stays valid
+
+  Value ret=zynkCreateBufferView(manager, data, len, NULL, true);
+  if (ret.type==ZYNK_NULL && data!=NULL) munmap(data, len);
+  return ret;
+}
+
+Value zynkBufferReadFile(ArenaManager *manager, const char *path, uint64_t offset, size_t len) {
+  if (manager==NULL || path==NULL) return zynkNull();
+
+  int fd=open(path, O_RDONLY);
+  if (fd<0) return zynkNull();
+
+  Value ret=zynkCreateBuffer(manager, len);
+  if (ret.type==ZYNK_NULL) {
+    close(fd);
+    return ret;
+  }
+
+  ZynkBuffer *buffer=AS_BUFFER(ret);
+  size_t done=0;
+  while (done<len) {
+    ssize_t n=pread(fd, buffer->data+done, len-done, (off_t)(offset+done));
+    if (n<=0) break; // EOF or error, keep what we got
+    done+=(size_t)n;
+  }
+  close(fd);
+
+  buffer->len=done;
+  return ret;
+}
+
+// returns the bytes written, -1 on error
+int64_t zynkBufferWriteFile(Value buffer_val, const char *path, uint64_t offset) {
+  if (!IS_BUFFER(buffer_val) || path==NULL) return -1;
+  ZynkBuffer *buffer=AS_BUFFER(buffer_val);
+
+  int fd=open(path, O_WRONLY | O_CREAT, 0644);
+  if (fd<0) return -1;
+
+  size_t done=0;
+  while (done<buffer->len) {
+    ssize_t n=pwrite(fd, buffer->data+done, buffer->len-done, (off_t)(offset+done));
+    if (n<=0) break;
+    done+=(size_t)n;
+  }
+  close(fd);
+  return (done==buffer->len) ? (int64_t)done : -1;
+}
+
+#endif // ZYNK_POSIX
+
+#undef IS_BUFFER
+#undef AS_BUFFER
@@ -0,0 +1,24 @@
+#ifndef ZYNK_BUFFER
+#define ZYNK_BUFFER
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../common.h"
+#include "types.h"
+#include "objects.h"
+#include "object_mng.h"
+#include "object_rf.h"
+
+Value zynkBufferSlice(ArenaManager *manager, Value buffer_val, size_t start, size_t end);
+Value zynkBufferGet(Value buffer_val, Value index_val);
+bool zynkBufferSet(Value buffer_val, Value index_val, Value byte_val);
+bool freeBuffer(ArenaManager *manager, ZynkBuffer *buffer);
+
+#ifdef ZYNK_POSIX
+Value zynkBufferMapFile(ArenaManager *manager, const char *path);
+Value zynkBufferReadFile(ArenaManager *manager, const char *path, uint64_t offset, size_t len);
+int64_t zynkBufferWriteFile(Value buffer_val, const char *path, uint64_t offset);
+#endif
+
+#endif
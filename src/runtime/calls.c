@@ -4,26 +4,49 @@
 #include "../common.h"
 #include "calls.h"
 #include "types.h"
+#include "memo.h"
+#include "vm.h"
+#include "value_inline.h"
 
 #define IS_NULL(obj) (obj.type==ZYNK_NULL)
 #define IS_OBJ(val) (val.type==ZYNK_OBJ)
 #define AS_OBJ(val) (val.as.obj)
 #define IS_ARRAY(obj) (obj->type==ObjArray)
 
-Value zynkCallFunction(ArenaManager *manager, ZynkEnv *env, const char *name, Value args) {
-  Value func = zynkTableGet(env, name);
-
-  if (!IS_OBJ(args) || !IS_OBJ(func) || !IS_ARRAY(AS_OBJ(args))) return zynkNull();
-
-  ZynkArray *array_obj=AS_OBJ(args)->obj.array;
+static Value call(ArenaManager *manager, ZynkEnv *env, Value func, ZynkArray *args) {
+  if (!IS_OBJ(func)) return zynkNull();
 
   switch (AS_OBJ(func)->type) {
-    case ObjNativeFunction: return AS_OBJ(func)->obj.native_func->func_ptr(manager, env, array_obj);
-    case ObjFunction: return zynkNull(); // future...
+    case ObjNativeFunction: return zynkCallNative(manager, env, AS_OBJ(func)->obj.native_func, args);
+    case ObjFunction: return zynk_vm_call(manager, env, AS_OBJ(func)->obj.function, args->len, args->array);
     default: return zynkNull();
   }
 }
 
+static Value call_array(ArenaManager *manager, ZynkEnv *env, Value func, Value args) {
+  if (!IS_OBJ(args) || !IS_ARRAY(AS_OBJ(args))) return zynkNull();
+  return call(manager, env, func, AS_OBJ(args)->obj.array);
+}
+
+Value zynkCallFunction(ArenaManager *manager, ZynkEnv *env, const char *name, Value args) {
+  return call_array(manager, env, zynkTableGet(env, name), args);
+}
+
+Value zynkCallFunctionCached(ArenaManager *manager, ZynkEnv *env, const char *name, Value args, ZynkLookupCache *cache) {
+  return call_array(manager, env, zynkTableGetCached(env, name, cache), args);
+}
+
+Value zynkCallValue(ArenaManager *manager, ZynkEnv *env, Value func, uint32_t argc, Value *argv) {
+  if (argv==NULL && argc!=0) return zynkNull();
+  // natives only read their arguments, a view of argv does
+  ZynkArray args={.len=argc, .capacity=argc, .array=argv, .shared=NULL};
+  return call(manager, env, func, &args);
+}
+
+Value zynkCallCached(ArenaManager *manager, ZynkEnv *env, const char *name, uint32_t argc, Value *argv, ZynkLookupCache *cache) {
+  return zynkCallValue(manager, env, zynkTableGetCached(env, name, cache), argc, argv);
+}
+
 #undef IS_NULL
 #undef IS_OBJ
 #undef AS_OBJ
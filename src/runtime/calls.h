@@ -12,5 +12,12 @@
 #include "object_rf.h"
 
 Value zynkCallFunction(ArenaManager *manager, ZynkEnv *env, const char *name, Value args);
+// same, the lookup of `name` goes through a per call site cache (see ZynkLookupCache)
+Value zynkCallFunctionCached(ArenaManager *manager, ZynkEnv *env, const char *name, Value args, ZynkLookupCache *cache);
+// Calls with the arguments in a C array, usually on the caller's stack:
+// natives read them through a ZynkArray view of argv, so nothing is
+// allocated. They're borrowed, neither retained nor released by the call.
+Value zynkCallValue(ArenaManager *manager, ZynkEnv *env, Value func, uint32_t argc, Value *argv);
+Value zynkCallCached(ArenaManager *manager, ZynkEnv *env, const char *name, uint32_t argc, Value *argv, ZynkLookupCache *cache);
 
 #endif
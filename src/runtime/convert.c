@@ -0,0 +1,500 @@
+// Code under LGPL
+// Number <-> string conversions. Formatting is Grisu2 (F. Loitsch, "Printing
+// Floating-Point Numbers Quickly and Accurately with Integers"): the output
+// always reads back to the same double and is the shortest one in nearly
+// every case. Parsing takes Clinger's exact fast path and only falls back to
+// strtod for long mantissas or big exponents.
+#include "convert.h"
+#include "assign.h"
+#include "memory.h"
+#include "object_mng.h"
+#include "value_inline.h"
+
+#if __STDC_HOSTED__
+#include <stdlib.h> // strtod, slow path only
+#endif
+
+#define IS_STRING(val) (val.type==ZYNK_OBJ && val.as.obj!=NULL && val.as.obj->type==ObjString)
+#define AS_STRING(val) (val.as.obj->obj.string)
+
+#define DP_SIGNIFICAND_MASK 0x000FFFFFFFFFFFFFULL
+#define DP_EXPONENT_MASK 0x7FF0000000000000ULL
+#define DP_HIDDEN_BIT 0x0010000000000000ULL
+// a double's rounding boundaries have at most 767 significant digits
+#define ZYNK_PARSE_DIGITS 768
+#define DP_EXPONENT_BIAS 1075
+
+typedef struct {
+  uint64_t f;
+  int e;
+} DiyFp;
+
+// 10^k normalized to 64 bits, k = -348, -340, ..., 340
+static const uint64_t cached_powers_f[]={
+  0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL,
+  0xcf42894a5dce35eaULL, 0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL,
+  0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL, 0xbe5691ef416bd60cULL,
+  0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+  0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL,
+  0xc21094364dfb5637ULL, 0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL,
+  0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL, 0xb23867fb2a35b28eULL,
+  0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+  0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL,
+  0xb5b5ada8aaff80b8ULL, 0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL,
+  0x964e858c91ba2655ULL, 0xdff9772470297ebdULL, 0xa6dfbd9fb8e5b88fULL,
+  0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+  0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL,
+  0xaa242499697392d3ULL, 0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL,
+  0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL, 0x9c40000000000000ULL,
+  0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+  0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL,
+  0x9f4f2726179a2245ULL, 0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL,
+  0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL, 0x924d692ca61be758ULL,
+  0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+  0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL,
+  0x952ab45cfa97a0b3ULL, 0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL,
+  0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL, 0x88fcf317f22241e2ULL,
+  0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+  0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL,
+  0x8bab8eefb6409c1aULL, 0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL,
+  0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL, 0x80444b5e7aa7cf85ULL,
+  0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+  0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL,
+};
+
+static const int16_t cached_powers_e[]={
+  -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+  -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+  -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+  -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+  -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+  109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+  375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+  641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+  907, 933, 960, 986, 1013, 1039, 1066,
+};
+
+static const uint64_t pow10_u64[]={
+  1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+  100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+  10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+  100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL,
+};
+
+static uint64_t doubleBits(double number) {
+  union { double number; uint64_t bits; } pun;
+  pun.number=number;
+  return pun.bits;
+}
+
+static DiyFp diyMul(DiyFp x, DiyFp y) {
+  const uint64_t m32=0xFFFFFFFFULL;
+  uint64_t a=x.f>>32, b=x.f & m32, c=y.f>>32, d=y.f & m32;
+  uint64_t ac=a*c, bc=b*c, ad=a*d, bd=b*d;
+  uint64_t tmp=(bd>>32)+(ad & m32)+(bc & m32);
+  tmp+=1ULL<<31; // round
+  DiyFp r;
+  r.f=ac+(ad>>32)+(bc>>32)+(tmp>>32);
+  r.e=x.e+y.e+64;
+  return r;
+}
+
+static DiyFp cachedPower(int e, int *k) {
+  double dk=(-61-e)*0.30102999566398114+347; // ceil((-61-e)*log10(2)) + 348 - 1
+  int ik=(int)dk;
+  if (dk-ik>0.0) ik++;
+  unsigned index=(unsigned)((ik>>3)+1);
+  *k=-(-348+(int)index*8);
+  DiyFp r;
+  r.f=cached_powers_f[index];
+  r.e=cached_powers_e[index];
+  return r;
+}
+
+static void grisuRound(char *buffer, int len, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w) {
+  while (rest<wp_w && delta-rest>=ten_kappa && (rest+ten_kappa<wp_w || wp_w-rest>rest+ten_kappa-wp_w)) {
+    buffer[len-1]--;
+    rest+=ten_kappa;
+  }
+}
+
+static int countDigits32(uint32_t n) {
+  int digits=1;
+  while (digits<10 && n>=pow10_u64[digits]) digits++;
+  return digits;
+}
+
+static void digitGen(DiyFp w, DiyFp mp, uint64_t delta, char *buffer, int *len, int *k) {
+  DiyFp one;
+  one.f=1ULL<<-mp.e;
+  one.e=mp.e;
+  uint64_t wp_w=mp.f-w.f;
+  uint32_t p1=(uint32_t)(mp.f>>-one.e);
+  uint64_t p2=mp.f & (one.f-1);
+  int kappa=countDigits32(p1);
+  *len=0;
+
+  while (kappa>0) {
+    uint32_t div=(uint32_t)pow10_u64[kappa-1];
+    uint32_t d=p1/div;
+    p1%=div;
+    if (d || *len) buffer[(*len)++]=(char)('0'+d);
+    kappa--;
+    uint64_t tmp=((uint64_t)p1<<-one.e)+p2;
+    if (tmp<=delta) {
+      *k+=kappa;
+      grisuRound(buffer, *len, delta, tmp, pow10_u64[kappa]<<-one.e, wp_w);
+      return;
+    }
+  }
+
+  for (;;) {
+    p2*=10;
+    delta*=10;
+    char d=(char)(p2>>-one.e);
+    if (d || *len) buffer[(*len)++]=(char)('0'+d);
+    p2&=one.f-1;
+    kappa--;
+    if (p2<delta) {
+      *k+=kappa;
+      int index=-kappa;
+      grisuRound(buffer, *len, delta, p2, one.f, wp_w*(index<20 ? pow10_u64[index] : 0));
+      return;
+    }
+  }
+}
+
+// digits of a positive finite number: value = digits * 10^k
+static void grisu2(double number, char *buffer, int *len, int *k) {
+  uint64_t bits=doubleBits(number);
+  int biased_e=(int)((bits & DP_EXPONENT_MASK)>>52);
+  DiyFp v;
+  v.f=bits & DP_SIGNIFICAND_MASK;
+  if (biased_e!=0) {
+    v.f+=DP_HIDDEN_BIT;
+    v.e=biased_e-DP_EXPONENT_BIAS;
+  } else {
+    v.e=1-DP_EXPONENT_BIAS;
+  }
+
+  // boundaries m+ and m-, halfway to the neighbour doubles
+  DiyFp plus;
+  plus.f=(v.f<<1)+1;
+  plus.e=v.e-1;
+  while (!(plus.f & (DP_HIDDEN_BIT<<1))) {
+    plus.f<<=1;
+    plus.e--;
+  }
+  plus.f<<=10;
+  plus.e-=10;
+
+  DiyFp minus;
+  if (v.f==DP_HIDDEN_BIT) {
+    minus.f=(v.f<<2)-1;
+    minus.e=v.e-2;
+  } else {
+    minus.f=(v.f<<1)-1;
+    minus.e=v.e-1;
+  }
+  minus.f<<=minus.e-plus.e;
+  minus.e=plus.e;
+
+  DiyFp norm=v;
+  while (!(norm.f & DP_HIDDEN_BIT)) {
+    norm.f<<=1;
+    norm.e--;
+  }
+  norm.f<<=11;
+  norm.e-=11;
+
+  DiyFp c_mk=cachedPower(plus.e, k);
+  DiyFp w=diyMul(norm, c_mk);
+  DiyFp wp=diyMul(plus, c_mk);
+  DiyFp wm=diyMul(minus, c_mk);
+  wm.f++;
+  wp.f--;
+  digitGen(w, wp, wp.f-wm.f, buffer, len, k);
+}
+
+static uint32_t writeUInt(char *out, uint64_t n) {
+  char tmp[20];
+  uint32_t len=0;
+  do {
+    tmp[len++]=(char)('0'+n%10);
+    n/=10;
+  } while (n);
+  for (uint32_t i=0;i<len;i++) out[i]=tmp[len-1-i];
+  return len;
+}
+
+// Lays the digits out like most script languages print numbers: plain
+// notation for exponents in [-6, 21), scientific notation otherwise.
+static uint32_t layout(char *out, const char *digits, int len, int k) {
+  int point=len+k; // position of the decimal point
+  uint32_t n=0;
+  if (k>=0 && point<=21) {
+    for (int i=0;i<len;i++) out[n++]=digits[i];
+    for (int i=0;i<k;i++) out[n++]='0';
+  } else if (point>0 && point<=21) {
+    for (int i=0;i<point;i++) out[n++]=digits[i];
+    out[n++]='.';
+    for (int i=point;i<len;i++) out[n++]=digits[i];
+  } else if (point>-6 && point<=0) {
+    out[n++]='0';
+    out[n++]='.';
+    for (int i=point;i<0;i++) out[n++]='0';
+    for (int i=0;i<len;i++) out[n++]=digits[i];
+  } else {
+    out[n++]=digits[0];
+    if (len>1) {
+      out[n++]='.';
+      for (int i=1;i<len;i++) out[n++]=digits[i];
+    }
+    out[n++]='e';
+    int exp=point-1;
+    if (exp<0) {
+      out[n++]='-';
+      exp=-exp;
+    } else {
+      out[n++]='+';
+    }
+    n+=writeUInt(out+n, (uint64_t)exp);
+  }
+  return n;
+}
+
+// writes at most ZYNK_NUMBER_CHARS chars (no '\0'), returns how many
+uint32_t zynk_format_number(double number, char *out) {
+  if (number!=number) {
+    zynk_cpy((uint8_t *)out, (uint8_t *)"nan", 3);
+    return 3;
+  }
+  uint32_t n=0;
+  if (number<0) {
+    out[n++]='-';
+    number=-number;
+  }
+  if (number==1.0/0.0) {
+    zynk_cpy((uint8_t *)out+n, (uint8_t *)"inf", 3);
+    return n+3;
+  }
+  if (number==0) {
+    out[0]='0'; // -0 prints as 0
+    return 1;
+  }
+  if (number<9007199254740992.0 && number==(double)(uint64_t)number) {
+    return n+writeUInt(out+n, (uint64_t)number); // integers skip grisu
+  }
+  char digits[18];
+  int len, k;
+  grisu2(number, digits, &len, &k);
+  return n+layout(out+n, digits, len, k);
+}
+
+static const double pow10_exact[]={
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static bool matchWord(const char *str, size_t len, const char *word) {
+  size_t i=0;
+  for (;word[i];i++) {
+    if (i>=len) return false;
+    char c=str[i];
+    if (c>='A' && c<='Z') c=(char)(c-'A'+'a');
+    if (c!=word[i]) return false;
+  }
+  return i==len;
+}
+
+// the whole [str, str+len) must be a number: [+-]digits[.digits][e[+-]digits],
+// inf or nan
+bool zynk_parse_number(const char *str, size_t len, double *out) {
+  if (str==NULL || out==NULL || len==0) return false;
+  size_t i=0;
+  bool negative=false;
+  if (str[i]=='+' || str[i]=='-') {
+    negative=(str[i]=='-');
+    i++;
+  }
+  if (matchWord(str+i, len-i, "inf") || matchWord(str+i, len-i, "infinity")) {
+    *out=negative ? -1.0/0.0 : 1.0/0.0;
+    return true;
+  }
+  if (matchWord(str+i, len-i, "nan")) {
+    *out=0.0/0.0;
+    return true;
+  }
+
+  size_t first=i;
+  uint64_t mantissa=0;
+  int digits=0;      // significant digits seen
+  int dropped=0;     // integer digits that didn't fit in the mantissa
+  int exp10=0;
+  int exponent=0;    // the e part alone
+  bool any=false;
+
+  for (;i<len && str[i]>='0' && str[i]<='9';i++) {
+    any=true;
+    if (mantissa==0 && str[i]=='0') continue;
+    if (digits<19) mantissa=mantissa*10+(uint64_t)(str[i]-'0');
+    else dropped++;
+    digits++;
+  }
+  if (i<len && str[i]=='.') {
+    i++;
+    for (;i<len && str[i]>='0' && str[i]<='9';i++) {
+      any=true;
+      if (mantissa==0 && str[i]=='0') {
+        exp10--;
+        continue;
+      }
+      if (digits<19) {
+        mantissa=mantissa*10+(uint64_t)(str[i]-'0');
+        exp10--;
+      }
+      digits++;
+    }
+  }
+  if (!any) return false;
+  if (i<len && (str[i]=='e' || str[i]=='E')) {
+    i++;
+    bool exp_negative=false;
+    if (i<len && (str[i]=='+' || str[i]=='-')) {
+      exp_negative=(str[i]=='-');
+      i++;
+    }
+    if (i>=len || str[i]<'0' || str[i]>'9') return false;
+    for (;i<len && str[i]>='0' && str[i]<='9';i++) {
+      if (exponent<100000) exponent=exponent*10+(str[i]-'0');
+    }
+    if (exp_negative) exponent=-exponent;
+    exp10+=exponent;
+  }
+  if (i!=len) return false;
+  exp10+=dropped;
+
+  double value;
+  if (mantissa==0) {
+    value=0;
+  } else if (digits<=19 && mantissa<=(1ULL<<53) && exp10>=-22 && exp10<=22+15) {
+    // Clinger: both operands are exact, so is the single rounding
+    value=(double)mantissa;
+    if (exp10<0) {
+      value/=pow10_exact[-exp10];
+    } else if (exp10<=22) {
+      value*=pow10_exact[exp10];
+    } else {
+      value*=pow10_exact[exp10-22]; // exact while it stays below 2^53
+      if (value>9007199254740992.0) goto slow;
+      value*=pow10_exact[22];
+    }
+  } else {
+    goto slow;
+  }
+  *out=negative ? -value : value;
+  return true;
+
+slow:
+#if __STDC_HOSTED__
+  {
+    // strtod needs a terminated copy, rewritten as .digits e exponent. Past
+    // ZYNK_PARSE_DIGITS significant digits only whether any of the rest is
+    // nonzero matters: no rounding boundary of a double needs more digits,
+    // so a sticky '1' keeps the result correctly rounded.
+    char text[ZYNK_PARSE_DIGITS+32];
+    size_t n=0;
+    text[n++]=negative ? '-' : '+';
+    text[n++]='.';
+    int64_t point=0; // the value is .digits * 10^point
+    bool sticky=false;
+    bool fraction=false;
+    for (i=first;i<len && str[i]!='e' && str[i]!='E';i++) {
+      char c=str[i];
+      if (c=='.') {
+        fraction=true;
+        continue;
+      }
+      if (n==2 && c=='0') {
+        if (fraction) point--;
+        continue;
+      }
+      if (!fraction) point++;
+      if (n<ZYNK_PARSE_DIGITS+2) text[n++]=c;
+      else if (c!='0') sticky=true;
+    }
+    if (sticky) text[n++]='1';
+    point+=exponent;
+    text[n++]='e';
+    if (point<0) {
+      text[n++]='-';
+      point=-point;
+    }
+    char reversed[24];
+    size_t r=0;
+    do {
+      reversed[r++]=(char)('0'+point%10);
+      point/=10;
+    } while (point>0);
+    while (r>0) text[n++]=reversed[--r];
+    text[n]='\0';
+    *out=strtod(text, NULL);
+    return true;
+  }
+#else
+  {
+    long double value_ld=(long double)mantissa;
+    long double scale=10.0L;
+    int e=(exp10<0) ? -exp10 : exp10;
+    long double power=1.0L;
+    while (e) {
+      if (e & 1) power*=scale;
+      scale*=scale;
+      e>>=1;
+    }
+    value_ld=(exp10<0) ? value_ld/power : value_ld*power;
+    *out=negative ? -(double)value_ld : (double)value_ld;
+    return true;
+  }
+#endif
+}
+
+// formatted on the stack first, so the string is allocated once at its final size
+Value zynkNumberToString(ArenaManager *manager, double number) {
+  char text[ZYNK_NUMBER_CHARS];
+  uint32_t len=zynk_format_number(number, text);
+  Value ret=zynkCreateStringLen(manager, text, len);
+  if (ret.type!=ZYNK_NULL) AS_STRING(ret)->kind=ZYNK_STR_ASCII;
+  return ret;
+}
+
+Value zynkValueToString(ArenaManager *manager, Value val) {
+  switch (val.type) {
+    case ZYNK_NULL: return zynkCreateStringLen(manager, "null", 4);
+    case ZYNK_BOOL: return val.as.boolean ? zynkCreateStringLen(manager, "true", 4) : zynkCreateStringLen(manager, "false", 5);
+    case ZYNK_NUMBER: return zynkNumberToString(manager, val.as.number);
+    case ZYNK_BYTE: return zynkNumberToString(manager, val.as.byte);
+    case ZYNK_OBJ: {
+      if (IS_STRING(val)) return zynkCreateStringLen(manager, AS_STRING(val)->string, AS_STRING(val)->len);
+      return zynkNull();
+    }
+    default: return zynkNull();
+  }
+}
+
+Value zynkStringToNumber(Value str_val) {
+  if (!IS_STRING(str_val)) return zynkNull();
+  ZynkString *string=AS_STRING(str_val);
+
+  // surrounding blanks are allowed
+  size_t start=0, end=string->len;
+  while (start<end && (string->string[start]==' ' || string->string[start]=='\t' || string->string[start]=='\n')) start++;
+  while (end>start && (string->string[end-1]==' ' || string->string[end-1]=='\t' || string->string[end-1]=='\n')) end--;
+
+  double number;
+  if (!zynk_parse_number(string->string+start, end-start, &number)) return zynkNull();
+  return zynkNumber(number);
+}
+
+#undef IS_STRING
+#undef AS_STRING
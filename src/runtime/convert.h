@@ -0,0 +1,21 @@
+#ifndef ZYNK_CONVERT
+#define ZYNK_CONVERT
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../common.h"
+#include "types.h"
+#include "objects.h"
+
+// longest output of zynk_format_number, '\0' not included
+#define ZYNK_NUMBER_CHARS 25
+
+uint32_t zynk_format_number(double number, char *out);
+bool zynk_parse_number(const char *str, size_t len, double *out);
+
+Value zynkNumberToString(ArenaManager *manager, double number);
+Value zynkValueToString(ArenaManager *manager, Value val);
+Value zynkStringToNumber(Value str_val);
+
+#endif
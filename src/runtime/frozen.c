@@ -0,0 +1,98 @@
+// Code under LGPL
+#include "frozen.h"
+#include "../common.h"
+#include "memory.h"
+#include "../sysarena/sysarena.h"
+
+#define MAX_SEEDS (1u<<20) // tries per bucket before giving up
+
+// Finds the seed of one bucket, its keys are members[0..size). Slots are
+// taken as they are tried and given back if a later key of the bucket
+// collides.
+static bool place(ZynkFrozen *frozen, ZynkEnvEntry *const *entries, const uint32_t *members, uint32_t size, uint8_t *taken, uint32_t *slots, uint32_t *seed) {
+  for (uint32_t i=0;i<size;i++) {
+    for (uint32_t j=0;j<i;j++) {
+      if (entries[members[i]]->hash==entries[members[j]]->hash) return false;
+    }
+  }
+  for (uint32_t s=0;s<MAX_SEEDS;s++) {
+    uint32_t i=0;
+    for (;i<size;i++) {
+      slots[i]=zynk_frozen_slot(entries[members[i]]->hash, s, frozen->count);
+      if (taken[slots[i]]) break;
+      taken[slots[i]]=1;
+    }
+    if (i==size) {
+      *seed=s;
+      return true;
+    }
+    while (i>0) taken[slots[--i]]=0;
+  }
+  return false;
+}
+
+ZynkFrozen *zynk_frozen_build(ArenaManager *manager, ZynkEnvEntry *const *entries, uint32_t count) {
+  if (manager==NULL || (entries==NULL && count!=0)) {
+    return NULL;
+  }
+  uint32_t buckets=(count+ZYNK_FROZEN_BUCKET-1)/ZYNK_FROZEN_BUCKET;
+  uint8_t *block=(uint8_t *)sysarena_alloc(manager, sizeof(ZynkFrozen)+sizeof(ZynkEnvEntry)*count+sizeof(uint32_t)*(buckets==0 ? 1 : buckets));
+  if (block==NULL) {
+    return NULL;
+  }
+  ZynkFrozen *frozen=(ZynkFrozen *)block;
+  frozen->count=count;
+  frozen->buckets=buckets;
+  frozen->seeds=(uint32_t *)(block+sizeof(ZynkFrozen)+sizeof(ZynkEnvEntry)*count);
+  if (count==0) {
+    return frozen;
+  }
+  // scratch: bucket of each key, bucket starts, keys grouped by bucket,
+  // slots of the bucket being placed and the taken flags
+  size_t scratch_size=sizeof(uint32_t)*((size_t)count*3+buckets+1)+count;
+  uint32_t *of=(uint32_t *)sysarena_alloc(manager, scratch_size);
+  if (of==NULL) {
+    sysarena_free(manager, block);
+    return NULL;
+  }
+  uint32_t *start=of+count;
+  uint32_t *members=start+buckets+1;
+  uint32_t *slots=members+count;
+  uint8_t *taken=(uint8_t *)(slots+count);
+  for (uint32_t b=0;b<=buckets;b++) start[b]=0;
+  for (uint32_t i=0;i<count;i++) {
+    of[i]=zynk_frozen_bucket(entries[i]->hash, buckets);
+    start[of[i]+1]++;
+  }
+  uint32_t biggest=0;
+  for (uint32_t b=0;b<buckets;b++) {
+    if (start[b+1]>biggest) biggest=start[b+1];
+    start[b+1]+=start[b];
+  }
+  for (uint32_t i=0;i<count;i++) {
+    members[start[of[i]]++]=i;
+    taken[i]=0;
+  }
+  for (uint32_t b=buckets;b>0;b--) start[b]=start[b-1]; // the fill moved them one bucket on
+  start[0]=0;
+  bool ok=true;
+  for (uint32_t size=biggest;size>0 && ok;size--) {
+    for (uint32_t b=0;b<buckets && ok;b++) {
+      if (start[b+1]-start[b]!=size) continue;
+      const uint32_t *keys=members+start[b];
+      ok=place(frozen, entries, keys, size, taken, slots, &frozen->seeds[b]);
+      for (uint32_t i=0;i<size && ok;i++) frozen->entries[slots[i]]=*entries[keys[i]];
+    }
+  }
+  for (uint32_t b=0;b<buckets;b++) {
+    if (start[b+1]==start[b]) frozen->seeds[b]=0;
+  }
+  sysarena_free(manager, of);
+  if (!ok) {
+    sysarena_free(manager, block);
+    return NULL;
+  }
+  return frozen;
+}
+
+#undef MAX_SEEDS
@@ -0,0 +1,68 @@
+#ifndef ZYNK_FROZEN
+#define ZYNK_FROZEN
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../common.h"
+#include "types.h"
+#include "zynk_enviroment.h"
+#include "memory.h"
+
+// Read-only layout of the frozen env tables (zynkEnvFreeze): a minimal
+// perfect hash built with CHD (compress, hash and displace). The keys are
+// split in buckets of about ZYNK_FROZEN_BUCKET and, biggest buckets first,
+// each bucket gets the first seed that sends all its keys to free slots.
+// There are as many slots as keys, and a lookup mixes the hash once for
+// the bucket and once with its seed for the slot, then compares a single
+// entry. Values can still be changed in place, the set of keys can't.
+#define ZYNK_FROZEN_BUCKET 4
+
+struct ZynkFrozen {
+  uint32_t count; // keys, and slots
+  uint32_t buckets;
+  uint32_t *seeds; // one per bucket, stored after the entries
+  ZynkEnvEntry entries[];
+};
+
+// Copies the entries as they are, name pointers included. NULL when out of
+// memory or if two keys share the whole hash, no seed tells them apart.
+ZynkFrozen *zynk_frozen_build(ArenaManager *manager, ZynkEnvEntry *const *entries, uint32_t count);
+
+// murmur3 finalizer, every bit of x moves about half of the result
+static inline uint32_t zynk_frozen_mix(uint32_t x) {
+  x^=x>>16;
+  x*=0x85EBCA6Bu;
+  x^=x>>13;
+  x*=0xC2B2AE35u;
+  x^=x>>16;
+  return x;
+}
+
+// the mixed hash goes to [0, n) with a multiply instead of a division;
+// the bucket mix is keyed apart from the slot ones
+static inline uint32_t zynk_frozen_bucket(uint32_t hash, uint32_t buckets) {
+  return (uint32_t)(((uint64_t)zynk_frozen_mix(hash^0x632BE5ABu)*buckets)>>32);
+}
+
+static inline uint32_t zynk_frozen_slot(uint32_t hash, uint32_t seed, uint32_t count) {
+  return (uint32_t)(((uint64_t)zynk_frozen_mix(hash^(seed*0x9E3779B9u))*count)>>32);
+}
+
+// inline, it's the whole lookup of a frozen table
+static inline ZynkEnvEntry *zynk_frozen_find(ZynkFrozen *frozen, const char *key, uint32_t len, uint32_t hash, bool interned) {
+  if (frozen->count==0) {
+    return NULL;
+  }
+  uint32_t seed=frozen->seeds[zynk_frozen_bucket(hash, frozen->buckets)];
+  ZynkEnvEntry *entry=&frozen->entries[zynk_frozen_slot(hash, seed, frozen->count)];
+  if (interned && entry->owner==ZYNK_NAME_ATOM) {
+    return entry->name==key ? entry : NULL;
+  }
+  if (entry->hash==hash && entry->len==len && zynk_strcmp(entry->name, key, len)) {
+    return entry;
+  }
+  return NULL;
+}
+
+#endif
@@ -12,10 +12,42 @@ void init_native_funcs(ArenaManager *manager, ZynkEnv *env) {
   zynkTableNew(env, "pop", zynkCreateNativeFunction(manager, "__pop__", (ZynkFuncPtr)libzynk_pop), manager);
   zynkTableNew(env, "get_index", zynkCreateNativeFunction(manager, "__get_index__", (ZynkFuncPtr)libzynk_get_index), manager);
   zynkTableNew(env, "set_index", zynkCreateNativeFunction(manager, "__set_index__", (ZynkFuncPtr)libzynk_set_index), manager);
+  zynkTableNew(env, "copy", zynkCreateNativeFunction(manager, "__copy__", (ZynkFuncPtr)libzynk_copy), manager);
+  zynkTableNew(env, "map", zynkCreateNativeFunction(manager, "__map__", (ZynkFuncPtr)libzynk_map), manager);
+  zynkTableNew(env, "map_get", zynkCreateNativeFunction(manager, "__map_get__", (ZynkFuncPtr)libzynk_map_get), manager);
+  zynkTableNew(env, "map_set", zynkCreateNativeFunction(manager, "__map_set__", (ZynkFuncPtr)libzynk_map_set), manager);
+  zynkTableNew(env, "map_delete", zynkCreateNativeFunction(manager, "__map_delete__", (ZynkFuncPtr)libzynk_map_delete), manager);
+  zynkTableNew(env, "map_has", zynkCreateNativeFunction(manager, "__map_has__", (ZynkFuncPtr)libzynk_map_has), manager);
+  zynkTableNew(env, "map_keys", zynkCreateNativeFunction(manager, "__map_keys__", (ZynkFuncPtr)libzynk_map_keys), manager);
+  zynkTableNew(env, "map_next", zynkCreateNativeFunction(manager, "__map_next__", (ZynkFuncPtr)libzynk_map_next), manager);
+  zynkTableNew(env, "buffer", zynkCreateNativeFunction(manager, "__buffer__", (ZynkFuncPtr)libzynk_buffer), manager);
+  zynkTableNew(env, "buffer_slice", zynkCreateNativeFunction(manager, "__buffer_slice__", (ZynkFuncPtr)libzynk_buffer_slice), manager);
+  zynkTableNew(env, "buffer_get", zynkCreateNativeFunction(manager, "__buffer_get__", (ZynkFuncPtr)libzynk_buffer_get), manager);
+  zynkTableNew(env, "buffer_set", zynkCreateNativeFunction(manager, "__buffer_set__", (ZynkFuncPtr)libzynk_buffer_set), manager);
+  zynkTableNew(env, "utf8_valid", zynkCreateNativeFunction(manager, "__utf8_valid__", (ZynkFuncPtr)libzynk_utf8_valid), manager);
+  zynkTableNew(env, "utf8_len", zynkCreateNativeFunction(manager, "__utf8_len__", (ZynkFuncPtr)libzynk_utf8_len), manager);
+  zynkTableNew(env, "utf8_index", zynkCreateNativeFunction(manager, "__utf8_index__", (ZynkFuncPtr)libzynk_utf8_index), manager);
+  zynkTableNew(env, "utf8_sub", zynkCreateNativeFunction(manager, "__utf8_sub__", (ZynkFuncPtr)libzynk_utf8_sub), manager);
+  zynkTableNew(env, "find", zynkCreateNativeFunction(manager, "__find__", (ZynkFuncPtr)libzynk_find), manager);
+  zynkTableNew(env, "rfind", zynkCreateNativeFunction(manager, "__rfind__", (ZynkFuncPtr)libzynk_rfind), manager);
+  zynkTableNew(env, "count", zynkCreateNativeFunction(manager, "__count__", (ZynkFuncPtr)libzynk_count), manager);
+  zynkTableNew(env, "split", zynkCreateNativeFunction(manager, "__split__", (ZynkFuncPtr)libzynk_split), manager);
+  zynkTableNew(env, "replace", zynkCreateNativeFunction(manager, "__replace__", (ZynkFuncPtr)libzynk_replace), manager);
+  zynkTableNew(env, "tostring", zynkCreateNativeFunction(manager, "__tostring__", (ZynkFuncPtr)libzynk_tostring), manager);
+  zynkTableNew(env, "tonumber", zynkCreateNativeFunction(manager, "__tonumber__", (ZynkFuncPtr)libzynk_tonumber), manager);
+  zynkTableNew(env, "sort", zynkCreateNativeFunction(manager, "__sort__", (ZynkFuncPtr)libzynk_sort), manager);
+  zynkTableNew(env, "memoize", zynkCreateNativeFunction(manager, "__memoize__", (ZynkFuncPtr)libzynk_memoize), manager);
+  zynkTableNew(env, "memo_stats", zynkCreateNativeFunction(manager, "__memo_stats__", (ZynkFuncPtr)libzynk_memo_stats), manager);
+  zynkTableNew(env, "memo_clear", zynkCreateNativeFunction(manager, "__memo_clear__", (ZynkFuncPtr)libzynk_memo_clear), manager);
+#ifdef ZYNK_POSIX
+  zynkTableNew(env, "buffer_map", zynkCreateNativeFunction(manager, "__buffer_map__", (ZynkFuncPtr)libzynk_buffer_map), manager);
+  zynkTableNew(env, "buffer_read", zynkCreateNativeFunction(manager, "__buffer_read__", (ZynkFuncPtr)libzynk_buffer_read), manager);
+  zynkTableNew(env, "buffer_write", zynkCreateNativeFunction(manager, "__buffer_write__", (ZynkFuncPtr)libzynk_buffer_write), manager);
+#endif
 }
 
 Value libzynk_len(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
-  if (manager == NULL || env==NULL) return zynkNull();
+  if (manager == NULL || env==NULL || args->len<1) return zynkNull();
 
   Value obj = args->array[0];
 
@@ -24,12 +56,14 @@ Value libzynk_len(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
   switch (obj.as.obj->type) {
     case ObjString: return zynkNumber(obj.as.obj->obj.string->len);
     case ObjArray: return zynkNumber(obj.as.obj->obj.array->len);
+    case ObjMap: return zynkNumber(obj.as.obj->obj.map->len);
+    case ObjBuffer: return zynkNumber((double)obj.as.obj->obj.buffer->len);
     default: return zynkNull();
   }
 }
 
 Value libzynk_push(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
-  if (manager==NULL || env==NULL) return zynkBool(false);
+  if (manager==NULL || env==NULL || args->len<2) return zynkBool(false);
 
   Value obj = args->array[0];
   Value new_element = args->array[1];
@@ -39,6 +73,7 @@ Value libzynk_push(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
   switch (obj.as.obj->type) {
     case ObjString: {
       if (!IS_OBJ(new_element)) return zynkBool(false);
+      if (!zynkStringDetach(manager, obj.as.obj->obj.string)) return zynkBool(false);
       char *ptr=obj.as.obj->obj.string->string;
       uint32_t new_cap = obj.as.obj->obj.string->len+2; // hay que tener en cuenta '\0'
       ptr=(char*)reallocate(manager, (uint8_t*)ptr, obj.as.obj->obj.string->len+1, new_cap);
@@ -46,6 +81,8 @@ Value libzynk_push(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
       ptr[new_cap-2]=(char)new_element.as.obj->obj.string->string[0];
       ptr[new_cap-1]='\0';
       obj.as.obj->obj.string->string=ptr;
+      obj.as.obj->obj.string->len++;
+      obj.as.obj->obj.string->kind=ZYNK_STR_UNKNOWN;
       return zynkBool(true);
                     }
     case ObjArray: {
@@ -57,7 +94,7 @@ Value libzynk_push(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
 }
 
 Value libzynk_pop(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
-  if (manager==NULL || env==NULL) return zynkNull();
+  if (manager==NULL || env==NULL || args->len<1) return zynkNull();
 
   Value obj = args->array[0];
 
@@ -66,6 +103,7 @@ Value libzynk_pop(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
   switch (obj.as.obj->type) {
     case ObjString: {
       if (obj.as.obj->obj.string->len<=0) return zynkNull();
+      if (!zynkStringDetach(manager, obj.as.obj->obj.string)) return zynkNull();
       uint32_t len=obj.as.obj->obj.string->len;
       char *ptr=obj.as.obj->obj.string->string;
       char result=ptr[len-1];
@@ -74,6 +112,7 @@ Value libzynk_pop(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
       ptr[len-1]='\0';
       obj.as.obj->obj.string->string=ptr;
       obj.as.obj->obj.string->len--;
+      obj.as.obj->obj.string->kind=ZYNK_STR_UNKNOWN;
       char buff[2];
       buff[0]=result;
       buff[1]='\0';
@@ -89,7 +128,7 @@ Value libzynk_pop(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
 }
 
 Value libzynk_get_index(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
-  if (manager==NULL || env==NULL) return zynkNull();
+  if (manager==NULL || env==NULL || args->len<2) return zynkNull();
 
   Value obj = args->array[0];
   uint32_t index = args->array[1].as.number;
@@ -98,21 +137,22 @@ Value libzynk_get_index(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
   switch (obj.as.obj->type) {
     case ObjString: {
       uint32_t len=obj.as.obj->obj.string->len;
-      if (!(len <= index)) return zynkNull();
+      if (len <= index) return zynkNull();
       char buff[2];
       buff[0]=obj.as.obj->obj.string->string[index];
       buff[1]='\0';
       return zynkCreateString(manager, (const char*)buff);
                     }
     case ObjArray: {
-      return zynkArrayGet(obj, args->array[1]);
+      return zynk_retain(zynkArrayGet(obj, args->array[1]));
                    }
+    case ObjBuffer: return zynkBufferGet(obj, args->array[1]);
     default: return zynkNull();
   }
 }
 
 Value libzynk_set_index(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
-  if (manager==NULL || env==NULL) return zynkNull();
+  if (manager==NULL || env==NULL || args->len<3) return zynkNull();
 
   Value obj = args->array[0];
   uint32_t index = args->array[1].as.number;
@@ -121,17 +161,294 @@ Value libzynk_set_index(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
   switch (obj.as.obj->type) {
     case ObjString: {
       uint32_t len=obj.as.obj->obj.string->len;
-      if (!(len <= index)) return zynkBool(false);
-      if (!(new_element.as.obj->type==ObjString)) return zynkBool(false);
+      if (len <= index) return zynkBool(false);
+      if (!IS_OBJ(new_element) || !(new_element.as.obj->type==ObjString)) return zynkBool(false);
       obj.as.obj->obj.string->string[index]=new_element.as.obj->obj.string->string[0];
+      obj.as.obj->obj.string->kind=ZYNK_STR_UNKNOWN;
       return zynkBool(true);
                     }
     case ObjArray: {
       zynkArraySet(manager, obj, args->array[1], new_element);
       return zynkBool(true);
                    }
+    case ObjBuffer: return zynkBool(zynkBufferSet(obj, args->array[1], new_element));
+    default: return zynkBool(false);
   }
 }
 
+Value libzynk_copy(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<1) return zynkNull();
+
+  return zynkArrayCopy(manager, args->array[0]);
+}
+
+Value libzynk_map(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL) return zynkNull();
+
+  uint32_t capacity=0;
+  if (args->len>0 && args->array[0].type==ZYNK_NUMBER) capacity=args->array[0].as.number;
+  return zynkCreateMap(manager, capacity);
+}
+
+Value libzynk_map_get(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<2) return zynkNull();
+
+  return zynk_retain(zynkMapGet(args->array[0], args->array[1]));
+}
+
+Value libzynk_map_set(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<3) return zynkBool(false);
+
+  return zynkBool(zynkMapSet(manager, args->array[0], args->array[1], args->array[2]));
+}
+
+Value libzynk_map_delete(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<2) return zynkBool(false);
+
+  return zynkBool(zynkMapDelete(manager, args->array[0], args->array[1]));
+}
+
+Value libzynk_map_has(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<2) return zynkBool(false);
+
+  return zynkBool(zynkMapHas(args->array[0], args->array[1]));
+}
+
+Value libzynk_map_keys(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<1) return zynkNull();
+
+  return zynkMapKeys(manager, args->array[0]);
+}
+
+// map_next(map, cursor) -> [next_cursor, key, value] or null at the end
+Value libzynk_map_next(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<2) return zynkNull();
+  if (args->array[1].type!=ZYNK_NUMBER) return zynkNull();
+
+  uint32_t cursor=args->array[1].as.number;
+  Value key, value;
+  if (!zynkMapNext(args->array[0], &cursor, &key, &value)) return zynkNull();
+
+  Value step=zynkCreateArray(manager, 3);
+  if (step.type==ZYNK_NULL) return step;
+  zynkArrayPush(manager, step, zynkNumber(cursor));
+  zynkArrayPush(manager, step, key);
+  zynkArrayPush(manager, step, value);
+  return step;
+}
+
+static const char *asPath(Value val) {
+  if (!IS_OBJ(val) || val.as.obj==NULL || val.as.obj->type!=ObjString) return NULL;
+  return val.as.obj->obj.string->string;
+}
+
+static double numberArg(ZynkArray *args, uint32_t i, double otherwise) {
+  if (args->len<=i || args->array[i].type!=ZYNK_NUMBER) return otherwise;
+  return args->array[i].as.number;
+}
+
+// doubles at or past SIZE_MAX (and NaN) don't convert to size_t, clamp them
+static size_t sizeArg(double n) {
+  if (!(n<(double)SIZE_MAX)) return SIZE_MAX;
+  return (size_t)n;
+}
+
+Value libzynk_buffer(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL) return zynkNull();
+
+  double len=numberArg(args, 0, 0);
+  if (len<0) return zynkNull();
+  return zynkCreateBuffer(manager, sizeArg(len));
+}
+
+// buffer_slice(buffer, start, end)
+Value libzynk_buffer_slice(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<1) return zynkNull();
+
+  double start=numberArg(args, 1, 0);
+  double end=numberArg(args, 2, (double)SIZE_MAX);
+  if (start<0 || end<0) return zynkNull();
+  return zynkBufferSlice(manager, args->array[0], sizeArg(start), sizeArg(end));
+}
+
+Value libzynk_buffer_get(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<2) return zynkNull();
+
+  return zynkBufferGet(args->array[0], args->array[1]);
+}
+
+Value libzynk_buffer_set(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<3) return zynkBool(false);
+
+  return zynkBool(zynkBufferSet(args->array[0], args->array[1], args->array[2]));
+}
+
+Value libzynk_utf8_valid(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<1) return zynkBool(false);
+
+  Value str=args->array[0];
+  if (!IS_OBJ(str) || str.as.obj==NULL || str.as.obj->type!=ObjString) return zynkBool(false);
+  return zynkBool(zynkStringKind(str.as.obj->obj.string)!=ZYNK_STR_INVALID);
+}
+
+Value libzynk_utf8_len(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<1) return zynkNull();
+
+  return zynkStringCodePointLen(args->array[0]);
+}
+
+// utf8_index(str, i) -> string with the i-th code point
+Value libzynk_utf8_index(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<2) return zynkNull();
+
+  double index=numberArg(args, 1, -1);
+  if (index<0) return zynkNull();
+  return zynkStringCodePointAt(manager, args->array[0], sizeArg(index));
+}
+
+// utf8_sub(str, start, end) -> code points [start, end)
+Value libzynk_utf8_sub(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<2) return zynkNull();
+
+  double start=numberArg(args, 1, -1);
+  double end=numberArg(args, 2, (double)SIZE_MAX);
+  if (start<0 || end<0) return zynkNull();
+  return zynkStringCodePointSub(manager, args->array[0], sizeArg(start), sizeArg(end));
+}
+
+// find(str, sub, start) -> byte offset or -1
+Value libzynk_find(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<2) return zynkNull();
+
+  double start=numberArg(args, 2, 0);
+  if (start<0) return zynkNull();
+  return zynkStringFind(args->array[0], args->array[1], sizeArg(start));
+}
+
+Value libzynk_rfind(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<2) return zynkNull();
+
+  return zynkStringRFind(args->array[0], args->array[1]);
+}
+
+Value libzynk_count(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<2) return zynkNull();
+
+  return zynkStringCount(args->array[0], args->array[1]);
+}
+
+Value libzynk_split(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<2) return zynkNull();
+
+  return zynkStringSplit(manager, args->array[0], args->array[1]);
+}
+
+// replace(str, old, new)
+Value libzynk_replace(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<3) return zynkNull();
+
+  return zynkStringReplace(manager, args->array[0], args->array[1], args->array[2]);
+}
+
+// tostring(value)
+Value libzynk_tostring(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<1) return zynkNull();
+
+  return zynkValueToString(manager, args->array[0]);
+}
+
+// tonumber(string), null if it isn't a number
+Value libzynk_tonumber(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<1) return zynkNull();
+
+  Value val=args->array[0];
+  if (val.type==ZYNK_NUMBER) return val;
+  if (val.type==ZYNK_BYTE) return zynkNumber(val.as.byte);
+  return zynkStringToNumber(val);
+}
+
+// sort(array[, comparator])
+Value libzynk_sort(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<1) return zynkBool(false);
+
+  Value comparator=(args->len>1) ? args->array[1] : zynkNull();
+  return zynkBool(zynkArraySort(manager, env, args->array[0], comparator));
+}
+
+// memoize(native[, capacity]), the native must be pure
+Value libzynk_memoize(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<1) return zynkBool(false);
+
+  double capacity=numberArg(args, 1, 0);
+  if (capacity<0 || capacity>UINT32_MAX) return zynkBool(false);
+  return zynkBool(zynkMemoEnable(manager, args->array[0], (uint32_t)capacity));
+}
+
+static void statEntry(ArenaManager *manager, Value map, const char *name, double number) {
+  Value key=zynkCreateString(manager, name);
+  zynkMapSet(manager, map, key, zynkNumber(number));
+  zynk_release(key, manager);
+}
+
+// memo_stats(native) -> {hits, misses, evictions, invalidations, size, capacity}
+Value libzynk_memo_stats(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<1) return zynkNull();
+
+  ZynkMemoStats stats;
+  if (!zynkMemoGetStats(args->array[0], &stats)) return zynkNull();
+  Value map=zynkCreateMap(manager, 7);
+  if (map.type==ZYNK_NULL) return map;
+  statEntry(manager, map, "hits", (double)stats.hits);
+  statEntry(manager, map, "misses", (double)stats.misses);
+  statEntry(manager, map, "evictions", (double)stats.evictions);
+  statEntry(manager, map, "invalidations", (double)stats.invalidations);
+  statEntry(manager, map, "skipped", (double)stats.skipped);
+  statEntry(manager, map, "size", stats.len);
+  statEntry(manager, map, "capacity", stats.capacity);
+  return map;
+}
+
+// memo_clear(native)
+Value libzynk_memo_clear(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<1) return zynkBool(false);
+
+  return zynkBool(zynkMemoInvalidate(manager, args->array[0]));
+}
+
+#ifdef ZYNK_POSIX
+
+// buffer_map(path)
+Value libzynk_buffer_map(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<1) return zynkNull();
+
+  const char *path=asPath(args->array[0]);
+  if (path==NULL) return zynkNull();
+  return zynkBufferMapFile(manager, path);
+}
+
+// buffer_read(path, offset, len)
+Value libzynk_buffer_read(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<3) return zynkNull();
+
+  const char *path=asPath(args->array[0]);
+  double offset=numberArg(args, 1, -1);
+  double len=numberArg(args, 2, -1);
+  if (path==NULL || offset<0 || len<0) return zynkNull();
+  return zynkBufferReadFile(manager, path, (uint64_t)offset, sizeArg(len));
+}
+
+// buffer_write(path, buffer, offset) -> bytes written
+Value libzynk_buffer_write(ArenaManager *manager, ZynkEnv *env, ZynkArray *args) {
+  if (manager==NULL || env==NULL || args->len<2) return zynkNull();
+
+  const char *path=asPath(args->array[0]);
+  double offset=numberArg(args, 2, 0);
+  if (path==NULL || offset<0) return zynkNull();
+  int64_t written=zynkBufferWriteFile(args->array[1], path, (uint64_t)offset);
+  if (written<0) return zynkNull();
+  return zynkNumber((double)written);
+}
+
+#endif // ZYNK_POSIX
 
 #undef IS_OBJ
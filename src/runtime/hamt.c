@@ -0,0 +1,348 @@
+#include "hamt.h"
+#include "../common.h"
+#include "memory.h"
+#include "simd.h"
+#include "object_rf.h"
+#include "../sysarena/sysarena.h"
+#include "value_inline.h"
+
+#define SLOT(hash, shift) (1u<<(((hash)>>(shift)) & 31))
+#define INDEX(node, bit) ((uint32_t)zynk_popcount((node)->bitmap & ((bit)-1)))
+#define REFS(item) (*(uint32_t *)(item)) // nodes and leaves both start with it
+
+typedef struct {
+  int op;
+  const char *key;
+  uint32_t len;
+  uint32_t hash;
+  Value value;
+  bool moved;
+  bool oom;
+} Edit;
+
+static ZynkHamtNode *node_alloc(ArenaManager *manager, uint32_t len) {
+  ZynkHamtNode *node=(ZynkHamtNode *)sysarena_alloc(manager, sizeof(ZynkHamtNode)+sizeof(void *)*(len==0 ? 1 : len));
+  if (node==NULL) return NULL;
+  node->refs=1;
+  node->bitmap=0;
+  node->nodemap=0;
+  node->len=len;
+  return node;
+}
+
+static ZynkHamtLeaf *leaf_new(ArenaManager *manager, const char *key, uint32_t len, uint32_t hash, Value value) {
+  ZynkHamtLeaf *leaf=(ZynkHamtLeaf *)sysarena_alloc(manager, sizeof(ZynkHamtLeaf)+len+1);
+  if (leaf==NULL) return NULL;
+  leaf->refs=1;
+  zynk_cpy((uint8_t *)leaf->name, (const uint8_t *)key, len+1);
+  leaf->entry.name=leaf->name;
+  leaf->entry.hash=hash;
+  leaf->entry.len=len;
+  leaf->entry.owner=ZYNK_NAME_COPY;
+  zynk_retain(value);
+  leaf->entry.value=value;
+  return leaf;
+}
+
+static void release_leaf(ArenaManager *manager, ZynkHamtLeaf *leaf) {
+  if (--leaf->refs>0) return;
+  zynk_release(leaf->entry.value, manager);
+  sysarena_free(manager, leaf);
+}
+
+static void release_node(ArenaManager *manager, ZynkHamtNode *node) {
+  if (--node->refs>0) return;
+  uint32_t bits=node->bitmap;
+  for (uint32_t i=0;i<node->len;i++) {
+    // collision nodes have no nodemap, their bitmap means nothing
+    if (node->nodemap!=0 && (node->nodemap & bits & (0u-bits))) {
+      release_node(manager, (ZynkHamtNode *)node->slots[i]);
+    } else {
+      release_leaf(manager, (ZynkHamtLeaf *)node->slots[i]);
+    }
+    bits&=bits-1;
+  }
+  sysarena_free(manager, node);
+}
+
+// Copy of `node` with the slot at idx dropped, or a new (unset) one
+// inserted there. If `unique` the children move and the old node is freed,
+// otherwise they are shared and the old node is left as it was.
+static ZynkHamtNode *resize(ArenaManager *manager, ZynkHamtNode *node, bool unique, uint32_t idx, bool insert) {
+  ZynkHamtNode *copy=node_alloc(manager, insert ? node->len+1 : node->len-1);
+  if (copy==NULL) return NULL;
+  copy->bitmap=node->bitmap;
+  copy->nodemap=node->nodemap;
+  for (uint32_t i=0, j=0;i<node->len;i++) {
+    if (i==idx) {
+      if (!insert) continue;
+      j++;
+    }
+    copy->slots[j]=node->slots[i];
+    if (!unique) REFS(copy->slots[j])++;
+    j++;
+  }
+  if (unique) sysarena_free(manager, node);
+  return copy;
+}
+
+// same slots, children shared
+static ZynkHamtNode *clone(ArenaManager *manager, ZynkHamtNode *node) {
+  ZynkHamtNode *copy=node_alloc(manager, node->len);
+  if (copy==NULL) return NULL;
+  copy->bitmap=node->bitmap;
+  copy->nodemap=node->nodemap;
+  for (uint32_t i=0;i<node->len;i++) {
+    copy->slots[i]=node->slots[i];
+    REFS(copy->slots[i])++;
+  }
+  return copy;
+}
+
+// frees the nodes merge built, down to the one holding both leaves; the
+// leaves themselves stay with the caller
+static void release_chain(ArenaManager *manager, ZynkHamtNode *node) {
+  while (node->nodemap!=0) {
+    ZynkHamtNode *child=(ZynkHamtNode *)node->slots[0];
+    sysarena_free(manager, node);
+    node=child;
+  }
+  sysarena_free(manager, node);
+}
+
+// node holding two leaves whose hashes agree below `shift`, takes their references
+static ZynkHamtNode *merge(ArenaManager *manager, ZynkHamtLeaf *a, ZynkHamtLeaf *b, uint32_t shift) {
+  if (shift>=32) {
+    ZynkHamtNode *node=node_alloc(manager, 2);
+    if (node==NULL) return NULL;
+    node->slots[0]=a;
+    node->slots[1]=b;
+    return node;
+  }
+  uint32_t bit_a=SLOT(a->entry.hash, shift);
+  uint32_t bit_b=SLOT(b->entry.hash, shift);
+  if (bit_a==bit_b) {
+    ZynkHamtNode *child=merge(manager, a, b, shift+ZYNK_HAMT_BITS);
+    if (child==NULL) return NULL;
+    ZynkHamtNode *node=node_alloc(manager, 1);
+    if (node==NULL) {
+      release_chain(manager, child);
+      return NULL;
+    }
+    node->bitmap=bit_a;
+    node->nodemap=bit_a;
+    node->slots[0]=child;
+    return node;
+  }
+  ZynkHamtNode *node=node_alloc(manager, 2);
+  if (node==NULL) return NULL;
+  node->bitmap=bit_a | bit_b;
+  node->slots[bit_a<bit_b ? 0 : 1]=a;
+  node->slots[bit_a<bit_b ? 1 : 0]=b;
+  return node;
+}
+
+// Replaces the leaf at idx with a copy holding the new value (or writes the
+// value in place when nothing else sees the leaf). Returns what the parent
+// should point to.
+static ZynkHamtNode *set_leaf(ArenaManager *manager, ZynkHamtNode *node, bool unique, uint32_t idx, Edit *ed) {
+  ZynkHamtLeaf *leaf=(ZynkHamtLeaf *)node->slots[idx];
+  if (unique && leaf->refs==1) {
+    zynk_retain(ed->value);
+    zynk_release(leaf->entry.value, manager);
+    leaf->entry.value=ed->value;
+    return node;
+  }
+  ZynkHamtLeaf *copy=leaf_new(manager, leaf->name, leaf->entry.len, leaf->entry.hash, ed->value);
+  if (copy==NULL) {
+    ed->oom=true;
+    return node;
+  }
+  ZynkHamtNode *target=unique ? node : clone(manager, node);
+  if (target==NULL) {
+    release_leaf(manager, copy);
+    ed->oom=true;
+    return node;
+  }
+  target->slots[idx]=copy;
+  release_leaf(manager, leaf); // the reference of this node, or the one clone took
+  ed->moved=true;
+  return target;
+}
+
+// removes the leaf at idx, NULL if the node is left empty (and isn't the root)
+static ZynkHamtNode *drop_slot(ArenaManager *manager, ZynkHamtNode *node, bool unique, uint32_t idx, uint32_t bit, uint32_t shift, Edit *ed) {
+  ZynkHamtLeaf *leaf=(ZynkHamtLeaf *)node->slots[idx];
+  if (node->len==1 && shift>0) {
+    if (unique) {
+      release_leaf(manager, leaf);
+      sysarena_free(manager, node);
+    }
+    return NULL;
+  }
+  ZynkHamtNode *copy=resize(manager, node, unique, idx, false);
+  if (copy==NULL) {
+    ed->oom=true;
+    return node;
+  }
+  copy->bitmap&=~bit;
+  if (unique) release_leaf(manager, leaf);
+  return copy;
+}
+
+static ZynkHamtNode *edit_collision(ArenaManager *manager, ZynkHamtNode *node, bool unique, uint32_t shift, Edit *ed) {
+  uint32_t idx=0;
+  while (idx<node->len) {
+    ZynkEnvEntry *entry=&((ZynkHamtLeaf *)node->slots[idx])->entry;
+    if (entry->len==ed->len && zynk_strcmp(entry->name, ed->key, ed->len)) break;
+    idx++;
+  }
+  if (ed->op==ZYNK_HAMT_SET) return set_leaf(manager, node, unique, idx, ed);
+  if (ed->op==ZYNK_HAMT_DELETE) return drop_slot(manager, node, unique, idx, 0, shift, ed);
+  ZynkHamtLeaf *leaf=leaf_new(manager, ed->key, ed->len, ed->hash, ed->value);
+  if (leaf==NULL) {
+    ed->oom=true;
+    return node;
+  }
+  ZynkHamtNode *copy=resize(manager, node, unique, node->len, true);
+  if (copy==NULL) {
+    release_leaf(manager, leaf);
+    ed->oom=true;
+    return node;
+  }
+  copy->slots[copy->len-1]=leaf;
+  return copy;
+}
+
+// Applies the edit below `node` and returns what its parent should point
+// to: the same node if it was changed in place, a new one, or NULL if it
+// was emptied. On a failed allocation ed->oom is set and `node` returned.
+static ZynkHamtNode *edit(ArenaManager *manager, ZynkHamtNode *node, uint32_t shift, bool unique, Edit *ed) {
+  unique=unique && node->refs==1;
+  if (shift>=32) return edit_collision(manager, node, unique, shift, ed);
+  uint32_t bit=SLOT(ed->hash, shift);
+  uint32_t idx=INDEX(node, bit);
+
+  if (!(node->bitmap & bit)) { // only NEW gets here
+    ZynkHamtLeaf *leaf=leaf_new(manager, ed->key, ed->len, ed->hash, ed->value);
+    if (leaf==NULL) {
+      ed->oom=true;
+      return node;
+    }
+    ZynkHamtNode *copy=resize(manager, node, unique, idx, true);
+    if (copy==NULL) {
+      release_leaf(manager, leaf);
+      ed->oom=true;
+      return node;
+    }
+    copy->bitmap|=bit;
+    copy->slots[idx]=leaf;
+    return copy;
+  }
+
+  if (node->nodemap & bit) {
+    ZynkHamtNode *child=(ZynkHamtNode *)node->slots[idx];
+    bool child_unique=unique && child->refs==1;
+    ZynkHamtNode *result=edit(manager, child, shift+ZYNK_HAMT_BITS, unique, ed);
+    if (ed->oom || result==child) return node;
+    if (result==NULL) { // emptied
+      if (node->len==1 && shift>0) {
+        if (unique) {
+          if (!child_unique) release_node(manager, child);
+          sysarena_free(manager, node);
+        }
+        return NULL;
+      }
+      ZynkHamtNode *copy=resize(manager, node, unique, idx, false);
+      if (copy==NULL) {
+        ed->oom=true;
+        return node;
+      }
+      copy->bitmap&=~bit;
+      copy->nodemap&=~bit;
+      if (unique && !child_unique) release_node(manager, child);
+      return copy;
+    }
+    ZynkHamtNode *target=unique ? node : clone(manager, node);
+    if (target==NULL) {
+      ed->oom=true;
+      return node;
+    }
+    target->slots[idx]=result;
+    if (!child_unique) release_node(manager, child);
+    return target;
+  }
+
+  ZynkHamtLeaf *leaf=(ZynkHamtLeaf *)node->slots[idx];
+  if (ed->op==ZYNK_HAMT_SET) return set_leaf(manager, node, unique, idx, ed);
+  if (ed->op==ZYNK_HAMT_DELETE) return drop_slot(manager, node, unique, idx, bit, shift, ed);
+
+  // NEW over a leaf with another key: both go one level down
+  ZynkHamtLeaf *fresh=leaf_new(manager, ed->key, ed->len, ed->hash, ed->value);
+  if (fresh==NULL) {
+    ed->oom=true;
+    return node;
+  }
+  ZynkHamtNode *target=unique ? node : clone(manager, node);
+  ZynkHamtNode *child=target==NULL ? NULL : merge(manager, leaf, fresh, shift+ZYNK_HAMT_BITS);
+  if (child==NULL) {
+    if (target!=NULL && target!=node) release_node(manager, target);
+    release_leaf(manager, fresh);
+    ed->oom=true;
+    return node;
+  }
+  // the slot's reference to the old leaf (this node's or clone's) moved to child
+  target->slots[idx]=child;
+  target->nodemap|=bit;
+  return target;
+}
+
+ZynkHamtNode *zynk_hamt_new(ArenaManager *manager) {
+  return node_alloc(manager, 0);
+}
+
+void zynk_hamt_retain(ZynkHamtNode *root) {
+  if (root!=NULL) root->refs++;
+}
+
+void zynk_hamt_release(ArenaManager *manager, ZynkHamtNode *root) {
+  if (root!=NULL) release_node(manager, root);
+}
+
+ZynkEnvEntry *zynk_hamt_find(ZynkHamtNode *node, const char *key, uint32_t len, uint32_t hash) {
+  for (uint32_t shift=0;shift<32;shift+=ZYNK_HAMT_BITS) {
+    uint32_t bit=SLOT(hash, shift);
+    if (!(node->bitmap & bit)) return NULL;
+    void *slot=node->slots[INDEX(node, bit)];
+    if (node->nodemap & bit) {
+      node=(ZynkHamtNode *)slot;
+      continue;
+    }
+    ZynkEnvEntry *entry=&((ZynkHamtLeaf *)slot)->entry;
+    if (entry->hash==hash && entry->len==len && zynk_strcmp(entry->name, key, len)) return entry;
+    return NULL;
+  }
+  for (uint32_t i=0;i<node->len;i++) {
+    ZynkEnvEntry *entry=&((ZynkHamtLeaf *)node->slots[i])->entry;
+    if (entry->len==len && zynk_strcmp(entry->name, key, len)) return entry;
+  }
+  return NULL;
+}
+
+bool zynk_hamt_edit(ArenaManager *manager, ZynkHamtNode **root, int op, const char *key, uint32_t len, uint32_t hash, Value value, bool *moved) {
+  Edit ed={op, key, len, hash, value, false, false};
+  ZynkHamtNode *old=*root;
+  bool unique=old->refs==1;
+  ZynkHamtNode *result=edit(manager, old, 0, true, &ed);
+  if (ed.oom) return false;
+  if (result!=old) {
+    if (!unique) release_node(manager, old);
+    *root=result;
+  }
+  if (moved!=NULL) *moved=ed.moved || op!=ZYNK_HAMT_SET;
+  return true;
+}
+
+#undef SLOT
+#undef INDEX
+#undef REFS
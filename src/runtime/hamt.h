@@ -0,0 +1,47 @@
+#ifndef ZYNK_HAMT
+#define ZYNK_HAMT
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../common.h"
+#include "types.h"
+#include "zynk_enviroment.h"
+
+// Hash array mapped trie behind the persistent env tables
+// (zynkEnvInitPersistent). Each level takes ZYNK_HAMT_BITS of the hash to
+// pick one of 32 slots, a bitmap says which are used and only those are
+// stored. Past the 32 hash bits a node is a plain list of colliding leaves.
+// Nodes and leaves are reference counted so snapshots share them: an
+// update copies the path down to the leaf it changes, except the part of
+// it that nothing else references, which is changed in place.
+#define ZYNK_HAMT_BITS 5
+
+#define ZYNK_HAMT_NEW 0
+#define ZYNK_HAMT_SET 1
+#define ZYNK_HAMT_DELETE 2
+
+typedef struct {
+  uint32_t refs;
+  ZynkEnvEntry entry; // entry.name points to name
+  char name[];
+} ZynkHamtLeaf;
+
+struct ZynkHamtNode {
+  uint32_t refs;
+  uint32_t bitmap; // used slots
+  uint32_t nodemap; // used slots holding a child node, the rest hold leaves
+  uint32_t len;
+  void *slots[];
+};
+
+ZynkHamtNode *zynk_hamt_new(ArenaManager *manager);
+void zynk_hamt_retain(ZynkHamtNode *root);
+void zynk_hamt_release(ArenaManager *manager, ZynkHamtNode *root);
+ZynkEnvEntry *zynk_hamt_find(ZynkHamtNode *root, const char *key, uint32_t len, uint32_t hash);
+// NEW expects the key to be missing, SET and DELETE to be there. *root is
+// replaced when the root had to be copied. *moved tells whether the
+// entry of the key now lives somewhere else (pointers to it are stale).
+bool zynk_hamt_edit(ArenaManager *manager, ZynkHamtNode **root, int op, const char *key, uint32_t len, uint32_t hash, Value value, bool *moved);
+
+#endif
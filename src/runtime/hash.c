@@ -1,16 +1,210 @@
+// Code under LGPL
+// Strings hash with wyhash (Wang Yi, final version 4): 8 bytes per step,
+// 48 per loop iteration, one 64x64->128 multiply per mix.
+#ifdef __unix__
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdatomic.h>
 #include "hash.h"
+#include "objects.h"
+#include "memory.h"
+
+#ifdef ZYNK_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static const uint64_t secret[4]={0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL};
+
+#define SEED_NONE 0
+#define SEED_BUSY 1 // a thread is drawing it, the others wait
+#define SEED_SET 2
+
+static uint64_t hash_seed;    // already mixed with the secret
+static uint64_t raw_seed;
+static atomic_int seed_state=SEED_NONE; // readers of the two above load it first
+
+static inline void wymum(uint64_t *a, uint64_t *b) {
+#if defined(__SIZEOF_INT128__)
+  __uint128_t r=(__uint128_t)*a * *b;
+  *a=(uint64_t)r;
+  *b=(uint64_t)(r>>64);
+#else
+  uint64_t ha=*a>>32, hb=*b>>32, la=(uint32_t)*a, lb=(uint32_t)*b;
+  uint64_t rh=ha*hb, rm0=ha*lb, rm1=hb*la, rl=la*lb;
+  uint64_t t=rl+(rm0<<32), c=t<rl;
+  uint64_t lo=t+(rm1<<32);
+  c+=lo<t;
+  *a=lo;
+  *b=rh+(rm0>>32)+(rm1>>32)+c;
+#endif
+}
+
+static inline uint64_t wymix(uint64_t a, uint64_t b) {
+  wymum(&a, &b);
+  return a^b;
+}
+
+// little endian loads
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__==__ORDER_LITTLE_ENDIAN__
+static inline uint64_t read64(const uint8_t *p) {
+  uint64_t v;
+  __builtin_memcpy(&v, p, 8);
+  return v;
+}
+
+static inline uint64_t read32(const uint8_t *p) {
+  uint32_t v;
+  __builtin_memcpy(&v, p, 4);
+  return v;
+}
+#else
+static inline uint64_t read64(const uint8_t *p) {
+  return (uint64_t)p[0] | (uint64_t)p[1]<<8 | (uint64_t)p[2]<<16 | (uint64_t)p[3]<<24 |
+         (uint64_t)p[4]<<32 | (uint64_t)p[5]<<40 | (uint64_t)p[6]<<48 | (uint64_t)p[7]<<56;
+}
+
+static inline uint64_t read32(const uint8_t *p) {
+  return (uint64_t)p[0] | (uint64_t)p[1]<<8 | (uint64_t)p[2]<<16 | (uint64_t)p[3]<<24;
+}
+#endif
+
+static inline uint64_t read3(const uint8_t *p, size_t k) {
+  return ((uint64_t)p[0]<<16) | ((uint64_t)p[k>>1]<<8) | p[k-1];
+}
+
+// OS randomness when there is some, else whatever ASLR gives us
+static uint64_t randomSeed(void) {
+  uint64_t seed=0;
+#ifdef ZYNK_POSIX
+  int fd=open("/dev/urandom", O_RDONLY);
+  if (fd>=0) {
+    uint8_t bytes[8];
+    if (read(fd, bytes, sizeof(bytes))==(ssize_t)sizeof(bytes)) seed=read64(bytes);
+    close(fd);
+  }
+#endif
+  int local;
+  seed^=wymix((uint64_t)(uintptr_t)&local^secret[2], (uint64_t)(uintptr_t)&randomSeed^secret[3]);
+  return seed;
+}
+
+static void set_seed(uint64_t seed) {
+  raw_seed=seed;
+  hash_seed=seed^wymix(seed^secret[0], secret[1]);
+}
+
+void zynk_hash_seed(uint64_t seed) {
+  set_seed(seed);
+  atomic_store_explicit(&seed_state, SEED_SET, memory_order_release);
+}
+
+// threads hashing for the first time at once must all end up with the same
+// seed, so only the one that wins the exchange draws it
+static void seed_slow(void) {
+  int expected=SEED_NONE;
+  if (atomic_compare_exchange_strong_explicit(&seed_state, &expected, SEED_BUSY, memory_order_acquire, memory_order_acquire)) {
+    set_seed(randomSeed());
+    atomic_store_explicit(&seed_state, SEED_SET, memory_order_release);
+    return;
+  }
+  while (atomic_load_explicit(&seed_state, memory_order_acquire)!=SEED_SET) {
+  }
+}
+
+static inline void ensure_seed(void) {
+  if (atomic_load_explicit(&seed_state, memory_order_acquire)!=SEED_SET) seed_slow();
+}
+
+uint64_t zynk_hash_get_seed(void) {
+  ensure_seed();
+  return raw_seed;
+}
+
+uint64_t zynk_hash64(const void *data, size_t len) {
+  ensure_seed();
+  const uint8_t *p=(const uint8_t *)data;
+  uint64_t seed=hash_seed;
+  uint64_t a, b;
+  if (len<=16) {
+    if (len>=4) {
+      a=(read32(p)<<32) | read32(p+((len>>3)<<2));
+      b=(read32(p+len-4)<<32) | read32(p+len-4-((len>>3)<<2));
+    } else if (len>0) {
+      a=read3(p, len);
+      b=0;
+    } else {
+      a=b=0;
+    }
+  } else {
+    size_t i=len;
+    if (i>=48) {
+      uint64_t see1=seed, see2=seed;
+      do {
+        seed=wymix(read64(p)^secret[1], read64(p+8)^seed);
+        see1=wymix(read64(p+16)^secret[2], read64(p+24)^see1);
+        see2=wymix(read64(p+32)^secret[3], read64(p+40)^see2);
+        p+=48;
+        i-=48;
+      } while (i>=48);
+      seed^=see1^see2;
+    }
+    while (i>16) {
+      seed=wymix(read64(p)^secret[1], read64(p+8)^seed);
+      i-=16;
+      p+=16;
+    }
+    a=read64(p+i-16);
+    b=read64(p+i-8);
+  }
+  a^=secret[1];
+  b^=seed;
+  wymum(&a, &b);
+  return wymix(a^secret[0]^len, b^secret[1]);
+}
+
+uint32_t zynk_hash_bytes(const char *data, uint32_t len) {
+  uint64_t hash=zynk_hash64(data, len);
+  return (uint32_t)(hash^(hash>>32));
+}
 
 uint32_t zynk_hash_string(const char *str) {
-  unsigned long hash=5381;
-  int c;
-  while ((c=*str++)) {
-    // original = (hash<<5)+hash+c
-    // second = ((hash<<5)+hash)^c
-    // third = ((hash<<5)+hash)^((c<<5)+c)
-    // forth = ((hash<<5)+hash)^((c<<6)+c)
-    // fifth (test) = ((hash<<5)+hash)^(c*c)
-    // another test =  ((hash << 5) + hash) ^ (c ^ (c << 8) ^ (c << 16) ^ (c << 24))
-    hash = ((hash << 5) + hash) ^ (c ^ (c << 8) ^ (c << 16) ^ (c << 24));
+  return zynk_hash_bytes(str, zynk_len(str, '\0'));
+}
+
+// numbers and pointers, keyed by the seed too
+static uint32_t mix64(uint64_t x) {
+  ensure_seed();
+  uint64_t hash=wymix(x^secret[0], hash_seed^secret[1]);
+  return (uint32_t)(hash^(hash>>32));
+}
+
+// must agree with the map's key equality: equal keys -> equal hashes.
+// Arrays are keys by identity, their buffer moves when they grow or unshare.
+uint32_t zynkValueHash(Value val) {
+  switch (val.type) {
+    case ZYNK_NULL: return 0;
+    case ZYNK_BOOL: return val.as.boolean ? 1 : 2;
+    case ZYNK_BYTE: return mix64(0x100 | val.as.byte);
+    case ZYNK_NUMBER: {
+      union { double number; uint64_t bits; } pun;
+      pun.number=val.as.number;
+      if (pun.number==0) pun.number=0; // -0.0 == 0.0
+      return mix64(pun.bits);
+    }
+    case ZYNK_OBJ: {
+      ZynkObj *obj=val.as.obj;
+      if (obj==NULL) return 0;
+      switch (obj->type) {
+        case ObjString: return zynk_hash_bytes(obj->obj.string->string, obj->obj.string->len);
+        default: return mix64((uint64_t)(uintptr_t)obj);
+      }
+    }
+    default: return 0;
   }
-  return hash;
 }
+
+#undef SEED_NONE
+#undef SEED_BUSY
+#undef SEED_SET
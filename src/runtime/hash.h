@@ -2,7 +2,20 @@
 #define ZYNK_HASH
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "types.h"
 
+// Every hash is keyed by a per-runtime seed. It is drawn at random on first
+// use, once even when several threads get there together, unless
+// zynk_hash_seed sets it before that; tables keep their hashes, so don't
+// change it once environments or maps exist.
+void zynk_hash_seed(uint64_t seed);
+uint64_t zynk_hash_get_seed(void);
+
+uint64_t zynk_hash64(const void *data, size_t len); // wyhash
+uint32_t zynk_hash_bytes(const char *data, uint32_t len);
 uint32_t zynk_hash_string(const char *str);
+uint32_t zynkValueHash(Value val);
 
 #endif
@@ -0,0 +1,518 @@
+// Code under LGPL
+#ifdef __unix__
+#define _DEFAULT_SOURCE // MAP_ANONYMOUS under -std=c11
+#endif
+
+#include "jit.h"
+
+#ifdef ZYNK_JIT_X64
+#include <sys/mman.h>
+#include <unistd.h>
+#include "vm.h"
+#include "memory.h"
+#include "../sysarena/sysarena.h"
+#include "value_inline.h"
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+#define GET_OP(ins) ((ins) & 0xFF)
+#define GET_A(ins) (((ins)>>8) & 0xFF)
+#define GET_B(ins) (((ins)>>16) & 0xFF)
+#define GET_C(ins) ((ins)>>24)
+#define GET_BX(ins) ((ins)>>16)
+#define GET_SBX(ins) ((int32_t)(int16_t)((ins)>>16))
+
+// x86-64 registers by number. rbx holds the VM registers and rbp the
+// ZynkJitFrame, both saved by the callee, the rest is scratch.
+#define RAX 0
+#define RCX 1
+#define RDX 2
+#define RBX 3
+#define RBP 5
+#define RSI 6
+#define RDI 7
+
+// conditions, added to 0x70 (rel8) or to 0x0F 0x80 (rel32)
+#define CC_ALWAYS (-1)
+#define CC_AE 0x3
+#define CC_E 0x4
+#define CC_NE 0x5
+
+#define TEMPLATE_MAX 256 // bytes of a template, the longest is about 160
+#define STUB_BYTES 32
+#define GUARDS_MAX 10 // jumps out of one template
+#define CODE_OFFSET 64 // the code starts after the header, on its own line
+#define MAX_CODE (1u<<20) // instructions, bigger functions stay on the VM
+
+#define SLOT_OF(r) ((int32_t)((r)*sizeof(Value)))
+#define TYPE_OF(r) (SLOT_OF(r)+(int32_t)offsetof(Value, type))
+#define DATA_OF(r) (SLOT_OF(r)+(int32_t)offsetof(Value, as))
+
+#define EMIT(e, ...) bytes(e, (const uint8_t[]){__VA_ARGS__}, sizeof((const uint8_t[]){__VA_ARGS__}))
+
+_Static_assert(sizeof(Value)==16, "the array templates index with a shift by 4");
+
+// at the start of the mapping, read-only like the code after it
+struct ZynkJitCode {
+  size_t size; // whole mapping
+  void (*entry)(ZynkJitFrame *frame, Value *regs);
+};
+
+typedef struct {
+  uint32_t pos; // rel32 to patch
+  uint32_t pc; // target instruction, or the one whose stub it is
+  bool stub;
+} Fixup;
+
+typedef struct {
+  uint8_t *buf;
+  uint32_t len, capacity;
+  Fixup *fixups;
+  uint32_t fixups_len, fixups_capacity;
+  uint32_t *labels; // code offset of each instruction
+  uint32_t *stubs; // code offset of its stub, NO_STUB or WANTED
+  uint32_t pc;
+  bool failed;
+} Emitter;
+
+#define NO_STUB UINT32_MAX
+#define WANTED (UINT32_MAX-1)
+
+// --- what the stubs call ---
+
+static void step(ZynkJitFrame *frame, uint32_t pc) {
+  zynk_vm_step(frame->manager, frame->env, frame->func, frame->regs, frame->func->code[pc]);
+}
+
+static bool truthy(const Value *val) {
+  return zynkValuesTrue(*val);
+}
+
+static void leave(ZynkJitFrame *frame, uint32_t a) {
+  frame->result=zynk_vm_leave(frame->manager, frame->func, frame->regs, (uint8_t)a);
+}
+
+// --- encoding ---
+
+static void byte(Emitter *e, uint8_t b) {
+  if (e->len>=e->capacity) {
+    e->failed=true;
+    return;
+  }
+  e->buf[e->len++]=b;
+}
+
+static void bytes(Emitter *e, const uint8_t *b, size_t n) {
+  for (size_t i=0;i<n;i++) byte(e, b[i]);
+}
+
+static void u32(Emitter *e, uint32_t v) {
+  for (int i=0;i<4;i++) byte(e, (uint8_t)(v>>(8*i)));
+}
+
+static void u64(Emitter *e, uint64_t v) {
+  for (int i=0;i<8;i++) byte(e, (uint8_t)(v>>(8*i)));
+}
+
+// ModRM for [base+disp32], reg is a register or the opcode extension
+static void mem(Emitter *e, uint8_t reg, uint8_t base, int32_t disp) {
+  byte(e, (uint8_t)(0x80 | (reg & 7)<<3 | (base & 7)));
+  u32(e, (uint32_t)disp);
+}
+
+// jmp or jcc rel32 to an instruction or to the stub of this one
+static void jump(Emitter *e, int cc, uint32_t pc, bool stub) {
+  if (cc==CC_ALWAYS) {
+    byte(e, 0xE9);
+  } else {
+    byte(e, 0x0F);
+    byte(e, (uint8_t)(0x80 | cc));
+  }
+  if (e->fixups_len>=e->fixups_capacity) {
+    e->failed=true;
+    return;
+  }
+  e->fixups[e->fixups_len++]=(Fixup){e->len, pc, stub};
+  if (stub) e->stubs[pc]=WANTED;
+  u32(e, 0);
+}
+
+static void bail(Emitter *e, int cc) {
+  jump(e, cc, e->pc, true);
+}
+
+// rel8 jumps inside a template, land() points them here
+static uint32_t short_jump(Emitter *e, int cc) {
+  byte(e, cc==CC_ALWAYS ? 0xEB : (uint8_t)(0x70 | cc));
+  byte(e, 0);
+  return e->len;
+}
+
+static void land(Emitter *e, uint32_t from) {
+  if (!e->failed) e->buf[from-1]=(uint8_t)(e->len-from);
+}
+
+static void call(Emitter *e, uint64_t fn) {
+  EMIT(e, 0x48, 0xB8); // mov rax, fn
+  u64(e, fn);
+  EMIT(e, 0xFF, 0xD0); // call rax
+}
+
+// --- templates ---
+
+// cmp dword [R[r].type], type and bail on cc
+static void guard_type(Emitter *e, uint8_t r, ZYNK_TYPE type, int cc) {
+  byte(e, 0x83);
+  mem(e, 7, RBX, TYPE_OF(r));
+  byte(e, (uint8_t)type);
+  bail(e, cc);
+}
+
+// writes can't drop a reference, the stub releases objects
+static void guard_no_obj(Emitter *e, uint8_t r) {
+  guard_type(e, r, ZYNK_OBJ, CC_E);
+}
+
+static void load_number(Emitter *e, uint8_t xmm, uint8_t r) {
+  EMIT(e, 0xF2, 0x0F, 0x10); // movsd xmm, [R[r]]
+  mem(e, xmm, RBX, DATA_OF(r));
+}
+
+static void store_number(Emitter *e, uint8_t r) {
+  byte(e, 0xC7); // mov dword [R[r].type], ZYNK_NUMBER
+  mem(e, 0, RBX, TYPE_OF(r));
+  u32(e, ZYNK_NUMBER);
+  EMIT(e, 0xF2, 0x0F, 0x11); // movsd [R[r]], xmm0
+  mem(e, 0, RBX, DATA_OF(r));
+}
+
+// eax holds 0 or 1
+static void store_bool(Emitter *e, uint8_t r) {
+  byte(e, 0xC7);
+  mem(e, 0, RBX, TYPE_OF(r));
+  u32(e, ZYNK_BOOL);
+  EMIT(e, 0x48, 0x89); // mov [R[r]], rax
+  mem(e, RAX, RBX, DATA_OF(r));
+}
+
+static void store_imm(Emitter *e, uint8_t r, ZYNK_TYPE type, uint64_t data) {
+  byte(e, 0xC7);
+  mem(e, 0, RBX, TYPE_OF(r));
+  u32(e, type);
+  EMIT(e, 0x48, 0xB8);
+  u64(e, data);
+  EMIT(e, 0x48, 0x89);
+  mem(e, RAX, RBX, DATA_OF(r));
+}
+
+static void copy_value(Emitter *e, uint8_t to_base, int32_t to, uint8_t from_base, int32_t from) {
+  EMIT(e, 0x0F, 0x10); // movups xmm0, [from]
+  mem(e, 0, from_base, from);
+  EMIT(e, 0x0F, 0x11); // movups [to], xmm0
+  mem(e, 0, to_base, to);
+}
+
+// the instruction as the VM runs it
+static void generic(Emitter *e) {
+  EMIT(e, 0x48, 0x89, 0xEF); // mov rdi, rbp
+  byte(e, 0xBE); // mov esi, pc
+  u32(e, e->pc);
+  call(e, (uint64_t)(uintptr_t)&step);
+}
+
+static void arith(Emitter *e, uint32_t ins) {
+  uint8_t a=GET_A(ins), b=GET_B(ins), c=GET_C(ins);
+  guard_type(e, b, ZYNK_NUMBER, CC_NE);
+  guard_type(e, c, ZYNK_NUMBER, CC_NE);
+  guard_no_obj(e, a);
+  load_number(e, 0, b);
+  switch (GET_OP(ins)) {
+    case ZYNK_OP_ADD: EMIT(e, 0xF2, 0x0F, 0x58); mem(e, 0, RBX, DATA_OF(c)); break;
+    case ZYNK_OP_SUB: EMIT(e, 0xF2, 0x0F, 0x5C); mem(e, 0, RBX, DATA_OF(c)); break;
+    case ZYNK_OP_MUL: EMIT(e, 0xF2, 0x0F, 0x59); mem(e, 0, RBX, DATA_OF(c)); break;
+    default:
+      // a zero on either side gives null, the stub sees to it
+      load_number(e, 1, c);
+      EMIT(e, 0x66, 0x0F, 0x57, 0xD2); // xorpd xmm2, xmm2
+      EMIT(e, 0x66, 0x0F, 0x2E, 0xC2); // ucomisd xmm0, xmm2
+      bail(e, CC_E);
+      EMIT(e, 0x66, 0x0F, 0x2E, 0xCA); // ucomisd xmm1, xmm2
+      bail(e, CC_E);
+      EMIT(e, 0xF2, 0x0F, 0x5E, 0xC1); // divsd xmm0, xmm1
+      break;
+  }
+  store_number(e, a);
+}
+
+// unordered (NaN) leaves CF or PF set, which makes all three false
+static void compare(Emitter *e, uint32_t ins) {
+  uint8_t a=GET_A(ins), b=GET_B(ins), c=GET_C(ins);
+  guard_type(e, b, ZYNK_NUMBER, CC_NE);
+  guard_type(e, c, ZYNK_NUMBER, CC_NE);
+  guard_no_obj(e, a);
+  if (GET_OP(ins)==ZYNK_OP_EQ) {
+    load_number(e, 0, b);
+    EMIT(e, 0x66, 0x0F, 0x2E); // ucomisd xmm0, [R[c]]
+    mem(e, 0, RBX, DATA_OF(c));
+    EMIT(e, 0x0F, 0x94, 0xC0); // sete al
+    EMIT(e, 0x0F, 0x9B, 0xC1); // setnp cl
+    EMIT(e, 0x20, 0xC8); // and al, cl
+  } else {
+    // b<c as c>b, b<=c as c>=b
+    load_number(e, 0, c);
+    EMIT(e, 0x66, 0x0F, 0x2E);
+    mem(e, 0, RBX, DATA_OF(b));
+    EMIT(e, 0x0F, GET_OP(ins)==ZYNK_OP_LT ? 0x97 : 0x93, 0xC0); // seta/setae al
+  }
+  EMIT(e, 0x0F, 0xB6, 0xC0); // movzx eax, al
+  store_bool(e, a);
+}
+
+// rax = the ZynkArray in R[r], checked to be an array
+static void array_of(Emitter *e, uint8_t r) {
+  guard_type(e, r, ZYNK_OBJ, CC_NE);
+  EMIT(e, 0x48, 0x8B); // mov rax, [R[r]]
+  mem(e, RAX, RBX, DATA_OF(r));
+  EMIT(e, 0x48, 0x85, 0xC0); // test rax, rax
+  bail(e, CC_E);
+  byte(e, 0x83); // cmp dword [rax+type], ObjArray
+  mem(e, 7, RAX, (int32_t)offsetof(ZynkObj, type));
+  byte(e, ObjArray);
+  bail(e, CC_NE);
+  EMIT(e, 0x48, 0x8B); // mov rax, [rax+obj]
+  mem(e, RAX, RAX, (int32_t)offsetof(ZynkObj, obj));
+}
+
+// rax = &array[R[r]] for an index inside the array, holding no object.
+// The VM wraps the other indexes around, the stub does the same.
+static void element_of(Emitter *e, uint8_t r) {
+  guard_type(e, r, ZYNK_NUMBER, CC_NE);
+  EMIT(e, 0xF2, 0x48, 0x0F, 0x2C); // cvttsd2si rdx, [R[r]]
+  mem(e, RDX, RBX, DATA_OF(r));
+  byte(e, 0x8B); // mov ecx, [rax+len]
+  mem(e, RCX, RAX, (int32_t)offsetof(ZynkArray, len));
+  EMIT(e, 0x48, 0x39, 0xCA); // cmp rdx, rcx
+  bail(e, CC_AE);
+  EMIT(e, 0x48, 0x8B); // mov rax, [rax+array]
+  mem(e, RAX, RAX, (int32_t)offsetof(ZynkArray, array));
+  EMIT(e, 0x48, 0xC1, 0xE2, 0x04); // shl rdx, 4
+  EMIT(e, 0x48, 0x01, 0xD0); // add rax, rdx
+  byte(e, 0x83);
+  mem(e, 7, RAX, (int32_t)offsetof(Value, type));
+  byte(e, ZYNK_OBJ);
+  bail(e, CC_E);
+}
+
+static void get_index(Emitter *e, uint32_t ins) {
+  uint8_t a=GET_A(ins);
+  guard_no_obj(e, a);
+  array_of(e, GET_B(ins));
+  element_of(e, GET_C(ins));
+  copy_value(e, RBX, SLOT_OF(a), RAX, 0);
+}
+
+static void set_index(Emitter *e, uint32_t ins) {
+  uint8_t c=GET_C(ins);
+  guard_no_obj(e, c);
+  array_of(e, GET_A(ins));
+  EMIT(e, 0x48, 0x83); // cmp qword [rax+shared], 0, shared arrays are copied first
+  mem(e, 7, RAX, (int32_t)offsetof(ZynkArray, shared));
+  byte(e, 0);
+  bail(e, CC_NE);
+  element_of(e, GET_B(ins));
+  copy_value(e, RAX, 0, RBX, SLOT_OF(c));
+}
+
+static void branch(Emitter *e, uint32_t ins, uint32_t target) {
+  uint8_t a=GET_A(ins);
+  byte(e, 0x83); // bools are tested here, the rest by zynkValuesTrue
+  mem(e, 7, RBX, TYPE_OF(a));
+  byte(e, ZYNK_BOOL);
+  uint32_t other=short_jump(e, CC_NE);
+  byte(e, 0x80); // cmp byte [R[a]], 0
+  mem(e, 7, RBX, DATA_OF(a));
+  byte(e, 0);
+  uint32_t done=short_jump(e, CC_ALWAYS);
+  land(e, other);
+  EMIT(e, 0x48, 0x8D); // lea rdi, [R[a]]
+  mem(e, RDI, RBX, SLOT_OF(a));
+  call(e, (uint64_t)(uintptr_t)&truthy);
+  EMIT(e, 0x84, 0xC0); // test al, al
+  land(e, done);
+  jump(e, GET_OP(ins)==ZYNK_OP_JMPIF ? CC_NE : CC_E, target, false);
+}
+
+static void instruction(Emitter *e, const ZynkFunction *func, uint32_t ins) {
+  uint8_t a=GET_A(ins);
+  switch (GET_OP(ins)) {
+    case ZYNK_OP_MOVE:
+      guard_type(e, GET_B(ins), ZYNK_OBJ, CC_E);
+      guard_no_obj(e, a);
+      copy_value(e, RBX, SLOT_OF(a), RBX, SLOT_OF(GET_B(ins)));
+      break;
+    case ZYNK_OP_LOADK: {
+      Value k=func->constants[GET_BX(ins)];
+      if (k.type==ZYNK_OBJ) {
+        generic(e);
+        break;
+      }
+      uint64_t data;
+      zynk_cpy((uint8_t *)&data, (const uint8_t *)&k.as, sizeof(data));
+      guard_no_obj(e, a);
+      store_imm(e, a, k.type, data);
+      break;
+    }
+    case ZYNK_OP_LOADNULL:
+      guard_no_obj(e, a);
+      store_imm(e, a, ZYNK_NULL, 0);
+      break;
+    case ZYNK_OP_LOADBOOL:
+      guard_no_obj(e, a);
+      store_imm(e, a, ZYNK_BOOL, GET_B(ins)!=0);
+      break;
+    case ZYNK_OP_ADD:
+    case ZYNK_OP_SUB:
+    case ZYNK_OP_MUL:
+    case ZYNK_OP_DIV:
+      arith(e, ins);
+      break;
+    case ZYNK_OP_EQ:
+    case ZYNK_OP_LT:
+    case ZYNK_OP_LE:
+      compare(e, ins);
+      break;
+    case ZYNK_OP_NOT:
+      guard_type(e, GET_B(ins), ZYNK_BOOL, CC_NE);
+      guard_no_obj(e, a);
+      EMIT(e, 0x0F, 0xB6); // movzx eax, byte [R[b]]
+      mem(e, RAX, RBX, DATA_OF(GET_B(ins)));
+      EMIT(e, 0x83, 0xF0, 0x01); // xor eax, 1
+      store_bool(e, a);
+      break;
+    case ZYNK_OP_JMP:
+      jump(e, CC_ALWAYS, (uint32_t)((int64_t)e->pc+1+GET_SBX(ins)), false);
+      break;
+    case ZYNK_OP_JMPIF:
+    case ZYNK_OP_JMPIFNOT:
+      branch(e, ins, (uint32_t)((int64_t)e->pc+1+GET_SBX(ins)));
+      break;
+    case ZYNK_OP_GETINDEX: get_index(e, ins); break;
+    case ZYNK_OP_SETINDEX: set_index(e, ins); break;
+    case ZYNK_OP_RETURN:
+      EMIT(e, 0x48, 0x89, 0xEF); // mov rdi, rbp
+      byte(e, 0xBE); // mov esi, a
+      u32(e, a);
+      call(e, (uint64_t)(uintptr_t)&leave);
+      EMIT(e, 0x48, 0x83, 0xC4, 0x08); // add rsp, 8
+      EMIT(e, 0x5B, 0x5D, 0xC3); // pop rbx, pop rbp, ret
+      break;
+    default: generic(e); break; // globals and calls
+  }
+}
+
+ZynkJitCode *zynk_jit_compile(ArenaManager *manager, ZynkFunction *func) {
+  if (manager==NULL || func==NULL || func->code_len==0 || func->code_len>MAX_CODE) {
+    return NULL;
+  }
+  uint32_t n=func->code_len;
+  Emitter e;
+  e.capacity=n*(TEMPLATE_MAX+STUB_BYTES)+64;
+  e.fixups_capacity=n*GUARDS_MAX;
+  uint8_t *scratch=(uint8_t *)sysarena_alloc(manager, sizeof(Fixup)*e.fixups_capacity+sizeof(uint32_t)*2*n+e.capacity);
+  if (scratch==NULL) {
+    return NULL;
+  }
+  e.fixups=(Fixup *)scratch;
+  e.labels=(uint32_t *)(scratch+sizeof(Fixup)*e.fixups_capacity);
+  e.stubs=e.labels+n;
+  e.buf=(uint8_t *)(e.stubs+n);
+  e.len=0;
+  e.fixups_len=0;
+  e.failed=false;
+  for (uint32_t pc=0;pc<n;pc++) e.stubs[pc]=NO_STUB;
+
+  EMIT(&e, 0x55, 0x53); // push rbp, push rbx
+  EMIT(&e, 0x48, 0x83, 0xEC, 0x08); // sub rsp, 8, calls want rsp 16 byte aligned
+  EMIT(&e, 0x48, 0x89, 0xFD); // mov rbp, rdi
+  EMIT(&e, 0x48, 0x89, 0xF3); // mov rbx, rsi
+  for (e.pc=0;e.pc<n;e.pc++) {
+    e.labels[e.pc]=e.len;
+    instruction(&e, func, func->code[e.pc]);
+  }
+  // cold stubs after the code, the last instruction never falls through
+  for (e.pc=0;e.pc<n;e.pc++) {
+    if (e.stubs[e.pc]==NO_STUB) continue;
+    e.stubs[e.pc]=e.len;
+    generic(&e);
+    jump(&e, CC_ALWAYS, e.pc+1, false);
+  }
+  for (uint32_t i=0;i<e.fixups_len && !e.failed;i++) {
+    Fixup f=e.fixups[i];
+    uint32_t target=f.stub ? e.stubs[f.pc] : e.labels[f.pc];
+    uint32_t rel=target-(f.pos+4);
+    for (int b=0;b<4;b++) e.buf[f.pos+b]=(uint8_t)(rel>>(8*b));
+  }
+
+  ZynkJitCode *code=NULL;
+  if (!e.failed) {
+    // written while only writable, run once only executable (W^X)
+    size_t page=(size_t)sysconf(_SC_PAGESIZE);
+    size_t size=(CODE_OFFSET+e.len+page-1)/page*page;
+    uint8_t *pages=mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pages!=MAP_FAILED) {
+      code=(ZynkJitCode *)pages;
+      code->size=size;
+      code->entry=(void (*)(ZynkJitFrame *, Value *))(uintptr_t)(pages+CODE_OFFSET);
+      zynk_cpy(pages+CODE_OFFSET, e.buf, e.len);
+      if (mprotect(pages, size, PROT_READ | PROT_EXEC)!=0) {
+        munmap(pages, size);
+        code=NULL;
+      }
+    }
+  }
+  sysarena_free(manager, scratch);
+  return code;
+}
+
+Value zynk_jit_run(ArenaManager *manager, ZynkEnv *env, ZynkFunction *func, Value *regs) {
+  ZynkJitFrame frame={manager, env, func, regs, zynkNull()};
+  func->jit->entry(&frame, regs);
+  return frame.result;
+}
+
+void zynk_jit_free(ZynkJitCode *code) {
+  if (code!=NULL) munmap(code, code->size);
+}
+
+#undef GET_OP
+#undef GET_A
+#undef GET_B
+#undef GET_C
+#undef GET_BX
+#undef GET_SBX
+#undef RAX
+#undef RCX
+#undef RDX
+#undef RBX
+#undef RBP
+#undef RSI
+#undef RDI
+#undef CC_ALWAYS
+#undef CC_AE
+#undef CC_E
+#undef CC_NE
+#undef TEMPLATE_MAX
+#undef STUB_BYTES
+#undef GUARDS_MAX
+#undef CODE_OFFSET
+#undef MAX_CODE
+#undef SLOT_OF
+#undef TYPE_OF
+#undef DATA_OF
+#undef EMIT
+#undef NO_STUB
+#undef WANTED
+
+#endif // ZYNK_JIT_X64
@@ -0,0 +1,44 @@
+#ifndef ZYNK_JIT_H
+#define ZYNK_JIT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../common.h"
+#include "types.h"
+#include "objects.h"
+
+// Baseline compiler for ObjFunction on x86-64. Every instruction becomes a
+// fixed template working on the same registers the VM uses (rbx points to
+// them), so no state has to be moved when a template gives up. Arithmetic,
+// comparisons, NOT, the loads, MOVE and array reads and writes have a fast
+// path for numbers, bools and arrays, behind type guards. A guard that fails
+// jumps to a cold stub that runs that one instruction with zynk_vm_step and
+// comes back to the next one. Globals and calls always go through the stub.
+// Branches test bools inline and ask zynkValuesTrue about anything else.
+//
+// The code is written to a scratch buffer, then copied to its own mmap'd
+// pages, which are made executable only after they stop being writable.
+// The function owns them and unmaps them when it is freed.
+#if defined(ZYNK_JIT) && defined(ZYNK_POSIX) && defined(__x86_64__) && defined(__GNUC__) && !defined(_WIN32)
+#define ZYNK_JIT_X64
+#endif
+
+// what the native code and its stubs share with the VM
+typedef struct ZynkJitFrame {
+  ArenaManager *manager;
+  ZynkEnv *env;
+  ZynkFunction *func;
+  Value *regs;
+  Value result; // set by RETURN
+} ZynkJitFrame;
+
+#ifdef ZYNK_JIT_X64
+// NULL when out of memory or if the pages can't be mapped
+ZynkJitCode *zynk_jit_compile(ArenaManager *manager, ZynkFunction *func);
+// same contract as the VM loop: takes the registers, releases them on return
+Value zynk_jit_run(ArenaManager *manager, ZynkEnv *env, ZynkFunction *func, Value *regs);
+void zynk_jit_free(ZynkJitCode *code);
+#endif
+
+#endif
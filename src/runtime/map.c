@@ -0,0 +1,208 @@
+// Code under LGPL
+#include "map.h"
+#include "hash.h"
+#include "memory.h"
+#include "assign.h"
+#include "../sysarena/sysarena.h"
+#include "value_inline.h"
+
+#define IS_MAP(val) (val.type==ZYNK_OBJ && val.as.obj!=NULL && val.as.obj->type==ObjMap)
+#define AS_MAP(val) (val.as.obj->obj.map)
+
+#define MAP_EMPTY 0
+#define MAP_MIN_CAPACITY 8
+
+static uint32_t deletedMark(uint8_t width) {
+  switch (width) {
+    case 1: return UINT8_MAX;
+    case 2: return UINT16_MAX;
+    default: return UINT32_MAX;
+  }
+}
+
+static uint32_t indexGet(ZynkMap *map, uint32_t slot) {
+  switch (map->index_width) {
+    case 1: return ((uint8_t *)map->index)[slot];
+    case 2: return ((uint16_t *)map->index)[slot];
+    default: return ((uint32_t *)map->index)[slot];
+  }
+}
+
+static void indexPut(ZynkMap *map, uint32_t slot, uint32_t pos) {
+  switch (map->index_width) {
+    case 1: ((uint8_t *)map->index)[slot]=(uint8_t)pos; break;
+    case 2: ((uint16_t *)map->index)[slot]=(uint16_t)pos; break;
+    default: ((uint32_t *)map->index)[slot]=pos; break;
+  }
+}
+
+// zynkValuesEqual, but an array key is only equal to the same array object
+static bool keysEqual(Value a, Value b) {
+  if (a.type==ZYNK_OBJ && b.type==ZYNK_OBJ && a.as.obj!=NULL && a.as.obj->type==ObjArray) {
+    return a.as.obj==b.as.obj;
+  }
+  return zynkValuesEqual(a, b);
+}
+
+// returns the index slot holding key, or the slot where it should go
+static uint32_t mapProbe(ZynkMap *map, Value key, uint32_t hash, bool *found) {
+  uint32_t mask=map->index_cap-1;
+  uint32_t deleted=deletedMark(map->index_width);
+  uint32_t slot=hash & mask;
+  uint32_t first_free=UINT32_MAX;
+  for (;;) {
+    uint32_t pos=indexGet(map, slot);
+    if (pos==MAP_EMPTY) {
+      *found=false;
+      return (first_free!=UINT32_MAX) ? first_free : slot;
+    }
+    if (pos==deleted) {
+      if (first_free==UINT32_MAX) first_free=slot;
+    } else {
+      ZynkMapEntry *entry=&map->entries[pos-1];
+      if (entry->hash==hash && keysEqual(entry->key, key)) {
+        *found=true;
+        return slot;
+      }
+    }
+    slot=(slot+1) & mask;
+  }
+}
+
+bool zynkMapReserve(ArenaManager *manager, ZynkMap *map, uint32_t capacity) {
+  if (manager==NULL || map==NULL) return false;
+  if (capacity<MAP_MIN_CAPACITY) capacity=MAP_MIN_CAPACITY;
+  if (capacity<map->len) capacity=map->len;
+
+  uint32_t index_cap=MAP_MIN_CAPACITY;
+  while (index_cap < capacity+capacity/2+1) index_cap<<=1;
+  uint8_t width=4;
+  if (capacity < UINT8_MAX-1) width=1;
+  else if (capacity < UINT16_MAX-1) width=2;
+
+  ZynkMapEntry *entries=(ZynkMapEntry *)sysarena_alloc(manager, sizeof(ZynkMapEntry)*capacity);
+  if (entries==NULL) return false;
+  uint8_t *index=(uint8_t *)sysarena_alloc(manager, (size_t)index_cap*width);
+  if (index==NULL) {
+    sysarena_free(manager, entries);
+    return false;
+  }
+  for (size_t i=0;i<(size_t)index_cap*width;i++) index[i]=MAP_EMPTY;
+
+  ZynkMapEntry *old_entries=map->entries;
+  void *old_index=map->index;
+  uint32_t old_used=map->used;
+
+  map->entries=entries;
+  map->index=index;
+  map->index_cap=index_cap;
+  map->index_width=width;
+  map->capacity=capacity;
+  map->used=0;
+
+  // compact live entries keeping insertion order
+  for (uint32_t i=0;i<old_used;i++) {
+    if (!old_entries[i].used) continue;
+    bool found;
+    uint32_t slot=mapProbe(map, old_entries[i].key, old_entries[i].hash, &found);
+    map->entries[map->used]=old_entries[i];
+    indexPut(map, slot, ++map->used);
+  }
+
+  if (old_entries!=NULL) sysarena_free(manager, old_entries);
+  if (old_index!=NULL) sysarena_free(manager, old_index);
+  return true;
+}
+
+Value zynkMapGet(Value map_val, Value key) {
+  if (!IS_MAP(map_val)) return zynkNull();
+  ZynkMap *map=AS_MAP(map_val);
+  if (map->len==0) return zynkNull();
+  bool found;
+  uint32_t slot=mapProbe(map, key, zynkValueHash(key), &found);
+  if (!found) return zynkNull();
+  return map->entries[indexGet(map, slot)-1].value;
+}
+
+bool zynkMapHas(Value map_val, Value key) {
+  if (!IS_MAP(map_val)) return false;
+  ZynkMap *map=AS_MAP(map_val);
+  if (map->len==0) return false;
+  bool found;
+  mapProbe(map, key, zynkValueHash(key), &found);
+  return found;
+}
+
+bool zynkMapSet(ArenaManager *manager, Value map_val, Value key, Value value) {
+  if (!IS_MAP(map_val)) return false;
+  ZynkMap *map=AS_MAP(map_val);
+  uint32_t hash=zynkValueHash(key);
+  bool found;
+  uint32_t slot=mapProbe(map, key, hash, &found);
+  if (found) {
+    ZynkMapEntry *entry=&map->entries[indexGet(map, slot)-1];
+    zynk_retain(value);
+    zynk_release(entry->value, manager);
+    entry->value=value;
+    return true;
+  }
+  if (map->used==map->capacity) {
+    // grows if it is really full, otherwise it only drops the deleted entries
+    if (!zynkMapReserve(manager, map, (map->len+1)*2)) return false;
+    slot=mapProbe(map, key, hash, &found);
+  }
+  ZynkMapEntry *entry=&map->entries[map->used];
+  entry->key=zynk_retain(key);
+  entry->value=zynk_retain(value);
+  entry->hash=hash;
+  entry->used=true;
+  indexPut(map, slot, ++map->used);
+  map->len++;
+  return true;
+}
+
+bool zynkMapDelete(ArenaManager *manager, Value map_val, Value key) {
+  if (!IS_MAP(map_val)) return false;
+  ZynkMap *map=AS_MAP(map_val);
+  if (map->len==0) return false;
+  bool found;
+  uint32_t slot=mapProbe(map, key, zynkValueHash(key), &found);
+  if (!found) return false;
+  ZynkMapEntry *entry=&map->entries[indexGet(map, slot)-1];
+  indexPut(map, slot, deletedMark(map->index_width));
+  zynk_release(entry->key, manager);
+  zynk_release(entry->value, manager);
+  entry->key=zynkNull();
+  entry->value=zynkNull();
+  entry->used=false;
+  map->len--;
+  return true;
+}
+
+Value zynkMapKeys(ArenaManager *manager, Value map_val) {
+  if (!IS_MAP(map_val)) return zynkNull();
+  ZynkMap *map=AS_MAP(map_val);
+  Value keys=zynkCreateArray(manager, map->len);
+  if (keys.type==ZYNK_NULL) return keys;
+  for (uint32_t i=0;i<map->used;i++) {
+    if (map->entries[i].used) zynkArrayPush(manager, keys, map->entries[i].key);
+  }
+  return keys;
+}
+
+// walks the entries in insertion order, *cursor starts at 0
+bool zynkMapNext(Value map_val, uint32_t *cursor, Value *key, Value *value) {
+  if (!IS_MAP(map_val) || cursor==NULL) return false;
+  ZynkMap *map=AS_MAP(map_val);
+  while (*cursor < map->used) {
+    ZynkMapEntry *entry=&map->entries[(*cursor)++];
+    if (!entry->used) continue;
+    if (key!=NULL) *key=entry->key;
+    if (value!=NULL) *value=entry->value;
+    return true;
+  }
+  return false;
+}
+
+#undef IS_MAP
+#undef AS_MAP
@@ -0,0 +1,21 @@
+#ifndef ZYNK_MAP
+#define ZYNK_MAP
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../common.h"
+#include "types.h"
+#include "objects.h"
+#include "object_mng.h"
+#include "object_rf.h"
+
+bool zynkMapReserve(ArenaManager *manager, ZynkMap *map, uint32_t capacity);
+Value zynkMapGet(Value map_val, Value key);
+bool zynkMapSet(ArenaManager *manager, Value map_val, Value key, Value value);
+bool zynkMapDelete(ArenaManager *manager, Value map_val, Value key);
+bool zynkMapHas(Value map_val, Value key);
+Value zynkMapKeys(ArenaManager *manager, Value map_val);
+bool zynkMapNext(Value map_val, uint32_t *cursor, Value *key, Value *value);
+
+#endif
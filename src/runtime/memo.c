@@ -0,0 +1,313 @@
+// Code under LGPL
+#include "memo.h"
+#include "hash.h"
+#include "memory.h"
+#include "assign.h"
+#include "object_mng.h"
+#include "object_rf.h"
+#include "../sysarena/sysarena.h"
+#include "value_inline.h"
+
+#define IS_NATIVE(val) (val.type==ZYNK_OBJ && val.as.obj!=NULL && val.as.obj->type==ObjNativeFunction)
+#define IS_ARRAY(val) (val.type==ZYNK_OBJ && val.as.obj!=NULL && val.as.obj->type==ObjArray)
+
+static uint32_t hashValue(Value val, int depth) {
+  if (!IS_ARRAY(val) || depth>=ZYNK_MEMO_MAX_DEPTH) return zynkValueHash(val);
+  ZynkArray *array=val.as.obj->obj.array;
+  uint32_t hash=2166136261u^array->len;
+  for (uint32_t i=0;i<array->len;i++) {
+    hash=(hash^hashValue(array->array[i], depth+1))*16777619u;
+  }
+  return hash;
+}
+
+static uint32_t hashArgs(ZynkArray *args) {
+  uint32_t hash=2166136261u^args->len;
+  for (uint32_t i=0;i<args->len;i++) {
+    hash=(hash^hashValue(args->array[i], 1))*16777619u;
+  }
+  return hash;
+}
+
+// numbers must match bit for bit: a pure function may tell -0 from 0
+static bool equalValue(Value a, Value b, int depth) {
+  if (a.type==ZYNK_NUMBER && b.type==ZYNK_NUMBER) {
+    union { double number; uint64_t bits; } x, y;
+    x.number=a.as.number;
+    y.number=b.as.number;
+    return x.bits==y.bits;
+  }
+  if (!IS_ARRAY(a) || !IS_ARRAY(b) || depth>=ZYNK_MEMO_MAX_DEPTH) return zynkValuesEqual(a, b);
+  ZynkArray *arr_a=a.as.obj->obj.array, *arr_b=b.as.obj->obj.array;
+  if (arr_a->len!=arr_b->len) return false;
+  for (uint32_t i=0;i<arr_a->len;i++) {
+    if (!equalValue(arr_a->array[i], arr_b->array[i], depth+1)) return false;
+  }
+  return true;
+}
+
+static bool equalArgs(Value key, ZynkArray *args) {
+  ZynkArray *stored=key.as.obj->obj.array;
+  if (stored->len!=args->len) return false;
+  for (uint32_t i=0;i<args->len;i++) {
+    if (!equalValue(stored->array[i], args->array[i], 1)) return false;
+  }
+  return true;
+}
+
+// Maps and buffers change in place and are keyed by identity, so calls
+// that pass or return one (even inside an array) aren't cached. Arrays
+// nested deeper than ZYNK_MEMO_MAX_DEPTH aren't either.
+static bool cacheable(Value val, int depth) {
+  if (val.type!=ZYNK_OBJ || val.as.obj==NULL) return true;
+  switch (val.as.obj->type) {
+    case ObjString:
+    case ObjNativeFunction:
+    case ObjFunction:
+      return true;
+    case ObjArray: {
+      if (depth>=ZYNK_MEMO_MAX_DEPTH) return false;
+      ZynkArray *array=val.as.obj->obj.array;
+      for (uint32_t i=0;i<array->len;i++) {
+        if (!cacheable(array->array[i], depth+1)) return false;
+      }
+      return true;
+    }
+    default: return false;
+  }
+}
+
+static bool cacheableArgs(ZynkArray *args) {
+  for (uint32_t i=0;i<args->len;i++) {
+    if (!cacheable(args->array[i], 1)) return false;
+  }
+  return true;
+}
+
+// Deep copy of a cacheable value. Strings are copied, arrays holding only
+// numbers, bools and functions are copied in O(1) (copy-on-write), the
+// others are rebuilt so what they hold gets copied too.
+static bool snapshot(ArenaManager *manager, Value val, Value *out) {
+  if (val.type==ZYNK_OBJ && val.as.obj!=NULL && val.as.obj->type==ObjString) {
+    ZynkString *string=val.as.obj->obj.string;
+    *out=zynkCreateStringLen(manager, string->string, string->len);
+    if (out->type!=ZYNK_NULL) out->as.obj->obj.string->kind=string->kind;
+    return out->type!=ZYNK_NULL;
+  }
+  if (!IS_ARRAY(val)) {
+    *out=zynk_retain(val);
+    return true;
+  }
+  ZynkArray *array=val.as.obj->obj.array;
+  bool deep=false;
+  for (uint32_t i=0;i<array->len && !deep;i++) {
+    Value item=array->array[i];
+    deep=item.type==ZYNK_OBJ && item.as.obj!=NULL && (item.as.obj->type==ObjArray || item.as.obj->type==ObjString);
+  }
+  if (!deep) {
+    *out=zynkArrayCopy(manager, val);
+    return out->type!=ZYNK_NULL;
+  }
+
+  Value copy=zynkCreateArray(manager, array->len);
+  if (copy.type==ZYNK_NULL) return false;
+  ZynkArray *copy_array=copy.as.obj->obj.array;
+  for (uint32_t i=0;i<array->len;i++) {
+    if (!snapshot(manager, array->array[i], &copy_array->array[i])) {
+      zynk_release(copy, manager);
+      return false;
+    }
+    copy_array->len++;
+  }
+  *out=copy;
+  return true;
+}
+
+static void unlinkLru(ZynkMemo *memo, int32_t index) {
+  ZynkMemoEntry *entry=&memo->entries[index];
+  if (entry->prev>=0) memo->entries[entry->prev].next=entry->next;
+  else memo->head=entry->next;
+  if (entry->next>=0) memo->entries[entry->next].prev=entry->prev;
+  else memo->tail=entry->prev;
+}
+
+static void pushFront(ZynkMemo *memo, int32_t index) {
+  ZynkMemoEntry *entry=&memo->entries[index];
+  entry->prev=-1;
+  entry->next=memo->head;
+  if (memo->head>=0) memo->entries[memo->head].prev=index;
+  memo->head=index;
+  if (memo->tail<0) memo->tail=index;
+}
+
+static int32_t lookup(ZynkMemo *memo, ZynkArray *args, uint32_t hash) {
+  int32_t index=memo->buckets[hash & memo->bucket_mask];
+  while (index>=0) {
+    ZynkMemoEntry *entry=&memo->entries[index];
+    if (entry->hash==hash && equalArgs(entry->args, args)) return index;
+    index=entry->chain;
+  }
+  return -1;
+}
+
+// drops the least recently used entry and returns its slot
+static int32_t evict(ArenaManager *manager, ZynkMemo *memo) {
+  int32_t index=memo->tail;
+  ZynkMemoEntry *entry=&memo->entries[index];
+
+  int32_t *link=&memo->buckets[entry->hash & memo->bucket_mask];
+  while (*link!=index) link=&memo->entries[*link].chain;
+  *link=entry->chain;
+  unlinkLru(memo, index);
+
+  zynk_release(entry->args, manager);
+  zynk_release(entry->result, manager);
+  memo->len--;
+  memo->stats.evictions++;
+  return index;
+}
+
+static void store(ArenaManager *manager, ZynkMemo *memo, ZynkArray *args, uint32_t hash, Value result) {
+  Value key=zynkCreateArray(manager, args->len);
+  if (key.type==ZYNK_NULL) return;
+  ZynkArray *key_array=key.as.obj->obj.array;
+  for (uint32_t i=0;i<args->len;i++) {
+    if (!snapshot(manager, args->array[i], &key_array->array[i])) {
+      zynk_release(key, manager);
+      return;
+    }
+    key_array->len++;
+  }
+
+  Value cached;
+  if (!snapshot(manager, result, &cached)) {
+    zynk_release(key, manager);
+    return;
+  }
+
+  int32_t index=(memo->len<memo->capacity) ? (int32_t)memo->len : evict(manager, memo);
+  ZynkMemoEntry *entry=&memo->entries[index];
+  entry->args=key;
+  entry->result=cached;
+  entry->hash=hash;
+  entry->chain=memo->buckets[hash & memo->bucket_mask];
+  memo->buckets[hash & memo->bucket_mask]=index;
+  pushFront(memo, index);
+  memo->len++;
+}
+
+static void clearEntries(ArenaManager *manager, ZynkMemo *memo) {
+  for (int32_t index=memo->head;index>=0;index=memo->entries[index].next) {
+    zynk_release(memo->entries[index].args, manager);
+    zynk_release(memo->entries[index].result, manager);
+  }
+  for (uint32_t i=0;i<=memo->bucket_mask;i++) memo->buckets[i]=-1;
+  memo->len=0;
+  memo->head=-1;
+  memo->tail=-1;
+}
+
+bool zynkMemoEnable(ArenaManager *manager, Value func_val, uint32_t capacity) {
+  if (manager==NULL || !IS_NATIVE(func_val)) return false;
+  ZynkNativeFunction *func=func_val.as.obj->obj.native_func;
+  if (capacity==0) capacity=ZYNK_MEMO_CAPACITY;
+  if (capacity>(1u<<30)) return false;
+  if (func->memo!=NULL && !zynkMemoDisable(manager, func_val)) return false;
+
+  uint32_t buckets=1;
+  while (buckets<capacity*2) buckets<<=1;
+
+  ZynkMemo *memo=(ZynkMemo *)sysarena_alloc(manager, sizeof(ZynkMemo));
+  if (memo==NULL) return false;
+  memo->entries=(ZynkMemoEntry *)sysarena_alloc(manager, sizeof(ZynkMemoEntry)*capacity);
+  memo->buckets=(int32_t *)sysarena_alloc(manager, sizeof(int32_t)*buckets);
+  if (memo->entries==NULL || memo->buckets==NULL) {
+    if (memo->entries!=NULL) sysarena_free(manager, memo->entries);
+    if (memo->buckets!=NULL) sysarena_free(manager, memo->buckets);
+    sysarena_free(manager, memo);
+    return false;
+  }
+  memo->bucket_mask=buckets-1;
+  memo->capacity=capacity;
+  for (uint32_t i=0;i<buckets;i++) memo->buckets[i]=-1;
+  memo->len=0;
+  memo->head=-1;
+  memo->tail=-1;
+  memo->stats.hits=0;
+  memo->stats.misses=0;
+  memo->stats.evictions=0;
+  memo->stats.invalidations=0;
+  memo->stats.skipped=0;
+
+  func->memo=memo;
+  return true;
+}
+
+bool zynkMemoDisable(ArenaManager *manager, Value func_val) {
+  if (manager==NULL || !IS_NATIVE(func_val)) return false;
+  ZynkNativeFunction *func=func_val.as.obj->obj.native_func;
+  if (func->memo==NULL) return true;
+  freeMemo(manager, func->memo);
+  func->memo=NULL;
+  return true;
+}
+
+bool zynkMemoInvalidate(ArenaManager *manager, Value func_val) {
+  if (manager==NULL || !IS_NATIVE(func_val)) return false;
+  ZynkMemo *memo=func_val.as.obj->obj.native_func->memo;
+  if (memo==NULL) return false;
+  clearEntries(manager, memo);
+  memo->stats.invalidations++;
+  return true;
+}
+
+bool zynkMemoGetStats(Value func_val, ZynkMemoStats *stats) {
+  if (stats==NULL || !IS_NATIVE(func_val)) return false;
+  ZynkMemo *memo=func_val.as.obj->obj.native_func->memo;
+  if (memo==NULL) return false;
+  *stats=memo->stats;
+  stats->len=memo->len;
+  stats->capacity=memo->capacity;
+  return true;
+}
+
+Value zynkCallNative(ArenaManager *manager, ZynkEnv *env, ZynkNativeFunction *func, ZynkArray *args) {
+  if (func->memo==NULL || args==NULL) return func->func_ptr(manager, env, args);
+  if (!cacheableArgs(args)) {
+    func->memo->stats.skipped++;
+    return func->func_ptr(manager, env, args);
+  }
+
+  uint32_t hash=hashArgs(args);
+  int32_t index=lookup(func->memo, args, hash);
+  if (index>=0) {
+    ZynkMemo *memo=func->memo;
+    memo->stats.hits++;
+    if (memo->head!=index) {
+      unlinkLru(memo, index);
+      pushFront(memo, index);
+    }
+    // callers get their own copy, changing it doesn't reach the cache
+    Value result;
+    if (snapshot(manager, memo->entries[index].result, &result)) return result;
+    return func->func_ptr(manager, env, args);
+  }
+  func->memo->stats.misses++;
+
+  Value result=func->func_ptr(manager, env, args);
+  // the call may have recursed into this same function or dropped the cache
+  ZynkMemo *memo=func->memo;
+  if (memo!=NULL && cacheable(result, 0) && lookup(memo, args, hash)<0) store(manager, memo, args, hash, result);
+  return result;
+}
+
+void freeMemo(ArenaManager *manager, ZynkMemo *memo) {
+  if (memo==NULL) return;
+  clearEntries(manager, memo);
+  sysarena_free(manager, memo->entries);
+  sysarena_free(manager, memo->buckets);
+  sysarena_free(manager, memo);
+}
+
+#undef IS_NATIVE
+#undef IS_ARRAY
@@ -0,0 +1,58 @@
+#ifndef ZYNK_MEMO
+#define ZYNK_MEMO
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../common.h"
+#include "types.h"
+#include "objects.h"
+
+#define ZYNK_MEMO_CAPACITY 64
+// calls with arrays nested deeper than this aren't cached
+#define ZYNK_MEMO_MAX_DEPTH 4
+
+typedef struct {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+  uint64_t invalidations;
+  uint64_t skipped; // calls whose arguments can't be cached
+  uint32_t len;
+  uint32_t capacity;
+} ZynkMemoStats;
+
+typedef struct {
+  Value args;   // snapshot of the arguments, an array
+  Value result;
+  uint32_t hash;
+  int32_t chain;      // next entry in the same bucket, -1 ends
+  int32_t prev, next; // LRU list, most recent first
+} ZynkMemoEntry;
+
+// Bounded LRU cache of a pure native function, keyed by the contents of its
+// arguments. String and array arguments and results are kept as deep
+// copies and every hit hands out a new one, so later changes to them don't
+// reach the cache. Maps and buffers are keyed by identity and change in
+// place, calls that pass or return one always run the function.
+struct ZynkMemo {
+  ZynkMemoEntry *entries;
+  int32_t *buckets;
+  uint32_t bucket_mask;
+  uint32_t capacity;
+  uint32_t len;
+  int32_t head, tail;
+  ZynkMemoStats stats;
+};
+
+// marks the native as pure, capacity 0 means ZYNK_MEMO_CAPACITY
+bool zynkMemoEnable(ArenaManager *manager, Value func_val, uint32_t capacity);
+bool zynkMemoDisable(ArenaManager *manager, Value func_val);
+bool zynkMemoInvalidate(ArenaManager *manager, Value func_val);
+bool zynkMemoGetStats(Value func_val, ZynkMemoStats *stats);
+
+// calls the native, through its cache when it has one
+Value zynkCallNative(ArenaManager *manager, ZynkEnv *env, ZynkNativeFunction *func, ZynkArray *args);
+void freeMemo(ArenaManager *manager, ZynkMemo *memo);
+
+#endif
@@ -1,34 +1,345 @@
 // zynk memory implementation
+#define ZYNK_BUILDING_ABI // keep the exported symbols, value_inline.h has the bodies
+#include <stdatomic.h>
 #include "memory.h"
+#include "simd.h"
+#include "value_inline.h"
 
-bool zynk_cpy(uint8_t *dest, uint8_t *src, uint32_t len) {
-  if (dest==NULL || src==NULL) {
-    return false;
+#if defined(__GNUC__)
+typedef uint64_t __attribute__((may_alias)) zynk_word;
+#else
+typedef uint64_t zynk_word;
+#endif
+
+// the scans read whole aligned blocks, past the end char but never past its page
+#if defined(__GNUC__)
+#define NO_ASAN __attribute__((no_sanitize_address))
+#else
+#define NO_ASAN
+#endif
+
+#define WORD_ALIGNED(p) (((uintptr_t)(p) & 7)==0)
+#define ONES 0x0101010101010101ULL
+#define HIGHS 0x8080808080808080ULL
+
+typedef void (*CpyImpl)(uint8_t *dest, const uint8_t *src, uint32_t len);
+typedef bool (*CmpImpl)(const char *a, const char *b, uint32_t len);
+typedef uint32_t (*LenImpl)(const char *str, char endChar);
+
+// word at a time, used when there is no SIMD
+
+static void cpyWord(uint8_t *dest, const uint8_t *src, uint32_t len) {
+  uint32_t i=0;
+  if (((uintptr_t)dest & 7)==((uintptr_t)src & 7)) {
+    for (;i<len && !WORD_ALIGNED(dest+i);i++) dest[i]=src[i];
+    for (;i+8<=len;i+=8) *(zynk_word *)(dest+i)=*(const zynk_word *)(src+i);
+  }
+  for (;i<len;i++) dest[i]=src[i];
+}
+
+static void moveWord(uint8_t *dest, const uint8_t *src, uint32_t len) {
+  if (dest<=src || dest>=src+len) {
+    cpyWord(dest, src, len); // forward is safe when dest is below src
+    return;
+  }
+  uint32_t i=len;
+  if (((uintptr_t)dest & 7)==((uintptr_t)src & 7)) {
+    for (;i>0 && !WORD_ALIGNED(dest+i);i--) dest[i-1]=src[i-1];
+    for (;i>=8;i-=8) *(zynk_word *)(dest+i-8)=*(const zynk_word *)(src+i-8);
+  }
+  for (;i>0;i--) dest[i-1]=src[i-1];
+}
+
+static bool cmpWord(const char *a, const char *b, uint32_t len) {
+  uint32_t i=0;
+  if (((uintptr_t)a & 7)==((uintptr_t)b & 7)) {
+    for (;i<len && !WORD_ALIGNED(a+i);i++) {
+      if (a[i]!=b[i]) return false;
+    }
+    for (;i+8<=len;i+=8) {
+      if (*(const zynk_word *)(a+i)!=*(const zynk_word *)(b+i)) return false;
+    }
   }
-  for (uint32_t i=0;i<len;i++) {
-    dest[i]=src[i];
+  for (;i<len;i++) {
+    if (a[i]!=b[i]) return false;
   }
   return true;
 }
 
-bool zynk_strcmp(const char *a, const char *b, uint32_t len) {
-  for (uint32_t i=0;i<len;i++) {
-    if (a[i]!=b[i]) {
-      return false;
+NO_ASAN static uint32_t lenWord(const char *str, char endChar) {
+  const char *p=str;
+  for (;!WORD_ALIGNED(p);p++) {
+    if (*p==endChar) return (uint32_t)(p-str);
+  }
+  uint64_t pattern=ONES*(uint8_t)endChar;
+  for (;;p+=8) {
+    uint64_t word=*(const zynk_word *)p ^ pattern;
+    if ((word-ONES) & ~word & HIGHS) break;
+  }
+  while (*p!=endChar) p++;
+  return (uint32_t)(p-str);
+}
+
+#ifdef ZYNK_SSE2
+
+static void cpySse2(uint8_t *dest, const uint8_t *src, uint32_t len) {
+  if (len<16) {
+    cpyWord(dest, src, len);
+    return;
+  }
+  uint32_t i=0;
+  for (;i+64<=len;i+=64) {
+    __m128i x0=_mm_loadu_si128((const __m128i *)(src+i));
+    __m128i x1=_mm_loadu_si128((const __m128i *)(src+i+16));
+    __m128i x2=_mm_loadu_si128((const __m128i *)(src+i+32));
+    __m128i x3=_mm_loadu_si128((const __m128i *)(src+i+48));
+    _mm_storeu_si128((__m128i *)(dest+i), x0);
+    _mm_storeu_si128((__m128i *)(dest+i+16), x1);
+    _mm_storeu_si128((__m128i *)(dest+i+32), x2);
+    _mm_storeu_si128((__m128i *)(dest+i+48), x3);
+  }
+  for (;i+16<=len;i+=16) _mm_storeu_si128((__m128i *)(dest+i), _mm_loadu_si128((const __m128i *)(src+i)));
+  // the last block may overlap what was already copied
+  if (i<len) _mm_storeu_si128((__m128i *)(dest+len-16), _mm_loadu_si128((const __m128i *)(src+len-16)));
+}
+
+// The block at the far end is loaded before anything is stored, every other
+// load reads bytes the stores haven't reached yet.
+static void moveSse2(uint8_t *dest, const uint8_t *src, uint32_t len) {
+  if (len<16) {
+    moveWord(dest, src, len);
+    return;
+  }
+  if (dest<=src || dest>=src+len) {
+    __m128i tail=_mm_loadu_si128((const __m128i *)(src+len-16));
+    uint32_t i=0;
+    for (;i+16<=len;i+=16) _mm_storeu_si128((__m128i *)(dest+i), _mm_loadu_si128((const __m128i *)(src+i)));
+    _mm_storeu_si128((__m128i *)(dest+len-16), tail);
+  } else {
+    __m128i head=_mm_loadu_si128((const __m128i *)src);
+    uint32_t i=len;
+    for (;i>=16;i-=16) _mm_storeu_si128((__m128i *)(dest+i-16), _mm_loadu_si128((const __m128i *)(src+i-16)));
+    _mm_storeu_si128((__m128i *)dest, head);
+  }
+}
+
+static bool cmpSse2(const char *a, const char *b, uint32_t len) {
+  if (len<16) return cmpWord(a, b, len);
+  uint32_t i=0;
+  for (;i+16<=len;i+=16) {
+    __m128i eq=_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a+i)), _mm_loadu_si128((const __m128i *)(b+i)));
+    if (_mm_movemask_epi8(eq)!=0xFFFF) return false;
+  }
+  if (i<len) {
+    __m128i eq=_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(a+len-16)), _mm_loadu_si128((const __m128i *)(b+len-16)));
+    if (_mm_movemask_epi8(eq)!=0xFFFF) return false;
+  }
+  return true;
+}
+
+// aligned loads, the bytes before str are masked out
+NO_ASAN static uint32_t lenSse2(const char *str, char endChar) {
+  const __m128i target=_mm_set1_epi8(endChar);
+  uintptr_t misalign=(uintptr_t)str & 15;
+  const char *p=str-misalign;
+  unsigned mask=(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *)p), target))>>misalign;
+  if (mask) return zynk_ctz(mask);
+  for (;;) {
+    p+=16;
+    mask=(unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128((const __m128i *)p), target));
+    if (mask) return (uint32_t)(p-str)+zynk_ctz(mask);
+  }
+}
+
+#endif // ZYNK_SSE2
+
+#ifdef ZYNK_AVX2_DISPATCH
+
+ZYNK_TARGET_AVX2 static void cpyAvx2(uint8_t *dest, const uint8_t *src, uint32_t len) {
+  if (len<32) {
+    cpySse2(dest, src, len);
+    return;
+  }
+  // one unaligned block, then aligned stores from the next boundary on
+  __m256i tail=_mm256_loadu_si256((const __m256i *)(src+len-32));
+  _mm256_storeu_si256((__m256i *)dest, _mm256_loadu_si256((const __m256i *)src));
+  uint32_t i=32-(uint32_t)((uintptr_t)dest & 31);
+  for (;i+128<=len;i+=128) {
+    __m256i y0=_mm256_loadu_si256((const __m256i *)(src+i));
+    __m256i y1=_mm256_loadu_si256((const __m256i *)(src+i+32));
+    __m256i y2=_mm256_loadu_si256((const __m256i *)(src+i+64));
+    __m256i y3=_mm256_loadu_si256((const __m256i *)(src+i+96));
+    _mm256_store_si256((__m256i *)(dest+i), y0);
+    _mm256_store_si256((__m256i *)(dest+i+32), y1);
+    _mm256_store_si256((__m256i *)(dest+i+64), y2);
+    _mm256_store_si256((__m256i *)(dest+i+96), y3);
+  }
+  for (;i+32<=len;i+=32) _mm256_store_si256((__m256i *)(dest+i), _mm256_loadu_si256((const __m256i *)(src+i)));
+  _mm256_storeu_si256((__m256i *)(dest+len-32), tail);
+}
+
+ZYNK_TARGET_AVX2 static void moveAvx2(uint8_t *dest, const uint8_t *src, uint32_t len) {
+  if (len<32) {
+    moveSse2(dest, src, len);
+    return;
+  }
+  __m256i head=_mm256_loadu_si256((const __m256i *)src);
+  __m256i tail=_mm256_loadu_si256((const __m256i *)(src+len-32));
+  if (dest<=src || dest>=src+len) {
+    uint32_t i=32-(uint32_t)((uintptr_t)dest & 31);
+    for (;i+32<=len;i+=32) _mm256_store_si256((__m256i *)(dest+i), _mm256_loadu_si256((const __m256i *)(src+i)));
+  } else {
+    uint32_t i=len-(uint32_t)((uintptr_t)(dest+len) & 31);
+    for (;i>=32;i-=32) _mm256_store_si256((__m256i *)(dest+i-32), _mm256_loadu_si256((const __m256i *)(src+i-32)));
+  }
+  _mm256_storeu_si256((__m256i *)dest, head);
+  _mm256_storeu_si256((__m256i *)(dest+len-32), tail);
+}
+
+ZYNK_TARGET_AVX2 static bool cmpAvx2(const char *a, const char *b, uint32_t len) {
+  if (len<32) return cmpSse2(a, b, len);
+  uint32_t i=0;
+  for (;i+128<=len;i+=128) {
+    __m256i d0=_mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(a+i)), _mm256_loadu_si256((const __m256i *)(b+i)));
+    __m256i d1=_mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(a+i+32)), _mm256_loadu_si256((const __m256i *)(b+i+32)));
+    __m256i d2=_mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(a+i+64)), _mm256_loadu_si256((const __m256i *)(b+i+64)));
+    __m256i d3=_mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(a+i+96)), _mm256_loadu_si256((const __m256i *)(b+i+96)));
+    __m256i any=_mm256_or_si256(_mm256_or_si256(d0, d1), _mm256_or_si256(d2, d3));
+    if (!_mm256_testz_si256(any, any)) return false;
+  }
+  for (;i+32<=len;i+=32) {
+    __m256i d=_mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(a+i)), _mm256_loadu_si256((const __m256i *)(b+i)));
+    if (!_mm256_testz_si256(d, d)) return false;
+  }
+  if (i<len) {
+    __m256i d=_mm256_xor_si256(_mm256_loadu_si256((const __m256i *)(a+len-32)), _mm256_loadu_si256((const __m256i *)(b+len-32)));
+    if (!_mm256_testz_si256(d, d)) return false;
+  }
+  return true;
+}
+
+ZYNK_TARGET_AVX2 NO_ASAN static uint32_t lenAvx2(const char *str, char endChar) {
+  const __m256i target=_mm256_set1_epi8(endChar);
+  uintptr_t misalign=(uintptr_t)str & 31;
+  const char *p=str-misalign;
+  uint32_t mask=(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *)p), target))>>misalign;
+  if (mask) return (uint32_t)zynk_ctz(mask);
+  p+=32;
+  if (((uintptr_t)p & 63)!=0) {
+    mask=(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *)p), target));
+    if (mask) return (uint32_t)(p-str)+(uint32_t)zynk_ctz(mask);
+    p+=32;
+  }
+  // 64 byte aligned pairs stay within one cache line
+  for (;;p+=64) {
+    __m256i m0=_mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *)p), target);
+    __m256i m1=_mm256_cmpeq_epi8(_mm256_load_si256((const __m256i *)(p+32)), target);
+    if (_mm256_movemask_epi8(_mm256_or_si256(m0, m1))) {
+      mask=(uint32_t)_mm256_movemask_epi8(m0);
+      if (mask) return (uint32_t)(p-str)+(uint32_t)zynk_ctz(mask);
+      return (uint32_t)(p-str)+32+(uint32_t)zynk_ctz((uint32_t)_mm256_movemask_epi8(m1));
     }
   }
+}
+
+#endif // ZYNK_AVX2_DISPATCH
+
+// until zynk_memory_init runs the pointers lead to these, which run it
+static void cpyResolve(uint8_t *dest, const uint8_t *src, uint32_t len);
+static void moveResolve(uint8_t *dest, const uint8_t *src, uint32_t len);
+static bool cmpResolve(const char *a, const char *b, uint32_t len);
+static uint32_t lenResolve(const char *str, char endChar);
+
+// Atomic because threads calling in for the first time resolve them at
+// once. They all store the same thing, so relaxed is enough: a thread that
+// still loads a resolver just runs zynk_memory_init again.
+static _Atomic(CpyImpl) cpy_impl=cpyResolve;
+static _Atomic(CpyImpl) move_impl=moveResolve;
+static _Atomic(CmpImpl) cmp_impl=cmpResolve;
+static _Atomic(LenImpl) len_impl=lenResolve;
+static _Atomic(const char *) impl_name="word";
+
+#define IMPL(name) atomic_load_explicit(&(name), memory_order_relaxed)
+
+void zynk_memory_init(void) {
+  CpyImpl cpy=cpyWord, move=moveWord;
+  CmpImpl cmp=cmpWord;
+  LenImpl len=lenWord;
+  const char *name="word";
+#ifdef ZYNK_SSE2
+  cpy=cpySse2;
+  move=moveSse2;
+  cmp=cmpSse2;
+  len=lenSse2;
+  name="sse2";
+#endif
+#ifdef ZYNK_AVX2_DISPATCH
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    cpy=cpyAvx2;
+    move=moveAvx2;
+    cmp=cmpAvx2;
+    len=lenAvx2;
+    name="avx2";
+  }
+#endif
+  atomic_store_explicit(&impl_name, name, memory_order_relaxed);
+  atomic_store_explicit(&move_impl, move, memory_order_relaxed);
+  atomic_store_explicit(&cmp_impl, cmp, memory_order_relaxed);
+  atomic_store_explicit(&len_impl, len, memory_order_relaxed);
+  atomic_store_explicit(&cpy_impl, cpy, memory_order_release); // last, zynk_memory_impl checks it
+}
+
+const char *zynk_memory_impl(void) {
+  if (atomic_load_explicit(&cpy_impl, memory_order_acquire)==cpyResolve) zynk_memory_init();
+  return IMPL(impl_name);
+}
+
+static void cpyResolve(uint8_t *dest, const uint8_t *src, uint32_t len) {
+  zynk_memory_init();
+  IMPL(cpy_impl)(dest, src, len);
+}
+
+static void moveResolve(uint8_t *dest, const uint8_t *src, uint32_t len) {
+  zynk_memory_init();
+  IMPL(move_impl)(dest, src, len);
+}
+
+static bool cmpResolve(const char *a, const char *b, uint32_t len) {
+  zynk_memory_init();
+  return IMPL(cmp_impl)(a, b, len);
+}
+
+static uint32_t lenResolve(const char *str, char endChar) {
+  zynk_memory_init();
+  return IMPL(len_impl)(str, endChar);
+}
+
+bool zynk_cpy(uint8_t *dest, const uint8_t *src, uint32_t len) {
+  if (dest==NULL || src==NULL) {
+    return false;
+  }
+  IMPL(cpy_impl)(dest, src, len);
+  return true;
+}
+
+bool zynk_move(uint8_t *dest, const uint8_t *src, uint32_t len) {
+  if (dest==NULL || src==NULL) {
+    return false;
+  }
+  if (dest!=src) IMPL(move_impl)(dest, src, len);
   return true;
 }
 
+bool zynk_strcmp(const char *a, const char *b, uint32_t len) {
+  return IMPL(cmp_impl)(a, b, len);
+}
+
 uint32_t zynk_len(const char *str, char endChar) {
   if (str==NULL) {
     return 0;
   }
-  for (uint32_t i=0;;i++) {
-    if (str[i]==endChar) {
-      return i;
-    }
-  }
+  return IMPL(len_impl)(str, endChar);
 }
 
 bool zynkValuesEqual(Value a, Value b) {
@@ -62,102 +373,76 @@ bool zynkValuesEqual(Value a, Value b) {
   }
 }
 
-static bool isTruthy(Value val) {
-  switch (val.type) {
-    case ZYNK_NULL: return false;
-    case ZYNK_BOOL: return val.as.boolean;
-    case ZYNK_NUMBER: return val.as.number!=0;
-    case ZYNK_OBJ: {
-                      if (val.as.obj==NULL) return false; // null objects are false
-                      return true; // objects are true
-                   }
-    default: return false; // Unknown types are false
-  }
-}
-
 bool zynkValuesNotEqual(Value a, Value b) {
-  return !zynkValuesEqual(a, b);
-}
-
-static bool areNumbers(Value a, Value b) {
-  if (a.type!=ZYNK_NUMBER || b.type!=ZYNK_NUMBER) return false;
-  return true;
+  return zynkInlineValuesNotEqual(a, b);
 }
 
 bool zynkValuesLess(Value a, Value b) {
-  if (!areNumbers(a, b)) return false; // wtf? this only compares numbers
-  return a.as.number < b.as.number;
+  return zynkInlineValuesLess(a, b);
 }
 
 bool zynkValuesGreater(Value a, Value b) {
-  if (!areNumbers(a, b)) return false; // wtf? this only compares numbers
-  return a.as.number > b.as.number;
+  return zynkInlineValuesGreater(a, b);
 }
 
 bool zynkValuesGreaterEqual(Value a, Value b) {
-  if (!areNumbers(a, b)) return false; // wtf? this only compares numbers
-  return a.as.number >= b.as.number;
+  return zynkInlineValuesGreaterEqual(a, b);
 }
 
 bool zynkValuesLessEqual(Value a, Value b) {
-  if (!areNumbers(a, b)) return false; // wtf? this only compares numbers
-  return a.as.number <= b.as.number;
+  return zynkInlineValuesLessEqual(a, b);
 }
 
 bool zynkValuesOr(Value a, Value b) {
-  return isTruthy(a) || isTruthy(b);
+  return zynkInlineValuesOr(a, b);
 }
 
 bool zynkValuesAnd(Value a, Value b) {
-  return isTruthy(a) && isTruthy(b);
+  return zynkInlineValuesAnd(a, b);
 }
 
 bool zynkValuesXor(Value a, Value b) {
-  return isTruthy(a) ^ isTruthy(b);
+  return zynkInlineValuesXor(a, b);
 }
 
 bool zynkValuesTrue(Value val) {
-  return isTruthy(val);
+  return zynkInlineValuesTrue(val);
 }
 
 bool zynkValuesNot(Value val) {
-  return !isTruthy(val);
+  return zynkInlineValuesNot(val);
 }
 
 bool zynkValuesNand(Value a, Value b) {
-  return !zynkValuesAnd(a, b);
+  return zynkInlineValuesNand(a, b);
 }
 
 bool zynkValuesNor(Value a, Value b) {
-  return !zynkValuesOr(a, b);
+  return zynkInlineValuesNor(a, b);
 }
 
 bool zynkValuesXnor(Value a, Value b) {
-  return !zynkValuesXor(a, b);
+  return zynkInlineValuesXnor(a, b);
 }
 
 Value zynkValuesAdd(Value a, Value b) {
-  if (!areNumbers(a, b)) return zynkNull(); // wtf?
-
-  return zynkNumber(a.as.number + b.as.number);
+  return zynkInlineValuesAdd(a, b);
 }
 
 Value zynkValuesSub(Value a, Value b) {
-  if (!areNumbers(a, b)) return zynkNull(); // wtf?
-
-  return zynkNumber(a.as.number - b.as.number);
+  return zynkInlineValuesSub(a, b);
 }
 
 Value zynkValuesMul(Value a, Value b) {
-  if (!areNumbers(a, b)) return zynkNull(); // wtf?
-
-  return zynkNumber(a.as.number * b.as.number);
+  return zynkInlineValuesMul(a, b);
 }
 
 Value zynkValuesDiv(Value a, Value b) {
-  if (!areNumbers(a, b)) return zynkNull(); // wtf?
-
-  if (a.as.number==0 || b.as.number==0) return zynkNull(); // ZeroDivisionError
-
-  return zynkNumber(a.as.number / b.as.number);
+  return zynkInlineValuesDiv(a, b);
 }
+
+#undef NO_ASAN
+#undef IMPL
+#undef WORD_ALIGNED
+#undef ONES
+#undef HIGHS
@@ -11,8 +11,14 @@
 #include "../common.h"
 #include "assign.h"
 
-bool zynk_cpy(uint8_t *dest, uint8_t *src, uint32_t len);
-bool zynk_strcmp(const char *a, const char *b, uint32_t len);
+// Byte primitives. The first call picks the widest implementation the CPU
+// runs (AVX2, SSE2 or word at a time), from any thread, and
+// zynk_memory_init does it up front.
+void zynk_memory_init(void);
+const char *zynk_memory_impl(void); // "avx2", "sse2" or "word"
+bool zynk_cpy(uint8_t *dest, const uint8_t *src, uint32_t len); // no overlap
+bool zynk_move(uint8_t *dest, const uint8_t *src, uint32_t len); // overlap safe
+bool zynk_strcmp(const char *a, const char *b, uint32_t len); // true if equal
 uint32_t zynk_len(const char *str, char endChar);
 // bool zynk_arrcmp(ZynkArray *a, ZynkArray *b); // future
 
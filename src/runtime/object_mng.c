@@ -1,6 +1,8 @@
 #include "object_mng.h"
 #include "object_rf.h"
 #include "realloc.h"
+#include "map.h"
+#include "value_inline.h"
 
 static ZynkObj* create_base_zynk_obj(ArenaManager* manager, ObjType type) {
     if (manager == NULL) return NULL;
@@ -16,7 +18,15 @@ static ZynkObj* create_base_zynk_obj(ArenaManager* manager, ObjType type) {
 Value zynkCreateString(ArenaManager *manager, const char *str) {
   if (manager==NULL || str==NULL) return zynkNull();
   
-  size_t strlen = zynk_len(str, END_CHAR);
+  return zynkCreateStringLen(manager, str, zynk_len(str, END_CHAR));
+}
+
+// str doesn't need to be terminated, only len bytes are copied. With
+// str==NULL the bytes are left for the caller to fill.
+Value zynkCreateStringLen(ArenaManager *manager, const char *str, uint32_t len) {
+  if (manager==NULL) return zynkNull();
+
+  size_t strlen = len;
   
   ZynkObj *obj = create_base_zynk_obj(manager, ObjString);
 
@@ -34,9 +44,11 @@ Value zynkCreateString(ArenaManager *manager, const char *str) {
     sysarena_free(manager, (void*)obj);
     return zynkNull();
   }
-  zynk_cpy((uint8_t*)string->string, (uint8_t*)str, strlen);
+  if (str!=NULL) zynk_cpy((uint8_t*)string->string, (uint8_t*)str, strlen);
   string->string[strlen]='\0';
   string->len=strlen;
+  string->kind=ZYNK_STR_UNKNOWN;
+  string->batch=NULL;
 
   obj->obj.string=string;
 
@@ -46,6 +58,26 @@ Value zynkCreateString(ArenaManager *manager, const char *str) {
   return ret;
 }
 
+bool zynkStringInBatch(ZynkString *string) {
+  if (string==NULL || string->batch==NULL) return false;
+  uint8_t *start=(uint8_t *)string->batch;
+  uint8_t *bytes=(uint8_t *)string->string;
+  return bytes>=start && bytes<start+string->batch->size;
+}
+
+// moves the bytes of a batch string to their own allocation, needed before
+// anything reallocates them
+bool zynkStringDetach(ArenaManager *manager, ZynkString *string) {
+  if (string==NULL) return false;
+  if (!zynkStringInBatch(string)) return true;
+
+  char *own=(char *)sysarena_alloc(manager, string->len+1);
+  if (own==NULL) return false;
+  zynk_cpy((uint8_t *)own, (uint8_t *)string->string, string->len+1);
+  string->string=own;
+  return true;
+}
+
 Value zynkCreateNativeFunction(ArenaManager *manager, const char *name, ZynkFuncPtr func_ptr) {
   if (manager==NULL || func_ptr==NULL) {
     return zynkNull();
@@ -64,6 +96,7 @@ Value zynkCreateNativeFunction(ArenaManager *manager, const char *name, ZynkFunc
 
   z_func->name=name;
   z_func->func_ptr=func_ptr;
+  z_func->memo=NULL;
 
   obj->obj.native_func = z_func;
 
@@ -96,6 +129,7 @@ Value zynkCreateArray(ArenaManager *manager, size_t initial_capacity) {
 
   z_arr->len=0;
   z_arr->capacity=initial_capacity;
+  z_arr->shared=NULL;
 
   for (size_t i=0;i<initial_capacity;i++) {
     z_arr->array[i]=zynkNull();
@@ -112,6 +146,8 @@ Value zynkCreateArray(ArenaManager *manager, size_t initial_capacity) {
 bool zynkArrayGrow(ArenaManager *manager, ZynkArray* array_ptr, uint32_t amount) {
   if (manager == NULL || array_ptr == NULL) return false; // validating input
 
+  if (!zynkArrayUnshare(manager, array_ptr)) return false;
+
   size_t old_cap=array_ptr->capacity;
   size_t new_cap=old_cap+amount; // calculating new capacity
 
@@ -142,9 +178,144 @@ Value zynkArrayPush(ArenaManager *manager, Value array_val, Value element_val) {
 
   ZynkArray *arr_ptr=array_val.as.obj->obj.array;
 
+  if (!zynkArrayUnshare(manager, arr_ptr)) return zynkNull();
+
   if (arr_ptr->len >= arr_ptr->capacity) {
     if (!zynkArrayGrow(manager, arr_ptr, (arr_ptr->len - arr_ptr->capacity + 1))) return zynkNull();
   }
   arr_ptr->array[arr_ptr->len++]=zynk_retain(element_val);
   return array_val;
 }
+
+// O(1) copy, both arrays share the buffer until one of them is mutated
+Value zynkArrayCopy(ArenaManager *manager, Value array_val) {
+  if (manager==NULL || array_val.type!=ZYNK_OBJ || array_val.as.obj==NULL || array_val.as.obj->type!=ObjArray) return zynkNull();
+
+  ZynkArray *src=array_val.as.obj->obj.array;
+
+  if (src->shared==NULL) {
+    src->shared=(uint32_t *)sysarena_alloc(manager, sizeof(uint32_t));
+    if (src->shared==NULL) return zynkNull();
+    *src->shared=1;
+  }
+
+  ZynkObj *obj=create_base_zynk_obj(manager, ObjArray);
+  if (obj==NULL) return zynkNull();
+
+  ZynkArray *z_arr=(ZynkArray *)sysarena_alloc(manager, sizeof(ZynkArray));
+  if (z_arr==NULL) {
+    sysarena_free(manager, (void *)obj);
+    return zynkNull();
+  }
+
+  *z_arr=*src;
+  (*src->shared)++;
+
+  obj->obj.array=z_arr;
+
+  Value ret;
+  ret.type=ZYNK_OBJ;
+  ret.as.obj=obj;
+  return ret;
+}
+
+// gives array_ptr its own buffer before a mutation
+bool zynkArrayUnshare(ArenaManager *manager, ZynkArray* array_ptr) {
+  if (array_ptr==NULL) return false;
+  if (array_ptr->shared==NULL) return true;
+
+  if (*array_ptr->shared==1) { // the other copies are gone
+    sysarena_free(manager, array_ptr->shared);
+    array_ptr->shared=NULL;
+    return true;
+  }
+
+  Value *own=(Value *)sysarena_alloc(manager, sizeof(Value)*array_ptr->capacity);
+  if (own==NULL) return false;
+
+  for (size_t i=0;i<array_ptr->capacity;i++) {
+    own[i]=(i<array_ptr->len) ? zynk_retain(array_ptr->array[i]) : zynkNull();
+  }
+
+  (*array_ptr->shared)--;
+  array_ptr->shared=NULL;
+  array_ptr->array=own;
+  return true;
+}
+
+Value zynkCreateMap(ArenaManager *manager, uint32_t initial_capacity) {
+  if (manager==NULL) return zynkNull();
+
+  ZynkObj *obj=create_base_zynk_obj(manager, ObjMap);
+  if (obj==NULL) return zynkNull();
+
+  ZynkMap *map=(ZynkMap *)sysarena_alloc(manager, sizeof(ZynkMap));
+  if (map==NULL) {
+    sysarena_free(manager, (void *)obj);
+    return zynkNull();
+  }
+
+  map->entries=NULL;
+  map->index=NULL;
+  map->len=0;
+  map->used=0;
+  map->capacity=0;
+  map->index_cap=0;
+  map->index_width=0;
+
+  if (!zynkMapReserve(manager, map, initial_capacity)) {
+    sysarena_free(manager, (void *)map);
+    sysarena_free(manager, (void *)obj);
+    return zynkNull();
+  }
+
+  obj->obj.map=map;
+
+  Value ret;
+  ret.type=ZYNK_OBJ;
+  ret.as.obj=obj;
+  return ret;
+}
+
+Value zynkCreateBuffer(ArenaManager *manager, size_t len) {
+  if (manager==NULL) return zynkNull();
+
+  uint8_t *data=NULL;
+  if (len>0) {
+    data=(uint8_t *)sysarena_alloc(manager, len);
+    if (data==NULL) return zynkNull();
+    for (size_t i=0;i<len;i++) data[i]=0;
+  }
+
+  Value ret=zynkCreateBufferView(manager, data, len, NULL, false);
+  if (ret.type==ZYNK_NULL && data!=NULL) sysarena_free(manager, data);
+  return ret;
+}
+
+// wraps bytes the buffer doesn't allocate itself (slices, mmap)
+Value zynkCreateBufferView(ArenaManager *manager, uint8_t *data, size_t len, ZynkObj *parent, bool mapped) {
+  if (manager==NULL) return zynkNull();
+
+  ZynkObj *obj=create_base_zynk_obj(manager, ObjBuffer);
+  if (obj==NULL) return zynkNull();
+
+  ZynkBuffer *buffer=(ZynkBuffer *)sysarena_alloc(manager, sizeof(ZynkBuffer));
+  if (buffer==NULL) {
+    sysarena_free(manager, (void *)obj);
+    return zynkNull();
+  }
+
+  buffer->data=data;
+  buffer->len=len;
+  buffer->parent=parent;
+  buffer->mapped=mapped;
+  buffer->readonly=mapped || (parent!=NULL && parent->obj.buffer->readonly);
+  if (parent!=NULL) parent->ref_count++;
+
+  obj->obj.buffer=buffer;
+
+  Value ret;
+  ret.type=ZYNK_OBJ;
+  ret.as.obj=obj;
+  return ret;
+}
@@ -1,7 +1,6 @@
 #ifndef ZYNK_OBJECT_MANAGER
 #define ZYNK_OBJECT_MANAGER
 
-#include "../zynk.h"
 #include "../common.h"
 #include "types.h"
 #include "objects.h"
@@ -13,9 +12,17 @@
 
 Value zynkCreateNativeFunction(ArenaManager *manager, const char *name, ZynkFuncPtr func_ptr);
 Value zynkCreateString(ArenaManager *manager, const char *str);
+Value zynkCreateStringLen(ArenaManager *manager, const char *str, uint32_t len);
+bool zynkStringInBatch(ZynkString *string);
+bool zynkStringDetach(ArenaManager *manager, ZynkString *string);
 Value zynkCreateArray(ArenaManager *manager, size_t initial_capacity);
 bool zynkArrayGrow(ArenaManager *manager, ZynkArray* array_ptr, uint32_t amount);
 Value zynkArrayPush(ArenaManager *manager, Value array_val, Value element_val);
+Value zynkArrayCopy(ArenaManager *manager, Value array_val);
+bool zynkArrayUnshare(ArenaManager *manager, ZynkArray* array_ptr);
+Value zynkCreateMap(ArenaManager *manager, uint32_t initial_capacity);
+Value zynkCreateBuffer(ArenaManager *manager, size_t len);
+Value zynkCreateBufferView(ArenaManager *manager, uint8_t *data, size_t len, ZynkObj *parent, bool mapped);
 
 
 #endif
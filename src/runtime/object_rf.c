@@ -2,6 +2,10 @@
 #include "types.h"
 #include "../common.h"
 #include "../sysarena/sysarena.h"
+#include "buffer.h"
+#include "memo.h"
+#include "jit.h"
+#include "value_inline.h"
 
 Value zynk_retain(Value val) {
   if (val.type!=ZYNK_OBJ) return val;
@@ -17,8 +21,21 @@ void zynk_release(Value val, ArenaManager *manager) {
   if (val.as.obj->ref_count == 0) {
     // eliminar individualmente
     switch (val.as.obj->type) {
-      case (ObjString): freeString(manager, val.as.obj->obj.string); break;
+      case (ObjString): {
+        if (val.as.obj->obj.string->batch!=NULL) {
+          // the object lives in the batch block, freeString takes care of it
+          freeString(manager, val.as.obj->obj.string);
+          return;
+        }
+        freeString(manager, val.as.obj->obj.string);
+        break;
+      }
       case (ObjArray): freeArray(manager, val.as.obj->obj.array); break;
+      case (ObjMap): freeMap(manager, val.as.obj->obj.map); break;
+      case (ObjNativeFunction): freeNativeFunction(manager, val.as.obj->obj.native_func); break;
+      case (ObjFunction): freeFunction(manager, val.as.obj->obj.function); break;
+      case (ObjBuffer): freeBuffer(manager, val.as.obj->obj.buffer); break;
+      default: break;
     }
 
     // eliminar el obj en su conjunto
@@ -28,6 +45,12 @@ void zynk_release(Value val, ArenaManager *manager) {
 
 bool freeString(ArenaManager *manager, ZynkString *string) {
   if (string==NULL) return true;
+  if (string->batch!=NULL) {
+    ZynkStringBatch *batch=string->batch;
+    if (!zynkStringInBatch(string)) sysarena_free(manager, string->string); // detached
+    if (--batch->refs==0) return sysarena_free(manager, batch);
+    return true;
+  }
   if (!sysarena_free(manager, string->string)) return false;
   if (!sysarena_free(manager, string)) return false;
 
@@ -36,11 +59,51 @@ bool freeString(ArenaManager *manager, ZynkString *string) {
 
 bool freeArray(ArenaManager *manager, ZynkArray *array) {
   if (array==NULL) return true;
+  if (array->shared!=NULL && *array->shared>1) {
+    // the buffer (and its references) still belongs to the other copies
+    (*array->shared)--;
+    sysarena_free(manager, array);
+    return true;
+  }
+  if (array->shared!=NULL) sysarena_free(manager, array->shared);
   for (size_t i=0;i<array->len;i++) {
     switch (array->array[i].type) {
       case (ZYNK_OBJ): zynk_release(array->array[i], manager); break;
+      default: break;
     }
   }
+  sysarena_free(manager, array->array);
   sysarena_free(manager, array);
   return true;
 }
+
+bool freeMap(ArenaManager *manager, ZynkMap *map) {
+  if (map==NULL) return true;
+  for (uint32_t i=0;i<map->used;i++) {
+    if (!map->entries[i].used) continue;
+    zynk_release(map->entries[i].key, manager);
+    zynk_release(map->entries[i].value, manager);
+  }
+  sysarena_free(manager, map->entries);
+  sysarena_free(manager, map->index);
+  sysarena_free(manager, map);
+  return true;
+}
+
+bool freeNativeFunction(ArenaManager *manager, ZynkNativeFunction *func) {
+  if (func==NULL) return true;
+  freeMemo(manager, func->memo);
+  return sysarena_free(manager, func);
+}
+
+bool freeFunction(ArenaManager *manager, ZynkFunction *func) {
+  if (func==NULL) return true;
+  for (uint32_t i=0;i<func->constants_len;i++) zynk_release(func->constants[i], manager);
+  sysarena_free(manager, func->code);
+  if (func->constants!=NULL) sysarena_free(manager, func->constants);
+  if (func->caches!=NULL) sysarena_free(manager, func->caches);
+#ifdef ZYNK_JIT_X64
+  if (func->jit!=NULL) zynk_jit_free(func->jit);
+#endif
+  return sysarena_free(manager, func);
+}
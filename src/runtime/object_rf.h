@@ -9,5 +9,8 @@ Value zynk_retain(Value val);
 void zynk_release(Value val, ArenaManager *manager);
 bool freeString(ArenaManager *manager, ZynkString* string);
 bool freeArray(ArenaManager *manager, ZynkArray* array);
+bool freeMap(ArenaManager *manager, ZynkMap* map);
+bool freeNativeFunction(ArenaManager *manager, ZynkNativeFunction* func);
+bool freeFunction(ArenaManager *manager, ZynkFunction* func);
 
 #endif
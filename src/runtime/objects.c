@@ -6,6 +6,7 @@
 #include "realloc.h"
 #include "object_mng.h"
 #include "object_rf.h"
+#include "value_inline.h"
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
@@ -17,7 +18,7 @@ Value zynkArrayGet(Value array_val, Value index_val) {
 
   ZynkArray* array_obj = array_val.as.obj->obj.array;
 
-  if (index_val.type != ZYNK_NUMBER) return zynkNull();
+  if (index_val.type != ZYNK_NUMBER || array_obj->len==0) return zynkNull();
 
   uint32_t index=index_val.as.number;
 
@@ -30,12 +31,14 @@ void zynkArraySet(ArenaManager *manager, Value array_val, Value index_val, Value
 
   ZynkArray* array_obj = array_val.as.obj->obj.array;
 
-  if (index_val.type != ZYNK_NUMBER) return;
+  if (index_val.type != ZYNK_NUMBER || array_obj->len==0) return;
 
   uint32_t index=index_val.as.number;
 
   index = (array_obj->len + index) % array_obj->len;
 
+  if (!zynkArrayUnshare(manager, array_obj)) return;
+
   zynk_release(array_obj->array[index], manager);
 
   array_obj->array[index] = zynk_retain(new_element);
@@ -45,9 +48,10 @@ Value zynkArrayPop(ArenaManager *manager, Value array_val) {
   if (!IS_OBJ(array_val) || array_val.as.obj->type!=ObjArray) return zynkNull();
   ZynkArray* array_obj = array_val.as.obj->obj.array;
   if (array_obj->len==0) return zynkNull();
+  if (!zynkArrayUnshare(manager, array_obj)) return zynkNull();
   array_obj->len--;
   Value popped=array_obj->array[array_obj->len];
-  array_obj->array=(Value *)reallocate(manager, (uint8_t *)array_obj->array, sizeof(Value)*array_obj->capacity, array_obj->len*sizeof(Value));
+  array_obj->array[array_obj->len]=zynkNull(); // the capacity is kept for the next push
   return popped;
 }
 
@@ -6,25 +6,84 @@
 
 
 
+// cached encoding of a ZynkString (see utf8.h)
+#define ZYNK_STR_UNKNOWN 0
+#define ZYNK_STR_ASCII 1
+#define ZYNK_STR_UTF8 2
+#define ZYNK_STR_INVALID 3
+
 struct ZynkString {
   char *string;
   uint32_t len;
+  uint8_t kind; // ZYNK_STR_*, reset to ZYNK_STR_UNKNOWN when the bytes change
+  ZynkStringBatch *batch; // block holding this object, NULL for standalone strings
+};
+
+// Several strings made in one allocation (see zynkStringSplit): the header
+// is followed by their ZynkObj, their ZynkString and their bytes. The block
+// is freed when the last of them is released.
+struct ZynkStringBatch {
+  uint32_t refs;
+  uint32_t size; // whole block, header included
 };
 
+// Bytecode function, run by the VM (see vm.h)
 struct ZynkFunction {
   const char *name;
+  uint32_t *code;
+  uint32_t code_len;
+  uint32_t constants_len;
+  Value *constants;
+  ZynkLookupCache *caches; // one per constant, used for the ones naming globals
+  ZynkJitCode *jit; // native code (jit.h), NULL while the VM runs it
+  uint32_t calls; // counted up to ZYNK_JIT_THRESHOLD, set there it stays on the VM
+  uint16_t registers;
+  uint8_t arity;
 };
 
 
 struct ZynkNativeFunction {
   const char *name;
   ZynkFuncPtr func_ptr; 
+  ZynkMemo *memo; // result cache of a pure function (see memo.h), NULL otherwise
 };
 
 struct ZynkArray {
   uint32_t len;
   size_t capacity;
   Value* array; 
+  uint32_t *shared; // copy-on-write: arrays sharing `array` (NULL if owned alone)
+};
+
+// Compact ordered dictionary: entries are stored dense and in insertion
+// order, the index table only holds positions (entry+1, 0 means empty) and
+// uses the smallest integer width able to address the entries. Strings
+// and numbers are keys by value, arrays and other objects by identity.
+struct ZynkMapEntry {
+  Value key;
+  Value value;
+  uint32_t hash;
+  bool used; // false once deleted
+};
+
+struct ZynkMap {
+  ZynkMapEntry *entries;
+  uint32_t len;       // live entries
+  uint32_t used;      // consumed entries (live + deleted)
+  uint32_t capacity;  // entries capacity
+  void *index;
+  uint32_t index_cap; // power of two
+  uint8_t index_width; // 1, 2 or 4 bytes per slot
+};
+
+// Raw bytes. Slices share `data` with the buffer that owns it and keep it
+// alive through `parent`, mapped buffers come from mmap and are read-only.
+struct ZynkBuffer {
+  uint8_t *data;
+  size_t len;
+  ZynkObj *parent;
+  bool mapped;
+  bool readonly;
 };
 
 Value zynkArrayGet(Value array_val, Value index_val);
@@ -0,0 +1,119 @@
+// Code under LGPL
+#include "rcu.h"
+#include "hamt.h"
+#include "realloc.h"
+#include "zynk_enviroment.h"
+#include "../sysarena/sysarena.h"
+
+#define MIN_RETIRED 8
+
+ZynkRcu *zynk_rcu_new(ArenaManager *manager, ZynkHamtNode *root) {
+  // sysarena doesn't align, the reader slots need whole cache lines
+  uint8_t *block=(uint8_t *)sysarena_alloc(manager, sizeof(ZynkRcu)+ZYNK_RCU_LINE);
+  if (block==NULL) {
+    return NULL;
+  }
+  ZynkRcu *rcu=(ZynkRcu *)(block+(ZYNK_RCU_LINE-(uintptr_t)block%ZYNK_RCU_LINE)%ZYNK_RCU_LINE);
+  for (int i=0;i<ZYNK_RCU_READERS;i++) {
+    atomic_init(&rcu->readers[i].epoch, 0);
+    atomic_init(&rcu->readers[i].used, false);
+    rcu->readers[i].rcu=rcu;
+  }
+  atomic_init(&rcu->root, root);
+  atomic_init(&rcu->epoch, 1);
+  atomic_flag_clear(&rcu->writer);
+  rcu->retired=NULL;
+  rcu->retired_len=0;
+  rcu->retired_cap=0;
+  rcu->block=block;
+  return rcu;
+}
+
+// frees the retired roots no read section can still be using
+static void reclaim(ArenaManager *manager, ZynkRcu *rcu) {
+  uint64_t oldest=UINT64_MAX;
+  for (int i=0;i<ZYNK_RCU_READERS;i++) {
+    uint64_t epoch=atomic_load(&rcu->readers[i].epoch);
+    if (epoch!=0 && epoch<oldest) oldest=epoch;
+  }
+  uint32_t kept=0;
+  for (uint32_t i=0;i<rcu->retired_len;i++) {
+    if (rcu->retired[i].epoch<=oldest) {
+      zynk_hamt_release(manager, rcu->retired[i].root);
+    } else {
+      rcu->retired[kept++]=rcu->retired[i];
+    }
+  }
+  rcu->retired_len=kept;
+}
+
+void zynk_rcu_write_lock(ZynkRcu *rcu) {
+  while (atomic_flag_test_and_set_explicit(&rcu->writer, memory_order_acquire)) {
+  }
+}
+
+void zynk_rcu_write_unlock(ZynkRcu *rcu) {
+  atomic_flag_clear_explicit(&rcu->writer, memory_order_release);
+}
+
+// A reader that read an epoch past the old one also sees the new root: the
+// root is stored before the epoch moves. A reader still on the old epoch
+// may hold the old root, so it waits in `retired` until that reader leaves.
+bool zynk_rcu_publish(ArenaManager *manager, ZynkRcu *rcu, ZynkHamtNode *root, ZynkHamtNode *old) {
+  if (rcu->retired_len==rcu->retired_cap) {
+    uint32_t cap=rcu->retired_cap==0 ? MIN_RETIRED : rcu->retired_cap*2;
+    ZynkRcuRetired *fresh=(ZynkRcuRetired *)reallocate(manager, (uint8_t *)rcu->retired, rcu->retired_cap*sizeof(ZynkRcuRetired), cap*sizeof(ZynkRcuRetired));
+    if (fresh!=NULL) {
+      rcu->retired=fresh;
+      rcu->retired_cap=cap;
+    } else {
+      // no memory to queue it: waiting for the readers could wait for this
+      // very thread, so the edit fails instead
+      reclaim(manager, rcu);
+      if (rcu->retired_len==rcu->retired_cap) return false;
+    }
+  }
+  atomic_store(&rcu->root, root);
+  uint64_t epoch=atomic_fetch_add(&rcu->epoch, 1)+1;
+  atomic_thread_fence(memory_order_seq_cst);
+  rcu->retired[rcu->retired_len].root=old;
+  rcu->retired[rcu->retired_len].epoch=epoch;
+  rcu->retired_len++;
+  reclaim(manager, rcu);
+  return true;
+}
+
+void zynk_rcu_free(ArenaManager *manager, ZynkRcu *rcu) {
+  if (rcu==NULL) {
+    return;
+  }
+  for (uint32_t i=0;i<rcu->retired_len;i++) {
+    zynk_hamt_release(manager, rcu->retired[i].root);
+  }
+  if (rcu->retired!=NULL) sysarena_free(manager, rcu->retired);
+  sysarena_free(manager, rcu->block);
+}
+
+ZynkRcuReader *zynkRcuRegister(ZynkEnv *env) {
+  if (env==NULL || env->local==NULL || env->local->rcu==NULL) {
+    return NULL;
+  }
+  ZynkRcu *rcu=env->local->rcu;
+  for (int i=0;i<ZYNK_RCU_READERS;i++) {
+    bool expected=false;
+    if (atomic_compare_exchange_strong(&rcu->readers[i].used, &expected, true)) {
+      return &rcu->readers[i];
+    }
+  }
+  return NULL;
+}
+
+void zynkRcuUnregister(ZynkRcuReader *reader) {
+  if (reader==NULL) {
+    return;
+  }
+  atomic_store(&reader->epoch, 0);
+  atomic_store(&reader->used, false);
+}
+
+#undef MIN_RETIRED
@@ -0,0 +1,75 @@
+#ifndef ZYNK_RCU
+#define ZYNK_RCU
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "../common.h"
+#include "types.h"
+
+// Read-copy-update for the concurrent env tables (zynkEnvInitConcurrent).
+// The table is a persistent trie (hamt.h) whose root is published through
+// an atomic pointer: readers load it and search without locks, writers
+// take a spin lock, build the new root by path copying and swap it in.
+// The old root is retired and freed once every read section that could
+// still see it has ended (epoch based reclamation).
+//
+// Each thread registers once per table and wraps its accesses, reads and
+// writes alike, in zynkRcuReadLock/Unlock. The only store a reader does is
+// to its own slot, alone in its cache line. Values read stay valid until
+// the section ends; use them or copy them before that. Refcounts, the
+// allocator and lookup caches aren't thread safe: the objects stored are
+// only released by the writers, and zynkEnvSnapshot refuses these tables.
+#define ZYNK_RCU_READERS 64
+#define ZYNK_RCU_LINE 64
+
+struct ZynkRcuReader {
+  _Alignas(ZYNK_RCU_LINE) _Atomic uint64_t epoch; // 0 outside read sections
+  atomic_bool used;
+  ZynkRcu *rcu;
+};
+
+typedef struct {
+  ZynkHamtNode *root;
+  uint64_t epoch; // free once no reader is behind it
+} ZynkRcuRetired;
+
+struct ZynkRcu {
+  ZynkRcuReader readers[ZYNK_RCU_READERS];
+  _Alignas(ZYNK_RCU_LINE) _Atomic(ZynkHamtNode *) root;
+  _Atomic uint64_t epoch;
+  atomic_flag writer;
+  ZynkRcuRetired *retired;
+  uint32_t retired_len;
+  uint32_t retired_cap;
+  void *block; // allocation holding this (aligned) struct
+};
+
+ZynkRcu *zynk_rcu_new(ArenaManager *manager, ZynkHamtNode *root);
+void zynk_rcu_free(ArenaManager *manager, ZynkRcu *rcu); // no readers left
+void zynk_rcu_write_lock(ZynkRcu *rcu);
+void zynk_rcu_write_unlock(ZynkRcu *rcu);
+// under the write lock: makes `root` visible and retires `old`, false with
+// nothing published if there's no memory to retire it
+bool zynk_rcu_publish(ArenaManager *manager, ZynkRcu *rcu, ZynkHamtNode *root, ZynkHamtNode *old);
+
+static inline ZynkHamtNode *zynk_rcu_root(ZynkRcu *rcu) {
+  return atomic_load_explicit(&rcu->root, memory_order_acquire);
+}
+
+// NULL if env isn't concurrent or all ZYNK_RCU_READERS slots are taken
+ZynkRcuReader *zynkRcuRegister(ZynkEnv *env);
+void zynkRcuUnregister(ZynkRcuReader *reader);
+
+static inline void zynkRcuReadLock(ZynkRcuReader *reader) {
+  atomic_store_explicit(&reader->epoch, atomic_load_explicit(&reader->rcu->epoch, memory_order_relaxed), memory_order_relaxed);
+  // the slot must be visible before the root is read (see zynk_rcu_publish)
+  atomic_thread_fence(memory_order_seq_cst);
+}
+
+static inline void zynkRcuReadUnlock(ZynkRcuReader *reader) {
+  atomic_store_explicit(&reader->epoch, 0, memory_order_release);
+}
+
+#endif
@@ -5,7 +5,10 @@
 #include <stdint.h>
 
 void* reallocate(ArenaManager *manager, uint8_t *pointer, size_t old_cap, size_t new_cap) {
-  if (new_cap==0) sysarena_free(manager, pointer); return NULL;
+  if (new_cap==0) {
+    sysarena_free(manager, pointer);
+    return NULL;
+  }
   if (old_cap==0) return sysarena_alloc(manager, new_cap);
   if (old_cap==new_cap) return pointer;
   
@@ -3,7 +3,6 @@
 
 #include "../common.h"
 #include "../sysarena/sysarena.h"
-#include "../zynk.h"
 #include "memory.h"
 #include <stddef.h>
 #include <stdint.h>
@@ -0,0 +1,306 @@
+// Code under LGPL
+#include "search.h"
+#include "simd.h"
+#include "memory.h"
+#include "assign.h"
+#include "object_mng.h"
+#include "object_rf.h"
+#include "../sysarena/sysarena.h"
+#include "value_inline.h"
+
+#define IS_STRING(val) (val.type==ZYNK_OBJ && val.as.obj!=NULL && val.as.obj->type==ObjString)
+#define AS_STRING(val) (val.as.obj->obj.string)
+
+int64_t zynk_memchr(const uint8_t *hay, size_t len, uint8_t c) {
+  size_t i=0;
+#ifdef ZYNK_SSE2
+  const __m128i target=_mm_set1_epi8((char)c);
+  for (;i+16<=len;i+=16) {
+    int mask=_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(hay+i)), target));
+    if (mask) return (int64_t)(i+zynk_ctz(mask));
+  }
+#endif
+  for (;i<len;i++) {
+    if (hay[i]==c) return (int64_t)i;
+  }
+  return -1;
+}
+
+// Short needles: candidates must match the first and the last byte of the
+// needle, both are tested for 16 positions at once.
+static int64_t findFiltered(const uint8_t *hay, size_t hay_len, const uint8_t *needle, size_t needle_len) {
+  size_t last=needle_len-1;
+  size_t positions=hay_len-needle_len+1;
+  size_t i=0;
+#ifdef ZYNK_SSE2
+  const __m128i first_byte=_mm_set1_epi8((char)needle[0]);
+  const __m128i last_byte=_mm_set1_epi8((char)needle[last]);
+  for (;i+16<=positions;i+=16) {
+    __m128i a=_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(hay+i)), first_byte);
+    __m128i b=_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(hay+i+last)), last_byte);
+    unsigned mask=(unsigned)_mm_movemask_epi8(_mm_and_si128(a, b));
+    while (mask) {
+      size_t at=i+zynk_ctz(mask);
+      if (zynk_strcmp((const char *)hay+at+1, (const char *)needle+1, (uint32_t)(needle_len-1))) return (int64_t)at;
+      mask&=mask-1;
+    }
+  }
+#endif
+  for (;i<positions;i++) {
+    if (hay[i]==needle[0] && hay[i+last]==needle[last] && zynk_strcmp((const char *)hay+i+1, (const char *)needle+1, (uint32_t)(needle_len-1))) return (int64_t)i;
+  }
+  return -1;
+}
+
+// Crochemore-Perrin critical factorization: returns the split point and
+// the period of the right half
+static size_t criticalFactorization(const uint8_t *needle, size_t len, size_t *period) {
+  size_t max_suffix=SIZE_MAX, j=0, k=1, p=1;
+  while (j+k<len) {
+    uint8_t a=needle[j+k];
+    uint8_t b=needle[max_suffix+k];
+    if (a<b) {
+      j+=k;
+      k=1;
+      p=j-max_suffix;
+    } else if (a==b) {
+      if (k!=p) k++;
+      else {
+        j+=p;
+        k=1;
+      }
+    } else {
+      max_suffix=j++;
+      k=p=1;
+    }
+  }
+  *period=p;
+
+  size_t max_suffix_rev=SIZE_MAX;
+  j=0;
+  k=p=1;
+  while (j+k<len) {
+    uint8_t a=needle[j+k];
+    uint8_t b=needle[max_suffix_rev+k];
+    if (b<a) {
+      j+=k;
+      k=1;
+      p=j-max_suffix_rev;
+    } else if (a==b) {
+      if (k!=p) k++;
+      else {
+        j+=p;
+        k=1;
+      }
+    } else {
+      max_suffix_rev=j++;
+      k=p=1;
+    }
+  }
+  if (max_suffix_rev+1<max_suffix+1) return max_suffix+1;
+  *period=p;
+  return max_suffix_rev+1;
+}
+
+// Two-way string matching, linear time and constant space
+static int64_t findTwoWay(const uint8_t *hay, size_t hay_len, const uint8_t *needle, size_t needle_len) {
+  size_t period;
+  size_t suffix=criticalFactorization(needle, needle_len, &period);
+  size_t j=0;
+
+  if (zynk_strcmp((const char *)needle, (const char *)needle+period, (uint32_t)suffix)) {
+    // periodic needle, remember how much of the period already matched
+    size_t memory=0;
+    while (j<=hay_len-needle_len) {
+      size_t i=(suffix>memory) ? suffix : memory;
+      while (i<needle_len && needle[i]==hay[i+j]) i++;
+      if (i>=needle_len) {
+        i=suffix-1;
+        while (memory<i+1 && needle[i]==hay[i+j]) i--;
+        if (i+1<memory+1) return (int64_t)j;
+        j+=period;
+        memory=needle_len-period;
+      } else {
+        j+=i-suffix+1;
+        memory=0;
+      }
+    }
+  } else {
+    period=((suffix>needle_len-suffix) ? suffix : needle_len-suffix)+1;
+    while (j<=hay_len-needle_len) {
+      size_t i=suffix;
+      while (i<needle_len && needle[i]==hay[i+j]) i++;
+      if (i>=needle_len) {
+        i=suffix-1;
+        while (i!=SIZE_MAX && needle[i]==hay[i+j]) i--;
+        if (i==SIZE_MAX) return (int64_t)j;
+        j+=period;
+      } else {
+        j+=i-suffix+1;
+      }
+    }
+  }
+  return -1;
+}
+
+int64_t zynk_find(const uint8_t *hay, size_t hay_len, const uint8_t *needle, size_t needle_len) {
+  if (needle_len==0) return 0;
+  if (needle_len>hay_len) return -1;
+  if (needle_len==1) return zynk_memchr(hay, hay_len, needle[0]);
+  if (needle_len<ZYNK_TWO_WAY_MIN) return findFiltered(hay, hay_len, needle, needle_len);
+  return findTwoWay(hay, hay_len, needle, needle_len);
+}
+
+// same filter as findFiltered, walking the blocks backwards
+int64_t zynk_rfind(const uint8_t *hay, size_t hay_len, const uint8_t *needle, size_t needle_len) {
+  if (needle_len==0) return (int64_t)hay_len;
+  if (needle_len>hay_len) return -1;
+  size_t last=needle_len-1;
+  size_t end=hay_len-needle_len+1; // positions left to test, [0, end)
+#ifdef ZYNK_SSE2
+  const __m128i first_byte=_mm_set1_epi8((char)needle[0]);
+  const __m128i last_byte=_mm_set1_epi8((char)needle[last]);
+  while (end>=16) {
+    size_t i=end-16;
+    __m128i a=_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(hay+i)), first_byte);
+    __m128i b=_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(hay+i+last)), last_byte);
+    unsigned mask=(unsigned)_mm_movemask_epi8(_mm_and_si128(a, b));
+    while (mask) {
+      int bit=31-zynk_clz(mask);
+      if (zynk_strcmp((const char *)hay+i+bit, (const char *)needle, (uint32_t)needle_len)) return (int64_t)(i+bit);
+      mask&=~(1u<<bit);
+    }
+    end=i;
+  }
+#endif
+  while (end>0) {
+    end--;
+    if (hay[end]==needle[0] && zynk_strcmp((const char *)hay+end, (const char *)needle, (uint32_t)needle_len)) return (int64_t)end;
+  }
+  return -1;
+}
+
+// non overlapping matches
+size_t zynk_count(const uint8_t *hay, size_t hay_len, const uint8_t *needle, size_t needle_len) {
+  if (needle_len==0) return hay_len+1;
+  size_t count=0;
+  size_t at=0;
+  for (;;) {
+    int64_t found=zynk_find(hay+at, hay_len-at, needle, needle_len);
+    if (found<0) return count;
+    count++;
+    at+=(size_t)found+needle_len;
+  }
+}
+
+Value zynkStringFind(Value str_val, Value sub_val, size_t start) {
+  if (!IS_STRING(str_val) || !IS_STRING(sub_val)) return zynkNull();
+  ZynkString *str=AS_STRING(str_val);
+  ZynkString *sub=AS_STRING(sub_val);
+  if (start>str->len) return zynkNumber(-1);
+  int64_t found=zynk_find((const uint8_t *)str->string+start, str->len-start, (const uint8_t *)sub->string, sub->len);
+  return zynkNumber((found<0) ? -1 : (double)(found+(int64_t)start));
+}
+
+Value zynkStringRFind(Value str_val, Value sub_val) {
+  if (!IS_STRING(str_val) || !IS_STRING(sub_val)) return zynkNull();
+  ZynkString *str=AS_STRING(str_val);
+  ZynkString *sub=AS_STRING(sub_val);
+  return zynkNumber((double)zynk_rfind((const uint8_t *)str->string, str->len, (const uint8_t *)sub->string, sub->len));
+}
+
+Value zynkStringCount(Value str_val, Value sub_val) {
+  if (!IS_STRING(str_val) || !IS_STRING(sub_val)) return zynkNull();
+  ZynkString *str=AS_STRING(str_val);
+  ZynkString *sub=AS_STRING(sub_val);
+  return zynkNumber((double)zynk_count((const uint8_t *)str->string, str->len, (const uint8_t *)sub->string, sub->len));
+}
+
+// Every piece lives in a single ZynkStringBatch block: one allocation for
+// all the objects, their ZynkString and their bytes.
+Value zynkStringSplit(ArenaManager *manager, Value str_val, Value delim_val) {
+  if (manager==NULL || !IS_STRING(str_val) || !IS_STRING(delim_val)) return zynkNull();
+  ZynkString *str=AS_STRING(str_val);
+  ZynkString *delim=AS_STRING(delim_val);
+  if (delim->len==0) return zynkNull();
+
+  const uint8_t *hay=(const uint8_t *)str->string;
+  size_t pieces=zynk_count(hay, str->len, (const uint8_t *)delim->string, delim->len)+1;
+  size_t bytes=str->len-(pieces-1)*delim->len+pieces; // pieces + their '\0'
+  size_t size=sizeof(ZynkStringBatch)+pieces*(sizeof(ZynkObj)+sizeof(ZynkString))+bytes;
+  if (size>UINT32_MAX) return zynkNull();
+
+  Value result=zynkCreateArray(manager, pieces);
+  if (result.type==ZYNK_NULL) return result;
+
+  uint8_t *block=(uint8_t *)sysarena_alloc(manager, size);
+  if (block==NULL) {
+    zynk_release(result, manager);
+    return zynkNull();
+  }
+  ZynkStringBatch *batch=(ZynkStringBatch *)block;
+  batch->refs=(uint32_t)pieces;
+  batch->size=(uint32_t)size;
+  ZynkObj *objs=(ZynkObj *)(block+sizeof(ZynkStringBatch));
+  ZynkString *strings=(ZynkString *)(objs+pieces);
+  char *out=(char *)(strings+pieces);
+
+  ZynkArray *array=result.as.obj->obj.array;
+  size_t at=0;
+  for (size_t i=0;i<pieces;i++) {
+    int64_t found=-1;
+    if (i+1<pieces) found=zynk_find(hay+at, str->len-at, (const uint8_t *)delim->string, delim->len);
+    size_t len=(found<0) ? str->len-at : (size_t)found;
+
+    zynk_cpy((uint8_t *)out, (uint8_t *)str->string+at, (uint32_t)len);
+    out[len]='\0';
+    strings[i].string=out;
+    strings[i].len=(uint32_t)len;
+    strings[i].kind=(str->kind==ZYNK_STR_ASCII) ? ZYNK_STR_ASCII : ZYNK_STR_UNKNOWN;
+    strings[i].batch=batch;
+    objs[i].type=ObjString;
+    objs[i].ref_count=1; // owned by the result array
+    objs[i].obj.string=&strings[i];
+
+    array->array[i].type=ZYNK_OBJ;
+    array->array[i].as.obj=&objs[i];
+
+    out+=len+1;
+    at+=len+delim->len;
+  }
+  array->len=(uint32_t)pieces;
+  return result;
+}
+
+// sized once, the result is written straight into its final buffer
+Value zynkStringReplace(ArenaManager *manager, Value str_val, Value old_val, Value new_val) {
+  if (manager==NULL || !IS_STRING(str_val) || !IS_STRING(old_val) || !IS_STRING(new_val)) return zynkNull();
+  ZynkString *str=AS_STRING(str_val);
+  ZynkString *old=AS_STRING(old_val);
+  ZynkString *rep=AS_STRING(new_val);
+  if (old->len==0) return zynkCreateStringLen(manager, str->string, str->len);
+
+  const uint8_t *hay=(const uint8_t *)str->string;
+  size_t matches=zynk_count(hay, str->len, (const uint8_t *)old->string, old->len);
+  size_t len=str->len-matches*old->len+matches*rep->len;
+  if (len>UINT32_MAX) return zynkNull();
+
+  Value result=zynkCreateStringLen(manager, NULL, (uint32_t)len);
+  if (result.type==ZYNK_NULL) return result;
+
+  uint8_t *out=(uint8_t *)AS_STRING(result)->string;
+  size_t at=0;
+  for (size_t i=0;i<matches;i++) {
+    size_t found=(size_t)zynk_find(hay+at, str->len-at, (const uint8_t *)old->string, old->len);
+    zynk_cpy(out, (uint8_t *)hay+at, (uint32_t)found);
+    out+=found;
+    zynk_cpy(out, (uint8_t *)rep->string, rep->len);
+    out+=rep->len;
+    at+=found+old->len;
+  }
+  zynk_cpy(out, (uint8_t *)hay+at, (uint32_t)(str->len-at));
+  return result;
+}
+
+#undef IS_STRING
+#undef AS_STRING
@@ -0,0 +1,26 @@
+#ifndef ZYNK_SEARCH
+#define ZYNK_SEARCH
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../common.h"
+#include "types.h"
+#include "objects.h"
+
+// needles from this length on use the two-way algorithm
+#define ZYNK_TWO_WAY_MIN 32
+
+// byte offsets, -1 when there is no match
+int64_t zynk_memchr(const uint8_t *hay, size_t len, uint8_t c);
+int64_t zynk_find(const uint8_t *hay, size_t hay_len, const uint8_t *needle, size_t needle_len);
+int64_t zynk_rfind(const uint8_t *hay, size_t hay_len, const uint8_t *needle, size_t needle_len);
+size_t zynk_count(const uint8_t *hay, size_t hay_len, const uint8_t *needle, size_t needle_len);
+
+Value zynkStringFind(Value str_val, Value sub_val, size_t start);
+Value zynkStringRFind(Value str_val, Value sub_val);
+Value zynkStringCount(Value str_val, Value sub_val);
+Value zynkStringSplit(ArenaManager *manager, Value str_val, Value delim_val);
+Value zynkStringReplace(ArenaManager *manager, Value str_val, Value old_val, Value new_val);
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef ZYNK_SIMD
+#define ZYNK_SIMD
+
+// SSE2 is always there on x86-64, other targets take the scalar paths
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define ZYNK_SSE2
+#endif
+
+// AVX2 code is built with a target attribute and only run when cpuid says so
+#if defined(ZYNK_SSE2) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define ZYNK_AVX2_DISPATCH
+#define ZYNK_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#if defined(__GNUC__)
+#define zynk_prefetch(p) __builtin_prefetch(p)
+#define zynk_ctz(x) __builtin_ctz(x)
+#define zynk_clz(x) __builtin_clz(x)
+#define zynk_popcount(x) __builtin_popcount(x)
+#else
+#define zynk_prefetch(p) ((void)(p))
+static inline int zynk_ctz(unsigned x) { int n=0; while (!(x & 1)) { x>>=1; n++; } return n; }
+static inline int zynk_clz(unsigned x) { int n=0; while (!(x & 0x80000000u)) { x<<=1; n++; } return n; }
+static inline int zynk_popcount(unsigned x) { int n=0; while (x) { x&=x-1; n++; } return n; }
+#endif
+
+#endif
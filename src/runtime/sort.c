@@ -0,0 +1,366 @@
+// Code under LGPL
+// pdqsort (O. Peters, "Pattern-defeating Quicksort") over Value arrays, with
+// an LSD radix sort for arrays made only of numbers. Values are moved as
+// plain structs: an element changes slot but not owner, so nothing here
+// touches reference counts.
+#include "sort.h"
+#include "object_mng.h"
+#include "../sysarena/sysarena.h"
+#include "value_inline.h"
+
+#define INSERTION_SORT_MAX 24
+#define NINTHER_MIN 128
+#define PARTIAL_INSERTION_LIMIT 8
+
+#define SIGN_BIT 0x8000000000000000ULL
+
+typedef struct {
+  ArenaManager *manager;
+  ZynkEnv *env;
+  ZynkNativeFunction *cmp; // NULL: zynkValuesCompare
+  Value pair[2];
+  ZynkArray args; // view over pair, handed to cmp
+} SortCtx;
+
+// unsigned key with the order of the doubles, NaNs collapse to the top
+static uint64_t numberKey(double number) {
+  union { double number; uint64_t bits; } pun;
+  pun.number=number;
+  if (number!=number) return UINT64_MAX;
+  return (pun.bits & SIGN_BIT) ? ~pun.bits : pun.bits | SIGN_BIT;
+}
+
+static double keyNumber(uint64_t key) {
+  union { double number; uint64_t bits; } pun;
+  pun.bits=(key & SIGN_BIT) ? key & ~SIGN_BIT : ~key;
+  return pun.number;
+}
+
+static int typeRank(Value val) {
+  switch (val.type) {
+    case ZYNK_NULL: return 0;
+    case ZYNK_BOOL: return 1;
+    case ZYNK_NUMBER: return 2;
+    case ZYNK_BYTE: return 3;
+    case ZYNK_OBJ: {
+      if (val.as.obj==NULL) return 0;
+      return 4+(int)val.as.obj->type; // strings first
+    }
+    default: return 4+ObjBuffer+1;
+  }
+}
+
+static int compareAddr(const void *a, const void *b) {
+  return (a<b) ? -1 : (a>b);
+}
+
+int zynkValuesCompare(Value a, Value b) {
+  int rank_a=typeRank(a), rank_b=typeRank(b);
+  if (rank_a!=rank_b) return (rank_a<rank_b) ? -1 : 1;
+
+  switch (a.type) {
+    case ZYNK_BOOL: return (int)a.as.boolean-(int)b.as.boolean;
+    case ZYNK_NUMBER: {
+      uint64_t key_a=numberKey(a.as.number), key_b=numberKey(b.as.number);
+      return (key_a<key_b) ? -1 : (key_a>key_b);
+    }
+    case ZYNK_BYTE: return (int)a.as.byte-(int)b.as.byte;
+    case ZYNK_OBJ: {
+      if (a.as.obj==NULL || a.as.obj==b.as.obj) return 0;
+      switch (a.as.obj->type) {
+        case ObjString: {
+          ZynkString *str_a=a.as.obj->obj.string, *str_b=b.as.obj->obj.string;
+          uint32_t len=(str_a->len<str_b->len) ? str_a->len : str_b->len;
+          const uint8_t *p=(const uint8_t *)str_a->string, *q=(const uint8_t *)str_b->string;
+          for (uint32_t i=0;i<len;i++) {
+            if (p[i]!=q[i]) return (p[i]<q[i]) ? -1 : 1;
+          }
+          return (str_a->len<str_b->len) ? -1 : (str_a->len>str_b->len);
+        }
+        case ObjArray: {
+          // same identity rule as zynkValuesEqual: shared buffer and length
+          ZynkArray *arr_a=a.as.obj->obj.array, *arr_b=b.as.obj->obj.array;
+          if (arr_a->array!=arr_b->array) return compareAddr(arr_a->array, arr_b->array);
+          return (arr_a->len<arr_b->len) ? -1 : (arr_a->len>arr_b->len);
+        }
+        default: return compareAddr(a.as.obj, b.as.obj);
+      }
+    }
+    default: return 0;
+  }
+}
+
+static bool sortLess(SortCtx *ctx, Value a, Value b) {
+  if (ctx->cmp==NULL) return zynkValuesCompare(a, b)<0;
+  ctx->pair[0]=a;
+  ctx->pair[1]=b;
+  Value ret=ctx->cmp->func_ptr(ctx->manager, ctx->env, &ctx->args);
+  if (ret.type==ZYNK_BOOL) return ret.as.boolean;
+  if (ret.type==ZYNK_NUMBER) return ret.as.number<0;
+  if (ret.type==ZYNK_OBJ) zynk_release(ret, ctx->manager); // the answer is ours, and means false
+  return false;
+}
+
+static void swapValues(Value *v, size_t i, size_t j) {
+  Value tmp=v[i];
+  v[i]=v[j];
+  v[j]=tmp;
+}
+
+// sorts [lo, hi)
+static void insertionSort(SortCtx *ctx, Value *v, size_t lo, size_t hi) {
+  for (size_t i=lo+1;i<hi;i++) {
+    Value tmp=v[i];
+    size_t j=i;
+    while (j>lo && sortLess(ctx, tmp, v[j-1])) {
+      v[j]=v[j-1];
+      j--;
+    }
+    v[j]=tmp;
+  }
+}
+
+// insertion sort that gives up after a few moves, for nearly sorted input
+static bool partialInsertionSort(SortCtx *ctx, Value *v, size_t lo, size_t hi) {
+  size_t moves=0;
+  for (size_t i=lo+1;i<hi;i++) {
+    if (!sortLess(ctx, v[i], v[i-1])) continue;
+    Value tmp=v[i];
+    size_t j=i;
+    do {
+      v[j]=v[j-1];
+      j--;
+    } while (j>lo && sortLess(ctx, tmp, v[j-1]));
+    v[j]=tmp;
+    moves+=i-j;
+    if (moves>PARTIAL_INSERTION_LIMIT) return false;
+  }
+  return true;
+}
+
+static void siftDown(SortCtx *ctx, Value *v, size_t root, size_t n) {
+  Value tmp=v[root];
+  for (;;) {
+    size_t child=2*root+1;
+    if (child>=n) break;
+    if (child+1<n && sortLess(ctx, v[child], v[child+1])) child++;
+    if (!sortLess(ctx, tmp, v[child])) break;
+    v[root]=v[child];
+    root=child;
+  }
+  v[root]=tmp;
+}
+
+static void heapSort(SortCtx *ctx, Value *v, size_t n) {
+  for (size_t i=n/2;i>0;i--) siftDown(ctx, v, i-1, n);
+  for (size_t i=n-1;i>0;i--) {
+    swapValues(v, 0, i);
+    siftDown(ctx, v, 0, i);
+  }
+}
+
+static void sort2(SortCtx *ctx, Value *v, size_t a, size_t b) {
+  if (sortLess(ctx, v[b], v[a])) swapValues(v, a, b);
+}
+
+// leaves the median in b
+static void sort3(SortCtx *ctx, Value *v, size_t a, size_t b, size_t c) {
+  sort2(ctx, v, a, b);
+  sort2(ctx, v, b, c);
+  sort2(ctx, v, a, b);
+}
+
+// Pivot is v[lo]. Elements < pivot go left, the rest right; returns where
+// the pivot ends. The scans are bounded, a comparator that isn't a strict
+// weak order gives a wrong order but never reads out of the array.
+static size_t partitionRight(SortCtx *ctx, Value *v, size_t lo, size_t hi, bool *already_partitioned) {
+  Value pivot=v[lo];
+  size_t first=lo+1, last=hi;
+  while (first<last && sortLess(ctx, v[first], pivot)) first++;
+  while (first<last && !sortLess(ctx, v[last-1], pivot)) last--;
+  *already_partitioned=(first>=last);
+  while (first<last) {
+    swapValues(v, first, last-1);
+    first++;
+    last--;
+    while (first<last && sortLess(ctx, v[first], pivot)) first++;
+    while (first<last && !sortLess(ctx, v[last-1], pivot)) last--;
+  }
+  size_t pivot_pos=first-1;
+  v[lo]=v[pivot_pos];
+  v[pivot_pos]=pivot;
+  return pivot_pos;
+}
+
+// Same with elements equal to the pivot going left, used when the pivot
+// equals the element before the range: that whole run is then in place.
+static size_t partitionLeft(SortCtx *ctx, Value *v, size_t lo, size_t hi) {
+  Value pivot=v[lo];
+  size_t first=lo+1, last=hi;
+  while (first<last && !sortLess(ctx, pivot, v[first])) first++;
+  while (first<last && sortLess(ctx, pivot, v[last-1])) last--;
+  while (first<last) {
+    swapValues(v, first, last-1);
+    first++;
+    last--;
+    while (first<last && !sortLess(ctx, pivot, v[first])) first++;
+    while (first<last && sortLess(ctx, pivot, v[last-1])) last--;
+  }
+  size_t pivot_pos=first-1;
+  v[lo]=v[pivot_pos];
+  v[pivot_pos]=pivot;
+  return pivot_pos;
+}
+
+static void pdqSort(SortCtx *ctx, Value *v, size_t lo, size_t hi, int bad_allowed, bool leftmost) {
+  for (;;) {
+    size_t size=hi-lo;
+    if (size<INSERTION_SORT_MAX) {
+      insertionSort(ctx, v, lo, hi);
+      return;
+    }
+
+    size_t half=size/2;
+    if (size>NINTHER_MIN) {
+      sort3(ctx, v, lo, lo+half, hi-1);
+      sort3(ctx, v, lo+1, lo+half-1, hi-2);
+      sort3(ctx, v, lo+2, lo+half+1, hi-3);
+      sort3(ctx, v, lo+half-1, lo+half, lo+half+1);
+      swapValues(v, lo, lo+half);
+    } else {
+      sort3(ctx, v, lo+half, lo, hi-1);
+    }
+
+    if (!leftmost && !sortLess(ctx, v[lo-1], v[lo])) {
+      lo=partitionLeft(ctx, v, lo, hi)+1;
+      continue;
+    }
+
+    bool already_partitioned;
+    size_t pivot=partitionRight(ctx, v, lo, hi, &already_partitioned);
+    size_t left_size=pivot-lo, right_size=hi-(pivot+1);
+
+    if (left_size<size/8 || right_size<size/8) {
+      if (--bad_allowed==0) {
+        heapSort(ctx, v+lo, size);
+        return;
+      }
+      // shuffle a few elements to break the pattern
+      if (left_size>=INSERTION_SORT_MAX) {
+        swapValues(v, lo, lo+left_size/4);
+        swapValues(v, pivot-1, pivot-left_size/4);
+        if (left_size>NINTHER_MIN) {
+          swapValues(v, lo+1, lo+left_size/4+1);
+          swapValues(v, lo+2, lo+left_size/4+2);
+          swapValues(v, pivot-2, pivot-left_size/4-1);
+          swapValues(v, pivot-3, pivot-left_size/4-2);
+        }
+      }
+      if (right_size>=INSERTION_SORT_MAX) {
+        swapValues(v, pivot+1, pivot+1+right_size/4);
+        swapValues(v, hi-1, hi-right_size/4);
+        if (right_size>NINTHER_MIN) {
+          swapValues(v, pivot+2, pivot+2+right_size/4);
+          swapValues(v, pivot+3, pivot+3+right_size/4);
+          swapValues(v, hi-2, hi-1-right_size/4);
+          swapValues(v, hi-3, hi-2-right_size/4);
+        }
+      }
+    } else if (already_partitioned && partialInsertionSort(ctx, v, lo, pivot) && partialInsertionSort(ctx, v, pivot+1, hi)) {
+      return;
+    }
+
+    // recurse into the smaller side, loop on the other one
+    if (left_size<right_size) {
+      pdqSort(ctx, v, lo, pivot, bad_allowed, leftmost);
+      lo=pivot+1;
+      leftmost=false;
+    } else {
+      pdqSort(ctx, v, pivot+1, hi, bad_allowed, false);
+      hi=pivot;
+    }
+  }
+}
+
+// LSD radix sort on the number keys, one byte per pass. All histograms are
+// built in a single read and passes where every key has the same byte are
+// skipped. Stable, false if the scratch space can't be allocated.
+static bool radixSortNumbers(ArenaManager *manager, Value *v, size_t n) {
+  uint64_t *keys=(uint64_t *)sysarena_alloc(manager, n*2*sizeof(uint64_t));
+  if (keys==NULL) return false;
+  uint64_t *tmp=keys+n;
+
+  size_t counts[8][256];
+  for (int pass=0;pass<8;pass++) {
+    for (int b=0;b<256;b++) counts[pass][b]=0;
+  }
+  for (size_t i=0;i<n;i++) {
+    uint64_t key=numberKey(v[i].as.number);
+    keys[i]=key;
+    for (int pass=0;pass<8;pass++) counts[pass][(key>>(pass*8)) & 0xFF]++;
+  }
+
+  uint64_t *src=keys, *dst=tmp;
+  for (int pass=0;pass<8;pass++) {
+    size_t *count=counts[pass];
+    if (count[(src[0]>>(pass*8)) & 0xFF]==n) continue;
+
+    size_t offset=0;
+    for (int b=0;b<256;b++) {
+      size_t c=count[b];
+      count[b]=offset;
+      offset+=c;
+    }
+    for (size_t i=0;i<n;i++) {
+      uint64_t key=src[i];
+      dst[count[(key>>(pass*8)) & 0xFF]++]=key;
+    }
+    uint64_t *swap=src;
+    src=dst;
+    dst=swap;
+  }
+
+  for (size_t i=0;i<n;i++) v[i].as.number=keyNumber(src[i]);
+  sysarena_free(manager, keys);
+  return true;
+}
+
+static int log2Floor(size_t n) {
+  int log=0;
+  while (n>>=1) log++;
+  return log;
+}
+
+bool zynkArraySort(ArenaManager *manager, ZynkEnv *env, Value array_val, Value comparator) {
+  if (manager==NULL || array_val.type!=ZYNK_OBJ || array_val.as.obj==NULL || array_val.as.obj->type!=ObjArray) return false;
+
+  SortCtx ctx;
+  ctx.manager=manager;
+  ctx.env=env;
+  ctx.cmp=NULL;
+  if (comparator.type==ZYNK_OBJ && comparator.as.obj!=NULL) {
+    if (comparator.as.obj->type!=ObjNativeFunction) return false;
+    ctx.cmp=comparator.as.obj->obj.native_func;
+  } else if (comparator.type!=ZYNK_NULL) {
+    return false;
+  }
+  ctx.args.len=2;
+  ctx.args.capacity=2;
+  ctx.args.array=ctx.pair;
+  ctx.args.shared=NULL;
+
+  ZynkArray *array=array_val.as.obj->obj.array;
+  if (array->len<2) return true;
+  if (!zynkArrayUnshare(manager, array)) return false;
+  Value *v=array->array;
+  size_t n=array->len;
+
+  if (ctx.cmp==NULL && n>=ZYNK_RADIX_MIN) {
+    bool numbers=true;
+    for (size_t i=0;i<n && numbers;i++) numbers=(v[i].type==ZYNK_NUMBER);
+    if (numbers && radixSortNumbers(manager, v, n)) return true;
+  }
+
+  pdqSort(&ctx, v, 0, n, log2Floor(n)+1, true);
+  return true;
+}
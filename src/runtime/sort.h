@@ -0,0 +1,26 @@
+#ifndef ZYNK_SORT
+#define ZYNK_SORT
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../common.h"
+#include "types.h"
+#include "objects.h"
+
+// arrays of numbers at least this long are radix sorted
+#define ZYNK_RADIX_MIN 256
+
+// Total order over every value: null < bools < numbers < bytes < strings <
+// other objects. Numbers follow IEEE totalOrder (-0 before 0, NaN last),
+// strings compare their bytes, other objects compare by identity.
+int zynkValuesCompare(Value a, Value b);
+
+// Sorts in place. `comparator` is null or a native function called with
+// (a, b) that returns true / a negative number when a goes before b. The
+// default order only ties values that are equal, so the result doesn't
+// depend on the input order; with a comparator ties end up in pdqsort's
+// (unstable) order.
+bool zynkArraySort(ArenaManager *manager, ZynkEnv *env, Value array_val, Value comparator);
+
+#endif
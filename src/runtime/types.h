@@ -15,7 +15,19 @@ struct ZynkArray;
 struct ZynkEnv;
 struct ZynkEnvTable;
 struct ZynkEnvEntry;
+struct ZynkEnvAddr;
+struct ZynkLookupCache;
+struct ZynkHamtNode;
+struct ZynkRcu;
+struct ZynkRcuReader;
+struct ZynkFrozen;
+struct ZynkFramePool;
 struct ZynkFunction;
+struct ZynkMap;
+struct ZynkMapEntry;
+struct ZynkMemo;
+struct ZynkBuffer;
+struct ZynkStringBatch;
 
 typedef enum {
   ZYNK_NULL,
@@ -30,6 +42,8 @@ typedef enum {
   ObjNativeFunction,
   ObjFunction,
   ObjArray,
+  ObjMap,
+  ObjBuffer,
 } ObjType;
 
 
@@ -42,7 +56,20 @@ typedef struct ZynkArray ZynkArray;
 typedef struct ZynkEnv ZynkEnv;
 typedef struct ZynkEnvTable ZynkEnvTable;
 typedef struct ZynkEnvEntry ZynkEnvEntry;
+typedef struct ZynkEnvAddr ZynkEnvAddr;
+typedef struct ZynkLookupCache ZynkLookupCache;
+typedef struct ZynkHamtNode ZynkHamtNode;
+typedef struct ZynkRcu ZynkRcu;
+typedef struct ZynkRcuReader ZynkRcuReader;
+typedef struct ZynkFrozen ZynkFrozen;
+typedef struct ZynkFramePool ZynkFramePool;
 typedef struct ZynkFunction ZynkFunction;
+typedef struct ZynkJitCode ZynkJitCode;
+typedef struct ZynkMap ZynkMap;
+typedef struct ZynkMapEntry ZynkMapEntry;
+typedef struct ZynkBuffer ZynkBuffer;
+typedef struct ZynkStringBatch ZynkStringBatch;
+typedef struct ZynkMemo ZynkMemo;
 
 
 typedef Value (*ZynkFuncPtr)(ArenaManager *manager, ZynkEnv* env, ZynkArray* args);
@@ -67,6 +94,8 @@ struct ZynkObj {
     ZynkFunction *function;
     ZynkNativeFunction *native_func;
     ZynkArray *array;    
+    ZynkMap *map;
+    ZynkBuffer *buffer;
   } obj;
 };
 
@@ -0,0 +1,183 @@
+// Code under LGPL
+#include "utf8.h"
+#include "simd.h"
+#include "assign.h"
+#include "object_mng.h"
+#include "value_inline.h"
+
+#define IS_STRING(val) (val.type==ZYNK_OBJ && val.as.obj!=NULL && val.as.obj->type==ObjString)
+#define AS_STRING(val) (val.as.obj->obj.string)
+
+bool zynk_utf8_is_ascii(const uint8_t *str, size_t len) {
+  size_t i=0;
+#ifdef ZYNK_SSE2
+  for (;i+64<=len;i+=64) {
+    __m128i a=_mm_loadu_si128((const __m128i *)(str+i));
+    __m128i b=_mm_loadu_si128((const __m128i *)(str+i+16));
+    __m128i c=_mm_loadu_si128((const __m128i *)(str+i+32));
+    __m128i d=_mm_loadu_si128((const __m128i *)(str+i+48));
+    if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)))) return false;
+  }
+  for (;i+16<=len;i+=16) {
+    if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(str+i)))) return false;
+  }
+#endif
+  for (;i<len;i++) {
+    if (str[i]>=0x80) return false;
+  }
+  return true;
+}
+
+// length of the sequence starting at str, 0 if it is malformed (overlong,
+// surrogate, beyond U+10FFFF or truncated)
+static size_t sequenceLen(const uint8_t *str, size_t left) {
+  uint8_t b0=str[0];
+  if (b0<0x80) return 1;
+  if (b0<0xC2) return 0;
+  if (b0<0xE0) {
+    if (left<2 || (str[1] & 0xC0)!=0x80) return 0;
+    return 2;
+  }
+  if (b0<0xF0) {
+    if (left<3) return 0;
+    uint8_t lo=(b0==0xE0) ? 0xA0 : 0x80;
+    uint8_t hi=(b0==0xED) ? 0x9F : 0xBF;
+    if (str[1]<lo || str[1]>hi || (str[2] & 0xC0)!=0x80) return 0;
+    return 3;
+  }
+  if (b0<0xF5) {
+    if (left<4) return 0;
+    uint8_t lo=(b0==0xF0) ? 0x90 : 0x80;
+    uint8_t hi=(b0==0xF4) ? 0x8F : 0xBF;
+    if (str[1]<lo || str[1]>hi || (str[2] & 0xC0)!=0x80 || (str[3] & 0xC0)!=0x80) return 0;
+    return 4;
+  }
+  return 0;
+}
+
+bool zynk_utf8_validate(const uint8_t *str, size_t len) {
+  size_t i=0;
+  while (i<len) {
+#ifdef ZYNK_SSE2
+    // ASCII runs are skipped 16 bytes at a time
+    while (i+16<=len) {
+      int mask=_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(str+i)));
+      if (mask) {
+        i+=zynk_ctz(mask);
+        break;
+      }
+      i+=16;
+    }
+    if (i>=len) break;
+#endif
+    if (str[i]<0x80) {
+      i++;
+      continue;
+    }
+    size_t n=sequenceLen(str+i, len-i);
+    if (n==0) return false;
+    i+=n;
+  }
+  return true;
+}
+
+// code points = bytes that aren't continuation bytes (10xxxxxx)
+size_t zynk_utf8_count(const uint8_t *str, size_t len) {
+  size_t count=0;
+  size_t i=0;
+#ifdef ZYNK_SSE2
+  const __m128i limit=_mm_set1_epi8(-65); // 0xBF, the last continuation byte
+  for (;i+16<=len;i+=16) {
+    __m128i v=_mm_loadu_si128((const __m128i *)(str+i));
+    count+=zynk_popcount(_mm_movemask_epi8(_mm_cmpgt_epi8(v, limit)));
+  }
+#endif
+  for (;i<len;i++) {
+    count+=((str[i] & 0xC0)!=0x80);
+  }
+  return count;
+}
+
+// byte offset of code point `index`, len if it is past the end
+size_t zynk_utf8_offset(const uint8_t *str, size_t len, size_t index) {
+  size_t count=0;
+  size_t i=0;
+#ifdef ZYNK_SSE2
+  const __m128i limit=_mm_set1_epi8(-65);
+  for (;i+16<=len;i+=16) {
+    __m128i v=_mm_loadu_si128((const __m128i *)(str+i));
+    size_t block=zynk_popcount(_mm_movemask_epi8(_mm_cmpgt_epi8(v, limit)));
+    if (count+block>index) break;
+    count+=block;
+  }
+#endif
+  for (;i<len;i++) {
+    if ((str[i] & 0xC0)==0x80) continue;
+    if (count==index) return i;
+    count++;
+  }
+  return len;
+}
+
+uint8_t zynkStringKind(ZynkString *string) {
+  if (string==NULL) return ZYNK_STR_INVALID;
+  if (string->kind==ZYNK_STR_UNKNOWN) {
+    const uint8_t *bytes=(const uint8_t *)string->string;
+    if (zynk_utf8_is_ascii(bytes, string->len)) string->kind=ZYNK_STR_ASCII;
+    else if (zynk_utf8_validate(bytes, string->len)) string->kind=ZYNK_STR_UTF8;
+    else string->kind=ZYNK_STR_INVALID;
+  }
+  return string->kind;
+}
+
+Value zynkStringCodePointLen(Value str_val) {
+  if (!IS_STRING(str_val)) return zynkNull();
+  ZynkString *string=AS_STRING(str_val);
+  switch (zynkStringKind(string)) {
+    case ZYNK_STR_ASCII: return zynkNumber(string->len);
+    case ZYNK_STR_UTF8: return zynkNumber((double)zynk_utf8_count((const uint8_t *)string->string, string->len));
+    default: return zynkNull();
+  }
+}
+
+Value zynkStringCodePointSub(ArenaManager *manager, Value str_val, size_t start, size_t end) {
+  if (!IS_STRING(str_val)) return zynkNull();
+  ZynkString *string=AS_STRING(str_val);
+  if (end<start) end=start;
+
+  size_t from, to;
+  switch (zynkStringKind(string)) {
+    case ZYNK_STR_ASCII: {
+      from=(start<string->len) ? start : string->len;
+      to=(end<string->len) ? end : string->len;
+      break;
+    }
+    case ZYNK_STR_UTF8: {
+      const uint8_t *bytes=(const uint8_t *)string->string;
+      from=zynk_utf8_offset(bytes, string->len, start);
+      to=from+zynk_utf8_offset(bytes+from, string->len-from, end-start);
+      break;
+    }
+    default: return zynkNull();
+  }
+
+  Value ret=zynkCreateStringLen(manager, string->string+from, (uint32_t)(to-from));
+  if (ret.type!=ZYNK_NULL && string->kind==ZYNK_STR_ASCII) AS_STRING(ret)->kind=ZYNK_STR_ASCII;
+  return ret;
+}
+
+Value zynkStringCodePointAt(ArenaManager *manager, Value str_val, size_t index) {
+  if (!IS_STRING(str_val)) return zynkNull();
+  ZynkString *string=AS_STRING(str_val);
+  if (zynkStringKind(string)==ZYNK_STR_ASCII && index>=string->len) return zynkNull();
+
+  Value ret=zynkStringCodePointSub(manager, str_val, index, index+1);
+  if (ret.type!=ZYNK_NULL && AS_STRING(ret)->len==0) {
+    zynk_release(ret, manager);
+    return zynkNull();
+  }
+  return ret;
+}
+
+#undef IS_STRING
+#undef AS_STRING
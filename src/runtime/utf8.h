@@ -0,0 +1,21 @@
+#ifndef ZYNK_UTF8
+#define ZYNK_UTF8
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../common.h"
+#include "types.h"
+#include "objects.h"
+
+bool zynk_utf8_is_ascii(const uint8_t *str, size_t len);
+bool zynk_utf8_validate(const uint8_t *str, size_t len);
+size_t zynk_utf8_count(const uint8_t *str, size_t len);
+size_t zynk_utf8_offset(const uint8_t *str, size_t len, size_t index);
+
+uint8_t zynkStringKind(ZynkString *string);
+Value zynkStringCodePointLen(Value str_val);
+Value zynkStringCodePointAt(ArenaManager *manager, Value str_val, size_t index);
+Value zynkStringCodePointSub(ArenaManager *manager, Value str_val, size_t start, size_t end);
+
+#endif
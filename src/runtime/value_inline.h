@@ -0,0 +1,170 @@
+#ifndef ZYNK_VALUE_INLINE
+#define ZYNK_VALUE_INLINE
+
+// static inline versions of the Value constructors and operators. With
+// ZYNK_INLINE_VALUES (common.h) the public names map to them, so hot loops
+// don't pay a call and a 16 byte return per step. The out-of-line symbols
+// stay exported: `(zynkValuesAdd)(a, b)` or `&zynkValuesAdd` still reach
+// them. Include this after every other zynk header (zynk.h does).
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "../common.h"
+#include "types.h"
+#include "assign.h"
+#include "memory.h"
+
+static inline Value zynkInlineNull(void) {
+  Value ret;
+  ret.type=ZYNK_NULL;
+  ret.as.number=0;
+  return ret;
+}
+
+static inline Value zynkInlineBool(bool tf) {
+  Value ret;
+  ret.type=ZYNK_BOOL;
+  ret.as.boolean=tf;
+  return ret;
+}
+
+static inline Value zynkInlineNumber(double number) {
+  Value ret;
+  ret.type=ZYNK_NUMBER;
+  ret.as.number=number;
+  return ret;
+}
+
+static inline Value zynkInlineByte(uint8_t byte) {
+  Value ret;
+  ret.type=ZYNK_BYTE;
+  ret.as.byte=byte;
+  return ret;
+}
+
+static inline bool zynkInlineTruthy(Value val) {
+  switch (val.type) {
+    case ZYNK_BOOL: return val.as.boolean;
+    case ZYNK_NUMBER: return val.as.number!=0;
+    case ZYNK_OBJ: return val.as.obj!=NULL; // objects are true
+    default: return false; // null and unknown types are false
+  }
+}
+
+static inline bool zynkInlineAreNumbers(Value a, Value b) {
+  return a.type==ZYNK_NUMBER && b.type==ZYNK_NUMBER;
+}
+
+// objects other than the same pointer go to the out-of-line comparison
+static inline bool zynkInlineValuesEqual(Value a, Value b) {
+  if (a.type!=b.type) return false;
+  switch (a.type) {
+    case ZYNK_NULL: return true;
+    case ZYNK_BOOL: return a.as.boolean==b.as.boolean;
+    case ZYNK_NUMBER: return a.as.number==b.as.number;
+    case ZYNK_BYTE: return a.as.byte==b.as.byte;
+    case ZYNK_OBJ: return a.as.obj==b.as.obj || zynkValuesEqual(a, b);
+    default: return false;
+  }
+}
+
+static inline bool zynkInlineValuesNotEqual(Value a, Value b) {
+  return !zynkInlineValuesEqual(a, b);
+}
+
+static inline bool zynkInlineValuesLess(Value a, Value b) {
+  return zynkInlineAreNumbers(a, b) && a.as.number<b.as.number;
+}
+
+static inline bool zynkInlineValuesGreater(Value a, Value b) {
+  return zynkInlineAreNumbers(a, b) && a.as.number>b.as.number;
+}
+
+static inline bool zynkInlineValuesGreaterEqual(Value a, Value b) {
+  return zynkInlineAreNumbers(a, b) && a.as.number>=b.as.number;
+}
+
+static inline bool zynkInlineValuesLessEqual(Value a, Value b) {
+  return zynkInlineAreNumbers(a, b) && a.as.number<=b.as.number;
+}
+
+static inline bool zynkInlineValuesOr(Value a, Value b) {
+  return zynkInlineTruthy(a) || zynkInlineTruthy(b);
+}
+
+static inline bool zynkInlineValuesAnd(Value a, Value b) {
+  return zynkInlineTruthy(a) && zynkInlineTruthy(b);
+}
+
+static inline bool zynkInlineValuesXor(Value a, Value b) {
+  return zynkInlineTruthy(a) ^ zynkInlineTruthy(b);
+}
+
+static inline bool zynkInlineValuesNot(Value val) {
+  return !zynkInlineTruthy(val);
+}
+
+static inline bool zynkInlineValuesNand(Value a, Value b) {
+  return !zynkInlineValuesAnd(a, b);
+}
+
+static inline bool zynkInlineValuesNor(Value a, Value b) {
+  return !zynkInlineValuesOr(a, b);
+}
+
+static inline bool zynkInlineValuesXnor(Value a, Value b) {
+  return !zynkInlineValuesXor(a, b);
+}
+
+static inline bool zynkInlineValuesTrue(Value val) {
+  return zynkInlineTruthy(val);
+}
+
+static inline Value zynkInlineValuesAdd(Value a, Value b) {
+  if (!zynkInlineAreNumbers(a, b)) return zynkInlineNull();
+  return zynkInlineNumber(a.as.number+b.as.number);
+}
+
+static inline Value zynkInlineValuesSub(Value a, Value b) {
+  if (!zynkInlineAreNumbers(a, b)) return zynkInlineNull();
+  return zynkInlineNumber(a.as.number-b.as.number);
+}
+
+static inline Value zynkInlineValuesMul(Value a, Value b) {
+  if (!zynkInlineAreNumbers(a, b)) return zynkInlineNull();
+  return zynkInlineNumber(a.as.number*b.as.number);
+}
+
+static inline Value zynkInlineValuesDiv(Value a, Value b) {
+  if (!zynkInlineAreNumbers(a, b)) return zynkInlineNull();
+  if (a.as.number==0 || b.as.number==0) return zynkInlineNull(); // same as zynkValuesDiv
+  return zynkInlineNumber(a.as.number/b.as.number);
+}
+
+#if defined(ZYNK_INLINE_VALUES) && !defined(ZYNK_BUILDING_ABI)
+#define zynkNull() zynkInlineNull()
+#define zynkBool(tf) zynkInlineBool(tf)
+#define zynkNumber(number) zynkInlineNumber(number)
+#define zynkByte(byte) zynkInlineByte(byte)
+#define zynkValuesEqual(a, b) zynkInlineValuesEqual(a, b)
+#define zynkValuesNotEqual(a, b) zynkInlineValuesNotEqual(a, b)
+#define zynkValuesLess(a, b) zynkInlineValuesLess(a, b)
+#define zynkValuesGreater(a, b) zynkInlineValuesGreater(a, b)
+#define zynkValuesGreaterEqual(a, b) zynkInlineValuesGreaterEqual(a, b)
+#define zynkValuesLessEqual(a, b) zynkInlineValuesLessEqual(a, b)
+#define zynkValuesOr(a, b) zynkInlineValuesOr(a, b)
+#define zynkValuesAnd(a, b) zynkInlineValuesAnd(a, b)
+#define zynkValuesXor(a, b) zynkInlineValuesXor(a, b)
+#define zynkValuesNot(val) zynkInlineValuesNot(val)
+#define zynkValuesNand(a, b) zynkInlineValuesNand(a, b)
+#define zynkValuesNor(a, b) zynkInlineValuesNor(a, b)
+#define zynkValuesXnor(a, b) zynkInlineValuesXnor(a, b)
+#define zynkValuesTrue(val) zynkInlineValuesTrue(val)
+#define zynkValuesAdd(a, b) zynkInlineValuesAdd(a, b)
+#define zynkValuesSub(a, b) zynkInlineValuesSub(a, b)
+#define zynkValuesMul(a, b) zynkInlineValuesMul(a, b)
+#define zynkValuesDiv(a, b) zynkInlineValuesDiv(a, b)
+#endif
+
+#endif
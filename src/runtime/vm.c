@@ -0,0 +1,307 @@
+// Code under LGPL
+#include "vm.h"
+#include "../common.h"
+#include "calls.h"
+#include "memory.h"
+#include "object_rf.h"
+#include "zynk_enviroment.h"
+#include "../sysarena/sysarena.h"
+#include "jit.h"
+#include "value_inline.h"
+
+#define GET_OP(ins) ((ins) & 0xFF)
+#define GET_A(ins) (((ins)>>8) & 0xFF)
+#define GET_B(ins) (((ins)>>16) & 0xFF)
+#define GET_C(ins) ((ins)>>24)
+#define GET_BX(ins) ((ins)>>16)
+#define GET_SBX(ins) ((int32_t)(int16_t)((ins)>>16))
+#define IS_STRING(val) ((val).type==ZYNK_OBJ && (val).as.obj!=NULL && (val).as.obj->type==ObjString)
+
+// computed goto where the compiler has it: one indirect jump per
+// instruction, each with its own branch history
+#if defined(__GNUC__)
+#define VM_COMPUTED_GOTO
+#endif
+
+static _Thread_local uint32_t depth;
+
+// which operands of each opcode are registers (A, B, C), a constant (K)
+// or a jump (J)
+static const char *const operands[ZYNK_OP_COUNT]={
+  [ZYNK_OP_MOVE]="AB",
+  [ZYNK_OP_LOADK]="AK",
+  [ZYNK_OP_LOADNULL]="A",
+  [ZYNK_OP_LOADBOOL]="A",
+  [ZYNK_OP_ADD]="ABC",
+  [ZYNK_OP_SUB]="ABC",
+  [ZYNK_OP_MUL]="ABC",
+  [ZYNK_OP_DIV]="ABC",
+  [ZYNK_OP_EQ]="ABC",
+  [ZYNK_OP_LT]="ABC",
+  [ZYNK_OP_LE]="ABC",
+  [ZYNK_OP_NOT]="AB",
+  [ZYNK_OP_JMP]="J",
+  [ZYNK_OP_JMPIF]="AJ",
+  [ZYNK_OP_JMPIFNOT]="AJ",
+  [ZYNK_OP_GETGLOBAL]="AK",
+  [ZYNK_OP_SETGLOBAL]="AK",
+  [ZYNK_OP_GETINDEX]="ABC",
+  [ZYNK_OP_SETINDEX]="ABC",
+  [ZYNK_OP_CALL]="AB",
+  [ZYNK_OP_RETURN]="A",
+};
+
+static bool check(const uint32_t *code, uint32_t code_len, const Value *constants, uint32_t constants_len, uint16_t registers) {
+  for (uint32_t pc=0;pc<code_len;pc++) {
+    uint32_t ins=code[pc];
+    if (GET_OP(ins)>=ZYNK_OP_COUNT) return false;
+    for (const char *op=operands[GET_OP(ins)];*op!=END_CHAR;op++) {
+      int64_t target=(int64_t)pc+1+GET_SBX(ins);
+      switch (*op) {
+        case 'A': if (GET_A(ins)>=registers) return false; break;
+        case 'B': if (GET_B(ins)>=registers) return false; break;
+        case 'C': if (GET_C(ins)>=registers) return false; break;
+        case 'K': if (GET_BX(ins)>=constants_len) return false; break;
+        case 'J': if (target<0 || target>=code_len) return false; break;
+      }
+    }
+    if (GET_OP(ins)==ZYNK_OP_CALL && GET_B(ins)+GET_C(ins)>=registers) return false;
+    if ((GET_OP(ins)==ZYNK_OP_GETGLOBAL || GET_OP(ins)==ZYNK_OP_SETGLOBAL) && !IS_STRING(constants[GET_BX(ins)])) return false;
+  }
+  uint32_t last=GET_OP(code[code_len-1]);
+  return last==ZYNK_OP_RETURN || last==ZYNK_OP_JMP;
+}
+
+Value zynkCreateFunction(ArenaManager *manager, const char *name, uint8_t arity, uint16_t registers, const uint32_t *code, uint32_t code_len, const Value *constants, uint32_t constants_len) {
+  if (manager==NULL || code==NULL || code_len==0 || registers>ZYNK_VM_REGISTERS || arity>registers ||
+      (constants==NULL && constants_len!=0) || !check(code, code_len, constants, constants_len, registers)) {
+    return zynkNull();
+  }
+  ZynkObj *obj=(ZynkObj *)sysarena_alloc(manager, sizeof(ZynkObj));
+  ZynkFunction *func=(ZynkFunction *)sysarena_alloc(manager, sizeof(ZynkFunction));
+  uint32_t *copy=(uint32_t *)sysarena_alloc(manager, sizeof(uint32_t)*code_len);
+  Value *pool=constants_len==0 ? NULL : (Value *)sysarena_alloc(manager, sizeof(Value)*constants_len);
+  ZynkLookupCache *caches=constants_len==0 ? NULL : (ZynkLookupCache *)sysarena_alloc(manager, sizeof(ZynkLookupCache)*constants_len);
+  if (obj==NULL || func==NULL || copy==NULL || (constants_len!=0 && (pool==NULL || caches==NULL))) {
+    if (obj!=NULL) sysarena_free(manager, obj);
+    if (func!=NULL) sysarena_free(manager, func);
+    if (copy!=NULL) sysarena_free(manager, copy);
+    if (pool!=NULL) sysarena_free(manager, pool);
+    if (caches!=NULL) sysarena_free(manager, caches);
+    return zynkNull();
+  }
+  zynk_cpy((uint8_t *)copy, (const uint8_t *)code, sizeof(uint32_t)*code_len);
+  for (uint32_t i=0;i<constants_len;i++) {
+    pool[i]=zynk_retain(constants[i]);
+    zynkLookupCacheInit(&caches[i]);
+  }
+  func->name=name;
+  func->code=copy;
+  func->code_len=code_len;
+  func->constants=pool;
+  func->constants_len=constants_len;
+  func->caches=caches;
+  func->jit=NULL;
+  func->calls=0;
+  func->registers=registers;
+  func->arity=arity;
+  obj->type=ObjFunction;
+  obj->ref_count=1;
+  obj->obj.function=func;
+  Value ret;
+  ret.type=ZYNK_OBJ;
+  ret.as.obj=obj;
+  return ret;
+}
+
+// a register takes a reference of its own to what it's given
+static inline void put(ArenaManager *manager, Value *reg, Value value) {
+  if (value.type==ZYNK_OBJ) zynk_retain(value);
+  if (reg->type==ZYNK_OBJ) zynk_release(*reg, manager);
+  *reg=value;
+}
+
+// or keeps the one it's handed (results of calls, numbers...)
+static inline void take(ArenaManager *manager, Value *reg, Value value) {
+  if (reg->type==ZYNK_OBJ) zynk_release(*reg, manager);
+  *reg=value;
+}
+
+// one instruction other than the jumps and RETURN, for the JIT stubs
+void zynk_vm_step(ArenaManager *manager, ZynkEnv *env, ZynkFunction *func, Value *regs, uint32_t ins) {
+  const Value *k=func->constants;
+  Value *ra=&regs[GET_A(ins)];
+#define RB (regs[GET_B(ins)])
+#define RC (regs[GET_C(ins)])
+  switch (GET_OP(ins)) {
+    case ZYNK_OP_MOVE: put(manager, ra, RB); break;
+    case ZYNK_OP_LOADK: put(manager, ra, k[GET_BX(ins)]); break;
+    case ZYNK_OP_LOADNULL: take(manager, ra, zynkNull()); break;
+    case ZYNK_OP_LOADBOOL: take(manager, ra, zynkBool(GET_B(ins)!=0)); break;
+    case ZYNK_OP_ADD: take(manager, ra, zynkValuesAdd(RB, RC)); break;
+    case ZYNK_OP_SUB: take(manager, ra, zynkValuesSub(RB, RC)); break;
+    case ZYNK_OP_MUL: take(manager, ra, zynkValuesMul(RB, RC)); break;
+    case ZYNK_OP_DIV: take(manager, ra, zynkValuesDiv(RB, RC)); break;
+    case ZYNK_OP_EQ: take(manager, ra, zynkBool(zynkValuesEqual(RB, RC))); break;
+    case ZYNK_OP_LT: take(manager, ra, zynkBool(zynkValuesLess(RB, RC))); break;
+    case ZYNK_OP_LE: take(manager, ra, zynkBool(zynkValuesLessEqual(RB, RC))); break;
+    case ZYNK_OP_NOT: take(manager, ra, zynkBool(zynkValuesNot(RB))); break;
+    case ZYNK_OP_GETGLOBAL: {
+      const char *name=k[GET_BX(ins)].as.obj->obj.string->string;
+      put(manager, ra, zynkTableGetCached(env, name, &func->caches[GET_BX(ins)]));
+      break;
+    }
+    case ZYNK_OP_SETGLOBAL: {
+      const char *name=k[GET_BX(ins)].as.obj->obj.string->string;
+      zynkTableSetCached(manager, env, name, *ra, &func->caches[GET_BX(ins)]);
+      break;
+    }
+    case ZYNK_OP_GETINDEX: put(manager, ra, zynkArrayGet(RB, RC)); break;
+    case ZYNK_OP_SETINDEX: zynkArraySet(manager, *ra, RB, RC); break;
+    case ZYNK_OP_CALL: take(manager, ra, zynkCallValue(manager, env, RB, GET_C(ins), &regs[GET_B(ins)+1])); break;
+    default: break;
+  }
+#undef RB
+#undef RC
+}
+
+// RETURN: R[A] goes to the caller, the other registers are released
+Value zynk_vm_leave(ArenaManager *manager, ZynkFunction *func, Value *regs, uint8_t a) {
+  Value result=regs[a];
+  regs[a].type=ZYNK_NULL; // handed to the caller
+  for (uint32_t i=0;i<func->registers;i++) {
+    if (regs[i].type==ZYNK_OBJ) zynk_release(regs[i], manager);
+  }
+  return result;
+}
+
+static Value run(ArenaManager *manager, ZynkEnv *env, ZynkFunction *func, Value *regs) {
+  const uint32_t *pc=func->code;
+  const Value *k=func->constants;
+  uint32_t ins;
+#ifdef VM_COMPUTED_GOTO
+  static void *const labels[ZYNK_OP_COUNT]={
+    [ZYNK_OP_MOVE]=&&op_MOVE,
+    [ZYNK_OP_LOADK]=&&op_LOADK,
+    [ZYNK_OP_LOADNULL]=&&op_LOADNULL,
+    [ZYNK_OP_LOADBOOL]=&&op_LOADBOOL,
+    [ZYNK_OP_ADD]=&&op_ADD,
+    [ZYNK_OP_SUB]=&&op_SUB,
+    [ZYNK_OP_MUL]=&&op_MUL,
+    [ZYNK_OP_DIV]=&&op_DIV,
+    [ZYNK_OP_EQ]=&&op_EQ,
+    [ZYNK_OP_LT]=&&op_LT,
+    [ZYNK_OP_LE]=&&op_LE,
+    [ZYNK_OP_NOT]=&&op_NOT,
+    [ZYNK_OP_JMP]=&&op_JMP,
+    [ZYNK_OP_JMPIF]=&&op_JMPIF,
+    [ZYNK_OP_JMPIFNOT]=&&op_JMPIFNOT,
+    [ZYNK_OP_GETGLOBAL]=&&op_GETGLOBAL,
+    [ZYNK_OP_SETGLOBAL]=&&op_SETGLOBAL,
+    [ZYNK_OP_GETINDEX]=&&op_GETINDEX,
+    [ZYNK_OP_SETINDEX]=&&op_SETINDEX,
+    [ZYNK_OP_CALL]=&&op_CALL,
+    [ZYNK_OP_RETURN]=&&op_RETURN,
+  };
+#define VM_LOOP NEXT();
+#define CASE(op) op_##op:
+#define NEXT() do { ins=*pc++; goto *labels[GET_OP(ins)]; } while (0)
+#else
+#define VM_LOOP for (;;) switch (ins=*pc++, GET_OP(ins))
+#define CASE(op) case ZYNK_OP_##op:
+#define NEXT() break
+#endif
+#define RA (&regs[GET_A(ins)])
+#define RB (regs[GET_B(ins)])
+#define RC (regs[GET_C(ins)])
+
+  VM_LOOP {
+    CASE(MOVE) put(manager, RA, RB); NEXT();
+    CASE(LOADK) put(manager, RA, k[GET_BX(ins)]); NEXT();
+    CASE(LOADNULL) take(manager, RA, zynkNull()); NEXT();
+    CASE(LOADBOOL) take(manager, RA, zynkBool(GET_B(ins)!=0)); NEXT();
+    CASE(ADD) take(manager, RA, zynkValuesAdd(RB, RC)); NEXT();
+    CASE(SUB) take(manager, RA, zynkValuesSub(RB, RC)); NEXT();
+    CASE(MUL) take(manager, RA, zynkValuesMul(RB, RC)); NEXT();
+    CASE(DIV) take(manager, RA, zynkValuesDiv(RB, RC)); NEXT();
+    CASE(EQ) take(manager, RA, zynkBool(zynkValuesEqual(RB, RC))); NEXT();
+    CASE(LT) take(manager, RA, zynkBool(zynkValuesLess(RB, RC))); NEXT();
+    CASE(LE) take(manager, RA, zynkBool(zynkValuesLessEqual(RB, RC))); NEXT();
+    CASE(NOT) take(manager, RA, zynkBool(zynkValuesNot(RB))); NEXT();
+    CASE(JMP) pc+=GET_SBX(ins); NEXT();
+    CASE(JMPIF) if (zynkValuesTrue(*RA)) pc+=GET_SBX(ins); NEXT();
+    CASE(JMPIFNOT) if (!zynkValuesTrue(*RA)) pc+=GET_SBX(ins); NEXT();
+    CASE(GETGLOBAL) {
+      const char *name=k[GET_BX(ins)].as.obj->obj.string->string;
+      put(manager, RA, zynkTableGetCached(env, name, &func->caches[GET_BX(ins)]));
+      NEXT();
+    }
+    CASE(SETGLOBAL) {
+      const char *name=k[GET_BX(ins)].as.obj->obj.string->string;
+      zynkTableSetCached(manager, env, name, *RA, &func->caches[GET_BX(ins)]);
+      NEXT();
+    }
+    CASE(GETINDEX) put(manager, RA, zynkArrayGet(RB, RC)); NEXT();
+    CASE(SETINDEX) zynkArraySet(manager, *RA, RB, RC); NEXT();
+    CASE(CALL) {
+      // the arguments are read in place, the result is already ours
+      Value result=zynkCallValue(manager, env, RB, GET_C(ins), &regs[GET_B(ins)+1]);
+      take(manager, RA, result);
+      NEXT();
+    }
+    CASE(RETURN) return zynk_vm_leave(manager, func, regs, GET_A(ins));
+  }
+  return zynkNull(); // unreachable, RETURN leaves the loop
+#undef VM_LOOP
+#undef CASE
+#undef NEXT
+#undef RA
+#undef RB
+#undef RC
+}
+
+Value zynk_vm_call(ArenaManager *manager, ZynkEnv *env, ZynkFunction *func, uint32_t argc, Value *argv) {
+  if (manager==NULL || func==NULL || (argv==NULL && argc!=0) || depth>=ZYNK_VM_MAX_DEPTH) {
+    return zynkNull();
+  }
+  Value regs[ZYNK_VM_REGISTERS];
+  uint32_t given=argc<func->arity ? argc : func->arity;
+  for (uint32_t i=0;i<given;i++) regs[i]=zynk_retain(argv[i]);
+  for (uint32_t i=given;i<func->registers;i++) regs[i]=zynkNull();
+#ifdef ZYNK_JIT_X64
+  if (func->jit==NULL && func->calls<ZYNK_JIT_THRESHOLD && ++func->calls==ZYNK_JIT_THRESHOLD) {
+    func->jit=zynk_jit_compile(manager, func); // tried once, the count stays put
+  }
+#endif
+  depth++;
+#ifdef ZYNK_JIT_X64
+  Value result=func->jit!=NULL ? zynk_jit_run(manager, env, func, regs) : run(manager, env, func, regs);
+#else
+  Value result=run(manager, env, func, regs);
+#endif
+  depth--;
+  return result;
+}
+
+bool zynkCompileFunction(ArenaManager *manager, Value func) {
+  if (manager==NULL || func.type!=ZYNK_OBJ || func.as.obj==NULL || func.as.obj->type!=ObjFunction) {
+    return false;
+  }
+#ifdef ZYNK_JIT_X64
+  ZynkFunction *function=func.as.obj->obj.function;
+  if (function->jit==NULL) function->jit=zynk_jit_compile(manager, function);
+  function->calls=ZYNK_JIT_THRESHOLD;
+  return function->jit!=NULL;
+#else
+  return false;
+#endif
+}
+
+#undef GET_OP
+#undef GET_A
+#undef GET_B
+#undef GET_C
+#undef GET_BX
+#undef GET_SBX
+#undef IS_STRING
+#undef VM_COMPUTED_GOTO
@@ -0,0 +1,66 @@
+#ifndef ZYNK_VM
+#define ZYNK_VM
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../common.h"
+#include "types.h"
+#include "objects.h"
+
+// Register machine behind ObjFunction. The code is an array of 32 bit
+// instructions: the opcode in the low byte, then A, B and C, a byte each,
+// or A and a 16 bit Bx (sBx if signed, jumps count from the instruction
+// after them). Registers hold the locals and temporaries of a call, the
+// arguments arrive in the first ones. Numbers, strings and the names of
+// globals come from the constant pool of the function, and each name gets
+// its own lookup cache (ZynkLookupCache) for GETGLOBAL and SETGLOBAL.
+//
+// Registers own a reference to what they hold. RETURN hands its value to
+// the caller as a new reference, like natives do with theirs. The code is
+// checked once by zynkCreateFunction, so the loop doesn't check it again.
+#define ZYNK_VM_REGISTERS 256
+#define ZYNK_VM_MAX_DEPTH 200 // nested calls before CALL gives null
+
+typedef enum {
+  ZYNK_OP_MOVE, // R[A]=R[B]
+  ZYNK_OP_LOADK, // R[A]=K[Bx]
+  ZYNK_OP_LOADNULL, // R[A]=null
+  ZYNK_OP_LOADBOOL, // R[A]=B!=0
+  ZYNK_OP_ADD, // R[A]=R[B]+R[C] (zynkValuesAdd), SUB, MUL and DIV alike
+  ZYNK_OP_SUB,
+  ZYNK_OP_MUL,
+  ZYNK_OP_DIV,
+  ZYNK_OP_EQ, // R[A]=R[B]==R[C] (zynkValuesEqual), LT and LE alike
+  ZYNK_OP_LT,
+  ZYNK_OP_LE,
+  ZYNK_OP_NOT, // R[A]=!R[B]
+  ZYNK_OP_JMP, // pc+=sBx
+  ZYNK_OP_JMPIF, // if R[A] is true pc+=sBx
+  ZYNK_OP_JMPIFNOT, // if R[A] is false pc+=sBx
+  ZYNK_OP_GETGLOBAL, // R[A]=env[K[Bx]], K[Bx] is a string
+  ZYNK_OP_SETGLOBAL, // env[K[Bx]]=R[A], an existing name (zynkTableSet)
+  ZYNK_OP_GETINDEX, // R[A]=R[B][R[C]] (zynkArrayGet)
+  ZYNK_OP_SETINDEX, // R[A][R[B]]=R[C] (zynkArraySet)
+  ZYNK_OP_CALL, // R[A]=R[B](R[B+1], ..., R[B+C]), natives or functions
+  ZYNK_OP_RETURN, // returns R[A]
+  ZYNK_OP_COUNT
+} ZynkOpCode;
+
+#define ZYNK_ABC(op, a, b, c) ((uint32_t)(op) | (uint32_t)(a)<<8 | (uint32_t)(b)<<16 | (uint32_t)(c)<<24)
+#define ZYNK_ABX(op, a, bx) ((uint32_t)(op) | (uint32_t)(a)<<8 | (uint32_t)(uint16_t)(bx)<<16)
+
+// Copies the code and the constants. Null if the code doesn't check out:
+// unknown opcodes, registers past `registers`, constants past the pool,
+// jumps out of the code or a last instruction that isn't RETURN or JMP.
+Value zynkCreateFunction(ArenaManager *manager, const char *name, uint8_t arity, uint16_t registers, const uint32_t *code, uint32_t code_len, const Value *constants, uint32_t constants_len);
+// Compiles the function to native code now instead of after
+// ZYNK_JIT_THRESHOLD calls. False where there is no JIT (see jit.h).
+bool zynkCompileFunction(ArenaManager *manager, Value func);
+// runs a call, arguments past the arity are ignored and missing ones are null
+Value zynk_vm_call(ArenaManager *manager, ZynkEnv *env, ZynkFunction *func, uint32_t argc, Value *argv);
+// one instruction, not a jump or RETURN, and RETURN itself (for jit.c)
+void zynk_vm_step(ArenaManager *manager, ZynkEnv *env, ZynkFunction *func, Value *regs, uint32_t ins);
+Value zynk_vm_leave(ArenaManager *manager, ZynkFunction *func, Value *regs, uint8_t a);
+
+#endif
@@ -1,139 +1,1117 @@
 // Code under LGPL
 // Copyright 2025 Guillermo Leira Temes
 
+#include <stdatomic.h>
 #include "zynk_enviroment.h"
 #include "../common.h"
 #include "hash.h"
 #include "memory.h"
+#include "simd.h"
 #include "types.h"
 #include "assign.h"
+#include "hamt.h"
+#include "atom.h"
+#include "rcu.h"
+#include "frozen.h"
 #include "../sysarena/sysarena.h"
+#include "value_inline.h"
+
+#define H1(hash) ((size_t)((hash)>>7))
+#define H2(hash) ((uint8_t)((hash) & 0x7F))
+#define NO_SLOT ((size_t)-1)
+#define MANY_CHUNK 32 // names hashed and prefetched together by the *Many calls
+#define BLOOM_BITS(hash) ((1ull<<((hash)>>26)) | (1ull<<(((hash)>>20) & 63)))
+
+// Process-wide clock for layout and version: every bump takes the next
+// tick, so no table repeats a value any table has had, not even one
+// allocated where a freed table was, and a table entering a chain always
+// comes in above the one it replaces. Atomic for the writers of different
+// concurrent tables.
+static _Atomic uint32_t stamp_clock;
+
+static inline uint32_t next_stamp(void) {
+  return atomic_fetch_add_explicit(&stamp_clock, 1, memory_order_relaxed)+1;
+}
+
+static inline void restamp(ZynkEnvTable *table) {
+  uint32_t stamp=next_stamp();
+  table->layout=stamp;
+  table->version=stamp;
+}
+
+#ifdef ZYNK_ENV_STATS
+static ZynkEnvStats stats;
+#define STAT(x) (x)
+#else
+#define STAT(x) ((void)0)
+#endif
+
+// bit i set if byte i of the group matches
+#ifdef ZYNK_SSE2
+static inline uint32_t group_match(const uint8_t *group, uint8_t byte) {
+  __m128i ctrl=_mm_loadu_si128((const __m128i *)group);
+  return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)byte)));
+}
+
+// empty and deleted are the only control bytes with the high bit set
+static inline uint32_t group_free(const uint8_t *group) {
+  return (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group));
+}
+#else
+static inline uint32_t group_match(const uint8_t *group, uint8_t byte) {
+  uint32_t mask=0;
+  for (int i=0;i<ZYNK_ENV_GROUP;i++) mask|=(uint32_t)(group[i]==byte)<<i;
+  return mask;
+}
+
+static inline uint32_t group_free(const uint8_t *group) {
+  uint32_t mask=0;
+  for (int i=0;i<ZYNK_ENV_GROUP;i++) mask|=(uint32_t)(group[i]>>7)<<i;
+  return mask;
+}
+#endif
+
+static inline void set_ctrl(uint8_t *ctrl, size_t capacity, size_t slot, uint8_t byte) {
+  ctrl[slot]=byte;
+  if (slot<ZYNK_ENV_GROUP) ctrl[capacity+slot]=byte;
+}
+
+// Triangular probing over groups: with a power of two capacity it visits
+// every group once. Returns the slot holding the key or NO_SLOT, and if
+// free_slot is given the first empty or deleted slot seen on the way.
+// An interned key equals an atom entry only if it's the same pointer.
+static inline size_t probe(const uint8_t *ctrl, ZynkEnvEntry *entries, size_t capacity, const char *key, uint32_t len, uint32_t hash, size_t *free_slot, bool interned) {
+  size_t mask=capacity-1;
+  size_t pos=H1(hash) & mask;
+  uint8_t h2=H2(hash);
+  if (free_slot!=NULL) *free_slot=NO_SLOT;
+  for (size_t step=ZYNK_ENV_GROUP;step<=capacity;step+=ZYNK_ENV_GROUP) {
+    const uint8_t *group=ctrl+pos;
+    for (uint32_t match=group_match(group, h2);match!=0;match&=match-1) {
+      size_t slot=(pos+zynk_ctz(match)) & mask;
+      ZynkEnvEntry *entry=&entries[slot];
+      if (interned && entry->owner==ZYNK_NAME_ATOM) {
+        if (entry->name==key) return slot;
+        continue;
+      }
+      if (entry->hash==hash && entry->len==len && zynk_strcmp(entry->name, key, len)) {
+        return slot;
+      }
+    }
+    if (free_slot!=NULL && *free_slot==NO_SLOT) {
+      uint32_t free=group_free(group);
+      if (free!=0) *free_slot=(pos+zynk_ctz(free)) & mask;
+    }
+    if (group_match(group, ZYNK_CTRL_EMPTY)!=0) return NO_SLOT;
+    pos=(pos+step) & mask;
+  }
+  return NO_SLOT;
+}
+
+// first empty or deleted slot for a key known to be missing
+static size_t probe_free(const uint8_t *ctrl, size_t capacity, uint32_t hash) {
+  size_t mask=capacity-1;
+  size_t pos=H1(hash) & mask;
+  for (size_t step=ZYNK_ENV_GROUP;step<=capacity;step+=ZYNK_ENV_GROUP) {
+    uint32_t free=group_free(ctrl+pos);
+    if (free!=0) return (pos+zynk_ctz(free)) & mask;
+    pos=(pos+step) & mask;
+  }
+  return NO_SLOT;
+}
+
+static inline bool ready(ZynkEnvTable *table) {
+  return table!=NULL && (table->capacity!=0 || table->frozen!=NULL || table->rcu!=NULL || table->root!=NULL);
+}
+
+// false if the bloom filter is sure the key isn't in the table
+static inline bool may_hold(ZynkEnvTable *table, uint32_t hash) {
+  uint64_t bits=BLOOM_BITS(hash);
+  return (table->bloom & bits)==bits;
+}
+
+// Persistent and concurrent tables keep no slots. rcu goes first: the
+// root of a concurrent table changes under the writers, rcu never does.
+static inline bool persistent(ZynkEnvTable *table) {
+  return table->rcu!=NULL || table->root!=NULL;
+}
+
+// finds the key in the current arrays or, during a rehash, in the old ones
+static ZynkEnvEntry *lookup(ZynkEnvTable *table, const char *key, uint32_t len, uint32_t hash, size_t *free_slot, bool interned) {
+  if (table->frozen!=NULL) {
+    if (free_slot!=NULL) *free_slot=NO_SLOT;
+    return zynk_frozen_find(table->frozen, key, len, hash, interned);
+  }
+  if (persistent(table)) {
+    if (free_slot!=NULL) *free_slot=NO_SLOT;
+    // readers of a concurrent table only see the published root
+    return zynk_hamt_find(table->rcu!=NULL ? zynk_rcu_root(table->rcu) : table->root, key, len, hash);
+  }
+  size_t slot=probe(table->ctrl, table->entries, table->capacity, key, len, hash, free_slot, interned);
+  if (slot!=NO_SLOT) return &table->entries[slot];
+  if (table->old_ctrl==NULL || table->old_count==0) return NULL;
+  slot=probe(table->old_ctrl, table->old_entries, table->old_capacity, key, len, hash, NULL, interned);
+  return slot==NO_SLOT ? NULL : &table->old_entries[slot];
+}
+
+static bool alloc_slots(ArenaManager *manager, size_t capacity, uint8_t **ctrl, ZynkEnvEntry **entries) {
+  *ctrl=(uint8_t *)sysarena_alloc(manager, capacity+ZYNK_ENV_GROUP);
+  *entries=(ZynkEnvEntry *)sysarena_alloc(manager, sizeof(ZynkEnvEntry)*capacity);
+  if (*ctrl==NULL || *entries==NULL) {
+    if (*ctrl!=NULL) sysarena_free(manager, *ctrl);
+    if (*entries!=NULL) sysarena_free(manager, *entries);
+    return false;
+  }
+  for (size_t i=0;i<capacity+ZYNK_ENV_GROUP;i++) (*ctrl)[i]=ZYNK_CTRL_EMPTY;
+  return true;
+}
+
+// moves up to `slots` old slots to the current arrays, frees the old
+// arrays once they are empty
+static void rehash_step(ArenaManager *manager, ZynkEnvTable *table, size_t slots) {
+  if (table->old_ctrl==NULL) return;
+  size_t end=table->migrated+slots;
+  if (end>table->old_capacity || end<slots) end=table->old_capacity;
+  bool moved=false;
+  for (size_t i=table->migrated;i<end;i++) {
+    if (table->old_ctrl[i] & 0x80) continue;
+    ZynkEnvEntry *entry=&table->old_entries[i];
+    size_t slot=probe_free(table->ctrl, table->capacity, entry->hash);
+    if (table->ctrl[slot]==ZYNK_CTRL_DELETED) table->deleted--;
+    table->entries[slot]=*entry;
+    set_ctrl(table->ctrl, table->capacity, slot, H2(entry->hash));
+    set_ctrl(table->old_ctrl, table->old_capacity, i, ZYNK_CTRL_DELETED);
+    table->old_count--;
+    moved=true;
+  }
+  if (moved) {
+    restamp(table);
+  }
+  table->migrated=end;
+  if (table->migrated==table->old_capacity) {
+    sysarena_free(manager, table->old_ctrl);
+    sysarena_free(manager, table->old_entries);
+    table->old_ctrl=NULL;
+    table->old_entries=NULL;
+    table->old_capacity=0;
+    table->old_count=0;
+    table->migrated=0;
+  }
+}
+
+// Swaps in new arrays and leaves the current ones to be emptied by
+// rehash_step. Doubles the capacity unless tombstones make most of the load.
+static bool start_rehash(ArenaManager *manager, ZynkEnvTable *table) {
+  if (table->old_ctrl!=NULL) {
+    rehash_step(manager, table, table->old_capacity); // the previous one has to end first
+  }
+  size_t capacity=table->capacity;
+  if ((table->count+1)*200>capacity*TABLE_MAX_LOAD) capacity<<=1;
+  uint8_t *ctrl;
+  ZynkEnvEntry *entries;
+  if (!alloc_slots(manager, capacity, &ctrl, &entries)) {
+    return false;
+  }
+  table->old_ctrl=table->ctrl;
+  table->old_entries=table->entries;
+  table->old_capacity=table->capacity;
+  table->old_count=table->count;
+  table->migrated=0;
+  table->ctrl=ctrl;
+  table->entries=entries;
+  table->capacity=capacity;
+  table->deleted=0;
+  restamp(table);
+  return true;
+}
 
 bool zynkEnvInit(ZynkEnv *env, size_t capacity, ZynkEnv *enclosing, ArenaManager *manager) {
   if (env==NULL) {
     return false; //no existe xD
   }
   env->enclosing=enclosing;
+  if (env->local==NULL) {
+    env->local=(ZynkEnvTable *)sysarena_alloc(manager, sizeof(ZynkEnvTable));
+    if (env->local==NULL) return false;
+  }
   return initZynkTable(env->local, capacity, manager);
 }
 
 bool initZynkTable(ZynkEnvTable *table, size_t capacity, ArenaManager *manager) {
-  if (table==NULL || table->entries==NULL) {
+  if (table==NULL || manager==NULL) {
     return false; // no existe xD
   }
-  table->capacity=capacity;
+  size_t cap=ZYNK_ENV_GROUP;
+  while (cap<capacity) cap<<=1;
+  table->old_ctrl=NULL;
+  table->old_entries=NULL;
+  table->old_capacity=0;
+  table->old_count=0;
+  table->migrated=0;
+  table->count=0;
+  table->deleted=0;
+  restamp(table);
+  table->root=NULL;
+  table->rcu=NULL;
+  table->frozen=NULL;
+  table->bloom=0;
+  table->names=NULL;
+  table->names_used=0;
+  table->names_size=0;
+  if (!alloc_slots(manager, cap, &table->ctrl, &table->entries)) {
+    table->ctrl=NULL;
+    table->entries=NULL;
+    table->capacity=0;
+    return false;
+  }
+  table->capacity=cap;
+  return true;
+}
+
+bool zynkEnvInitPersistent(ZynkEnv *env, ZynkEnv *enclosing, ArenaManager *manager) {
+  if (env==NULL || manager==NULL) {
+    return false;
+  }
+  ZynkEnvTable *table=(ZynkEnvTable *)sysarena_alloc(manager, sizeof(ZynkEnvTable));
+  if (table==NULL) {
+    return false;
+  }
+  table->ctrl=NULL;
+  table->entries=NULL;
+  table->capacity=0;
+  table->count=0;
+  table->deleted=0;
+  table->old_ctrl=NULL;
+  table->old_entries=NULL;
+  table->old_capacity=0;
+  table->old_count=0;
+  table->migrated=0;
+  restamp(table);
+  table->root=zynk_hamt_new(manager);
+  table->rcu=NULL;
+  table->frozen=NULL;
+  table->bloom=0;
+  table->names=NULL;
+  table->names_used=0;
+  table->names_size=0;
+  if (table->root==NULL) {
+    sysarena_free(manager, table);
+    return false;
+  }
+  env->local=table;
+  env->enclosing=enclosing;
+  return true;
+}
+
+// the snapshot gets its own table sharing the root, nothing is copied
+bool zynkEnvSnapshot(ArenaManager *manager, ZynkEnv *env, ZynkEnv *snapshot) {
+  if (env==NULL || snapshot==NULL || env->local==NULL || env->local->root==NULL || env->local->rcu!=NULL) {
+    return false;
+  }
+  if (!zynkEnvInitPersistent(snapshot, env->enclosing, manager)) {
+    return false;
+  }
+  zynk_hamt_release(manager, snapshot->local->root);
+  snapshot->local->root=env->local->root;
+  zynk_hamt_retain(snapshot->local->root);
+  snapshot->local->count=env->local->count;
+  snapshot->local->bloom=env->local->bloom;
+  return true;
+}
+
+bool zynkEnvInitConcurrent(ZynkEnv *env, ZynkEnv *enclosing, ArenaManager *manager) {
+  if (!zynkEnvInitPersistent(env, enclosing, manager)) {
+    return false;
+  }
+  env->local->rcu=zynk_rcu_new(manager, env->local->root);
+  env->local->bloom=UINT64_MAX; // readers race with writers on it otherwise, this way it's never written
+  if (env->local->rcu==NULL) {
+    freeZynkTable(manager, env->local);
+    env->local=NULL;
+    return false;
+  }
+  return true;
+}
+
+// Block of names made by zynkTableNewMany: a use count, then every name
+// preceded by its offset from the start of the block.
+typedef struct {
+  uint32_t refs;
+} NameBlock;
+
+static bool free_name(ArenaManager *manager, ZynkEnvEntry *entry) {
+  if (entry->owner==ZYNK_NAME_ATOM || entry->owner==ZYNK_NAME_BUFFER) {
+    return true;
+  }
+  if (entry->owner==ZYNK_NAME_COPY) {
+    return sysarena_free(manager, entry->name);
+  }
+  uint32_t offset;
+  zynk_cpy((uint8_t *)&offset, (const uint8_t *)entry->name-sizeof(uint32_t), sizeof(uint32_t));
+  NameBlock *block=(NameBlock *)(entry->name-offset);
+  if (--block->refs==0) {
+    return sysarena_free(manager, block);
+  }
+  return true;
+}
+
+static bool free_slots(ArenaManager *manager, uint8_t *ctrl, ZynkEnvEntry *entries, size_t capacity) {
   for (size_t i=0;i<capacity;i++) {
-    if (table->entries[i]==NULL){
-      table->entries[i]=(ZynkEnvEntry *)sysarena_alloc(manager, sizeof(ZynkEnvEntry));
+    if (ctrl[i] & 0x80) continue;
+    zynk_release(entries[i].value, manager);
+    if (free_name(manager, &entries[i])==false){
+      return false;
     }
-    table->entries[i]->name=NULL;
-    table->entries[i]->value=zynkNull();
+    entries[i].name=NULL;
   }
-  return true;
+  return sysarena_free(manager, ctrl) && sysarena_free(manager, entries);
 }
+
 bool freeZynkTable(ArenaManager *manager, ZynkEnvTable *table) {
-  if (table==NULL || table->entries==NULL || table->capacity==0 || manager==NULL) {
+  if (!ready(table) || manager==NULL) {
     return false;
   } 
-  for (size_t i=0;i<table->capacity;i++) {
-    if (table->entries[i]==NULL) {
-      continue;
-    }
-    if (table->entries[i]==NULL) continue;
-    if (table->entries[i]->name==NULL) continue;
-    if (sysarena_free(manager, table->entries[i]->name)==false){
-      return false;
-    }
-    if (sysarena_free(manager, table->entries[i])==false){
-      return false;
-    }
-    table->entries[i]->name=NULL;
-    table->entries[i]=NULL;
+  if (table->root!=NULL) {
+    zynk_rcu_free(manager, table->rcu);
+    zynk_hamt_release(manager, table->root);
+    table->root=NULL;
+    return sysarena_free(manager, table);
+  }
+  if (table->frozen!=NULL) { // names are all in the buffer or interned
+    for (uint32_t i=0;i<table->frozen->count;i++) zynk_release(table->frozen->entries[i].value, manager);
+    sysarena_free(manager, table->frozen);
+    table->frozen=NULL;
+    if (table->names!=NULL) sysarena_free(manager, table->names);
+    return sysarena_free(manager, table);
+  }
+  if (table->old_ctrl!=NULL && !free_slots(manager, table->old_ctrl, table->old_entries, table->old_capacity)) {
+    return false;
   }
-  bool result=(sysarena_free(manager, table->entries) && sysarena_free(manager, table));
+  if (table->names!=NULL) sysarena_free(manager, table->names);
+  bool result=(free_slots(manager, table->ctrl, table->entries, table->capacity) && sysarena_free(manager, table));
   table->entries=NULL;
+  table->ctrl=NULL;
+  table->old_ctrl=NULL;
+  table->old_entries=NULL;
   table=NULL;
   return result;
 }
-bool zynkTableSet(ArenaManager *manager, ZynkEnv *env, const char *str, Value value) {
-  if (env==NULL || str==NULL || env->local->capacity==0 || env->local==NULL) {
+
+// The entries move to the perfect hash as they are, only their names are
+// copied, packed in slot order, to a buffer of the table.
+bool zynkEnvFreeze(ArenaManager *manager, ZynkEnv *env) {
+  if (manager==NULL || env==NULL || !ready(env->local) || persistent(env->local) || env->local->count>UINT32_MAX) {
     return false;
   }
-  ZynkEnvEntry *entry=zynkFindEntry(env, str, false);
-  if (entry==NULL) {
+  ZynkEnvTable *table=env->local;
+  if (table->frozen!=NULL) {
+    return true;
+  }
+  rehash_step(manager, table, table->old_capacity); // ends a rehash in progress
+  uint32_t count=(uint32_t)table->count;
+  ZynkEnvEntry **full=(ZynkEnvEntry **)sysarena_alloc(manager, sizeof(ZynkEnvEntry *)*(count==0 ? 1 : count));
+  if (full==NULL) {
+    return false;
+  }
+  uint32_t n=0;
+  size_t size=0;
+  for (size_t i=0;i<table->capacity;i++) {
+    if (table->ctrl[i] & 0x80) continue;
+    full[n++]=&table->entries[i];
+    if (table->entries[i].owner!=ZYNK_NAME_ATOM) size+=table->entries[i].len+1;
+  }
+  char *names=NULL;
+  if (size>UINT32_MAX || (size!=0 && (names=(char *)sysarena_alloc(manager, size))==NULL)) {
+    sysarena_free(manager, full);
+    return false;
+  }
+  ZynkFrozen *frozen=zynk_frozen_build(manager, full, n);
+  sysarena_free(manager, full);
+  if (frozen==NULL) {
+    if (names!=NULL) sysarena_free(manager, names);
     return false;
   }
+  uint32_t used=0;
+  table->bloom=0; // without the bits of deleted keys
+  for (uint32_t i=0;i<n;i++) {
+    ZynkEnvEntry *entry=&frozen->entries[i];
+    table->bloom|=BLOOM_BITS(entry->hash);
+    if (entry->owner==ZYNK_NAME_ATOM) continue;
+    zynk_cpy((uint8_t *)names+used, (const uint8_t *)entry->name, entry->len+1);
+    free_name(manager, entry);
+    entry->name=names+used;
+    entry->owner=ZYNK_NAME_BUFFER;
+    used+=entry->len+1;
+  }
+  if (table->names!=NULL) sysarena_free(manager, table->names);
+  sysarena_free(manager, table->ctrl);
+  sysarena_free(manager, table->entries);
+  table->ctrl=NULL;
+  table->entries=NULL;
+  table->capacity=0;
+  table->deleted=0;
+  table->frozen=frozen;
+  table->names=names;
+  table->names_used=(uint32_t)size;
+  table->names_size=(uint32_t)size;
+  restamp(table);
+  return true;
+}
 
-  zynk_release(entry->value, manager);
+// Back to slots before a New or Delete. The names stay in the buffer,
+// which is full, so the new ones get their own allocations.
+static bool thaw(ArenaManager *manager, ZynkEnvTable *table) {
+  ZynkFrozen *frozen=table->frozen;
+  size_t capacity=ZYNK_ENV_GROUP;
+  while (((size_t)frozen->count+1)*100>capacity*TABLE_MAX_LOAD) capacity<<=1;
+  uint8_t *ctrl;
+  ZynkEnvEntry *entries;
+  if (!alloc_slots(manager, capacity, &ctrl, &entries)) {
+    return false;
+  }
+  for (uint32_t i=0;i<frozen->count;i++) {
+    size_t slot=probe_free(ctrl, capacity, frozen->entries[i].hash);
+    entries[slot]=frozen->entries[i];
+    set_ctrl(ctrl, capacity, slot, H2(frozen->entries[i].hash));
+  }
+  table->ctrl=ctrl;
+  table->entries=entries;
+  table->capacity=capacity;
+  table->frozen=NULL;
+  sysarena_free(manager, frozen);
+  restamp(table);
+  return true;
+}
+// Edits the trie of a persistent table and keeps its counters up to date.
+// A concurrent table is never changed in place: its root is held like a
+// snapshot so the edit copies the path it touches, and retired once the
+// new root is published. The key is checked again under the write lock,
+// another writer may have been first.
+static bool hamt_edit(ArenaManager *manager, ZynkEnvTable *table, int op, const char *key, uint32_t len, uint32_t hash, Value value) {
+  ZynkRcu *rcu=table->rcu;
+  bool ok=true, moved=false;
+  if (rcu!=NULL) {
+    zynk_rcu_write_lock(rcu);
+    ok=(zynk_hamt_find(table->root, key, len, hash)==NULL)==(op==ZYNK_HAMT_NEW);
+  }
+  if (ok) {
+    ZynkHamtNode *old=table->root;
+    if (rcu!=NULL) zynk_hamt_retain(old);
+    ok=zynk_hamt_edit(manager, &table->root, op, key, len, hash, value, &moved);
+    if (rcu!=NULL && ok && !zynk_rcu_publish(manager, rcu, table->root, old)) {
+      zynk_hamt_release(manager, table->root); // never seen by a reader
+      table->root=old;
+      ok=false;
+    } else if (rcu!=NULL && !ok) {
+      zynk_hamt_release(manager, old);
+    }
+  }
+  if (ok) {
+    if (op==ZYNK_HAMT_NEW) table->count++;
+    if (op==ZYNK_HAMT_DELETE) {
+      table->count--;
+      table->layout=next_stamp();
+    }
+    if (moved) table->version=next_stamp();
+  }
+  if (rcu!=NULL) zynk_rcu_write_unlock(rcu);
+  return ok;
+}
 
+// writes through an entry found in `table`, persistent tables copy the
+// leaf (and the path to it) if a snapshot shares it
+static bool set_entry(ArenaManager *manager, ZynkEnvTable *table, ZynkEnvEntry *entry, Value value) {
+  if (persistent(table)) {
+    return hamt_edit(manager, table, ZYNK_HAMT_SET, entry->name, entry->len, entry->hash, value);
+  }
   zynk_retain(value);
-
+  zynk_release(entry->value, manager);
   entry->value=value;
   return true;
 }
-bool zynkTableNew(ZynkEnv *env, const char *str, Value value, ArenaManager *manager) {
-  if (env==NULL || str==NULL || env->local->capacity==0 || env->local->count == env->local->capacity || env->local==NULL) {
+
+static ZynkEnvEntry *lookup_chain(ZynkEnv *env, const char *key, uint32_t len, uint32_t hash, uint32_t *depth, ZynkEnvTable **holder);
+
+bool zynkTableSet(ArenaManager *manager, ZynkEnv *env, const char *str, Value value) {
+  if (env==NULL || str==NULL || !ready(env->local)) {
     return false;
   }
-  ZynkEnvEntry *entry=zynkFindEntry(env, str, true);
+  rehash_step(manager, env->local, TABLE_REHASH_STEP);
+  uint32_t len=zynk_len(str, END_CHAR);
+  ZynkEnvTable *holder;
+  ZynkEnvEntry *entry=lookup_chain(env, str, len, zynk_hash_bytes(str, len), NULL, &holder);
   if (entry==NULL) {
     return false;
-  } else if (entry->name==NULL) {
-    char *name = (char *)sysarena_alloc(manager, zynk_len(str, END_CHAR)+1);
-    zynk_retain(value);
-    entry->value = value;
-    zynk_cpy(name, str, zynk_len(str, END_CHAR)+1);
-    entry->name=name;
-  } else {
-    return false;
   }
-  env->local->count++;
+  return set_entry(manager, holder, entry, value);
+}
+// zynkTableNew once the key is hashed. `name` is the copy to keep (NULL
+// to make one) and `owner` one of ZYNK_NAME_*.
+static bool insert(ArenaManager *manager, ZynkEnvTable *table, const char *key, uint32_t len, uint32_t hash, Value value, char *name, int owner) {
+  if (persistent(table)) {
+    if (lookup(table, key, len, hash, NULL, false)!=NULL) {
+      return false;
+    }
+    if (!hamt_edit(manager, table, ZYNK_HAMT_NEW, key, len, hash, value)) {
+      return false;
+    }
+    if (table->rcu==NULL) table->bloom|=BLOOM_BITS(hash);
+    return true;
+  }
+  if (table->frozen!=NULL) {
+    if (lookup(table, key, len, hash, NULL, owner==ZYNK_NAME_ATOM)!=NULL || !thaw(manager, table)) {
+      return false;
+    }
+  }
+  rehash_step(manager, table, TABLE_REHASH_STEP);
+  size_t slot;
+  if (lookup(table, key, len, hash, &slot, owner==ZYNK_NAME_ATOM)!=NULL) {
+    return false; // already there
+  }
+  // full+deleted slots of the current arrays, the ones still in the old arrays don't count
+  if ((table->count-table->old_count+table->deleted+1)*100>table->capacity*TABLE_MAX_LOAD) {
+    if (start_rehash(manager, table)) {
+      rehash_step(manager, table, TABLE_REHASH_STEP);
+      slot=probe_free(table->ctrl, table->capacity, hash);
+    }
+  }
+  if (slot==NO_SLOT) {
+    return false; // full and no memory to grow
+  }
+  if (name==NULL && table->names!=NULL && table->names_size-table->names_used>len) {
+    name=table->names+table->names_used;
+    table->names_used+=len+1;
+    owner=ZYNK_NAME_BUFFER;
+    zynk_cpy((uint8_t *)name, (const uint8_t *)key, len+1);
+  }
+  if (name==NULL) {
+    name=(char *)sysarena_alloc(manager, len+1);
+    if (name==NULL) {
+      return false;
+    }
+    zynk_cpy((uint8_t *)name, (const uint8_t *)key, len+1);
+  }
+  if (table->ctrl[slot]==ZYNK_CTRL_DELETED) table->deleted--;
+  ZynkEnvEntry *entry=&table->entries[slot];
+  entry->name=name;
+  entry->hash=hash;
+  entry->len=len;
+  entry->owner=owner;
+  zynk_retain(value);
+  entry->value=value;
+  set_ctrl(table->ctrl, table->capacity, slot, H2(hash));
+  table->bloom|=BLOOM_BITS(hash);
+  table->count++;
+  table->version=next_stamp();
   return true;
 }
+
+bool zynkTableNew(ZynkEnv *env, const char *str, Value value, ArenaManager *manager) {
+  if (env==NULL || str==NULL || !ready(env->local)) {
+    return false;
+  }
+  uint32_t len=zynk_len(str, END_CHAR);
+  return insert(manager, env->local, str, len, zynk_hash_bytes(str, len), value, NULL, ZYNK_NAME_COPY);
+}
 Value zynkTableGet(ZynkEnv *env, const char *str) {
-  if (env==NULL || str==NULL || env->local->capacity==0 || env->local==NULL) {
+  if (env==NULL || str==NULL || !ready(env->local)) {
     return zynkNull();
   }
-  ZynkEnvEntry *entry=zynkFindEntry(env, str, false);
+  ZynkEnvEntry *entry=zynkFindEntry(env, str);
   if (entry==NULL) {
     return zynkNull();
   }
   return entry->value;
 }
-bool zynkTableDelete(ZynkEnv *env, const char *str, ArenaManager *manager) {
-  if (env==NULL || str==NULL || env->local->capacity==0 || env->local==NULL || env->local->entries==NULL) {
+// zynkTableDelete once the key is hashed
+static bool remove_key(ArenaManager *manager, ZynkEnvTable *table, const char *key, uint32_t len, uint32_t hash, bool interned) {
+  rehash_step(manager, table, TABLE_REHASH_STEP);
+  ZynkEnvEntry *entry=lookup(table, key, len, hash, NULL, interned);
+  if (entry==NULL) {
     return false;
   }
-  ZynkEnvEntry *entry=zynkFindEntry(env, str, false);
-  if (entry==NULL || entry->name == NULL) {
-    return false;
+  if (persistent(table)) {
+    return hamt_edit(manager, table, ZYNK_HAMT_DELETE, key, len, hash, zynkNull());
+  }
+  if (table->frozen!=NULL) {
+    if (!thaw(manager, table)) {
+      return false;
+    }
+    entry=lookup(table, key, len, hash, NULL, interned);
   }
-  sysarena_free(manager, entry->name);
+  free_name(manager, entry);
   entry->name=NULL;
   zynk_release(entry->value, manager);
   entry->value=zynkNull();
-  env->local->count--;
-  return true;
-}
-ZynkEnvEntry *zynkFindEntry(ZynkEnv *env, const char *key, bool niu) {
-  size_t capacity=env->local->capacity;
-  uint32_t index = zynk_hash_string(key) % capacity;
-  uint32_t a = zynk_len(key, END_CHAR);
-  uint32_t limit=index;
-  for (;;) {
-    ZynkEnvEntry *entry= env->local->entries[index];
-    if (entry==NULL) {
-      return NULL;
-    } else if ((entry->name==NULL && niu) || (a==zynk_len(entry->name, END_CHAR) && zynk_strcmp(entry->name, key, a))) {
-      return entry;
+  if (entry>=table->entries && entry<table->entries+table->capacity) {
+    set_ctrl(table->ctrl, table->capacity, (size_t)(entry-table->entries), ZYNK_CTRL_DELETED);
+    table->deleted++;
+  } else {
+    set_ctrl(table->old_ctrl, table->old_capacity, (size_t)(entry-table->old_entries), ZYNK_CTRL_DELETED);
+    table->old_count--;
+  }
+  table->count--;
+  restamp(table);
+  return true;
+}
+
+bool zynkTableDelete(ZynkEnv *env, const char *str, ArenaManager *manager) {
+  if (env==NULL || str==NULL || !ready(env->local)) {
+    return false;
+  }
+  uint32_t len=zynk_len(str, END_CHAR);
+  return remove_key(manager, env->local, str, len, zynk_hash_bytes(str, len), false);
+}
+// Nearest env holding the key, the hash is the same for every table.
+// Levels whose bloom filter rules the key out aren't searched.
+static ZynkEnvEntry *lookup_chain(ZynkEnv *env, const char *key, uint32_t len, uint32_t hash, uint32_t *depth, ZynkEnvTable **holder) {
+  STAT(stats.lookups++);
+  for (uint32_t d=0;env!=NULL;env=env->enclosing, d++) {
+    if (!ready(env->local)) continue;
+    if (!may_hold(env->local, hash)) {
+      STAT(stats.skipped++);
+      continue;
     }
-    index = (index+1) % capacity;
-    if (index==limit) {
-      return NULL;
+    STAT(stats.probed++);
+    ZynkEnvEntry *entry=lookup(env->local, key, len, hash, NULL, false);
+    if (entry!=NULL) {
+      STAT(stats.depths[d<ZYNK_ENV_STATS_DEPTHS ? d : ZYNK_ENV_STATS_DEPTHS-1]++);
+      if (depth!=NULL) *depth=d;
+      if (holder!=NULL) *holder=env->local;
+      return entry;
     }
+    STAT(stats.false_positives++);
   }
-  if (env->enclosing==NULL) {
+  STAT(stats.misses++);
+  return NULL;
+}
+
+ZynkEnvEntry *zynkFindEntry(ZynkEnv *env, const char *key) {
+  if (env==NULL || key==NULL) {
     return NULL;
   }
-  return zynkFindEntry(env->enclosing, key, false);
+  uint32_t len=zynk_len(key, END_CHAR);
+  return lookup_chain(env, key, len, zynk_hash_bytes(key, len), NULL, NULL);
+}
+
+bool zynkEnvResolve(ZynkEnv *env, const char *name, ZynkEnvAddr *addr) {
+  if (env==NULL || name==NULL || addr==NULL) {
+    return false;
+  }
+  uint32_t len=zynk_len(name, END_CHAR);
+  uint32_t depth;
+  ZynkEnvTable *table;
+  ZynkEnvEntry *entry=lookup_chain(env, name, len, zynk_hash_bytes(name, len), &depth, &table);
+  if (entry==NULL || persistent(table)) {
+    return false; // persistent tables have no slots
+  }
+  addr->depth=depth;
+  if (table->frozen!=NULL) {
+    addr->slot=(uint32_t)(entry-table->frozen->entries);
+  } else if (entry>=table->entries && entry<table->entries+table->capacity) {
+    addr->slot=(uint32_t)(entry-table->entries);
+  } else {
+    addr->slot=(uint32_t)(table->capacity+(size_t)(entry-table->old_entries));
+  }
+  addr->layout=table->layout;
+  return true;
+}
+
+static inline ZynkEnvEntry *entry_at(ZynkEnv *env, ZynkEnvAddr addr) {
+  for (uint32_t d=0;d<addr.depth && env!=NULL;d++) env=env->enclosing;
+  if (env==NULL || env->local==NULL || env->local->layout!=addr.layout) {
+    return NULL;
+  }
+  ZynkEnvTable *table=env->local;
+  if (table->frozen!=NULL) {
+    return addr.slot<table->frozen->count ? &table->frozen->entries[addr.slot] : NULL;
+  }
+  if (addr.slot<table->capacity) {
+    return (table->ctrl[addr.slot] & 0x80) ? NULL : &table->entries[addr.slot];
+  }
+  size_t slot=addr.slot-table->capacity;
+  if (table->old_ctrl==NULL || slot>=table->old_capacity || (table->old_ctrl[slot] & 0x80)) {
+    return NULL;
+  }
+  return &table->old_entries[slot];
+}
+
+Value zynkEnvGetAt(ZynkEnv *env, ZynkEnvAddr addr) {
+  ZynkEnvEntry *entry=entry_at(env, addr);
+  return entry==NULL ? zynkNull() : entry->value;
+}
+
+bool zynkEnvSetAt(ArenaManager *manager, ZynkEnv *env, ZynkEnvAddr addr, Value value) {
+  ZynkEnvEntry *entry=entry_at(env, addr);
+  if (entry==NULL) {
+    return false;
+  }
+  zynk_retain(value);
+  zynk_release(entry->value, manager);
+  entry->value=value;
+  return true;
+}
+
+void zynkLookupCacheInit(ZynkLookupCache *cache) {
+  if (cache==NULL) return;
+  cache->env=NULL;
+  cache->table=NULL;
+  cache->entry=NULL;
+  cache->depth=0;
+  cache->version=0;
+  cache->shadow=0;
+}
+
+// versions only go up, and a table swapped into the chain comes in above
+// the one it replaces, so the sum changes whenever one of them does
+static inline uint32_t shadow_sum(ZynkEnv *env, uint32_t depth) {
+  uint32_t sum=0;
+  for (uint32_t d=0;d<depth;d++, env=env->enclosing) {
+    if (env->local!=NULL) sum+=env->local->version;
+  }
+  return sum;
+}
+
+// The table cached may have been freed since (a popped frame), so it is
+// only looked at once the chain leads to it again.
+static inline bool cache_valid(ZynkEnv *env, ZynkLookupCache *cache) {
+  uint32_t sum=0;
+  for (uint32_t d=0;d<cache->depth;d++, env=env->enclosing) {
+    if (env==NULL) return false;
+    if (env->local!=NULL) sum+=env->local->version;
+  }
+  return env!=NULL && env->local==cache->table && cache->table->version==cache->version && sum==cache->shadow;
+}
+
+ZynkEnvEntry *zynkFindEntryCached(ZynkEnv *env, const char *name, ZynkLookupCache *cache) {
+  if (env!=NULL && cache->env==env && cache_valid(env, cache)) {
+    return cache->entry;
+  }
+  if (env==NULL || name==NULL) {
+    return NULL;
+  }
+  uint32_t len=zynk_len(name, END_CHAR);
+  uint32_t depth;
+  ZynkEnvTable *holder;
+  ZynkEnvEntry *entry=lookup_chain(env, name, len, zynk_hash_bytes(name, len), &depth, &holder);
+  if (entry==NULL) {
+    cache->env=NULL; // misses aren't cached
+    return NULL;
+  }
+  cache->table=holder; // SetCached writes through it even when it isn't kept
+  if (holder->rcu!=NULL) {
+    cache->env=NULL; // nor entries another thread may retire
+    return entry;
+  }
+  cache->env=env;
+  cache->entry=entry;
+  cache->depth=depth;
+  cache->version=holder->version;
+  cache->shadow=shadow_sum(env, depth);
+  return entry;
+}
+
+Value zynkTableGetCached(ZynkEnv *env, const char *name, ZynkLookupCache *cache) {
+  if (cache==NULL) {
+    return zynkTableGet(env, name);
+  }
+  ZynkEnvEntry *entry=zynkFindEntryCached(env, name, cache);
+  return entry==NULL ? zynkNull() : entry->value;
+}
+
+bool zynkTableSetCached(ArenaManager *manager, ZynkEnv *env, const char *name, Value value, ZynkLookupCache *cache) {
+  if (cache==NULL) {
+    return zynkTableSet(manager, env, name, value);
+  }
+  ZynkEnvEntry *entry=zynkFindEntryCached(env, name, cache);
+  if (entry==NULL) {
+    return false;
+  }
+  return set_entry(manager, cache->table, entry, value);
+}
+
+// hashes a chunk of names and prefetches the first group and entry each
+// one will probe in `table`
+static void hash_chunk(ZynkEnvTable *table, const char *const *names, size_t count, uint32_t *lens, uint32_t *hashes) {
+  for (size_t i=0;i<count;i++) {
+    if (names[i]==NULL) continue;
+    lens[i]=zynk_len(names[i], END_CHAR);
+    hashes[i]=zynk_hash_bytes(names[i], lens[i]);
+    if (table!=NULL && table->capacity!=0) {
+      size_t pos=H1(hashes[i]) & (table->capacity-1);
+      zynk_prefetch(table->ctrl+pos);
+      zynk_prefetch(&table->entries[pos]);
+    }
+  }
+}
+
+void zynkTableGetMany(ZynkEnv *env, const char *const *names, size_t count, Value *out) {
+  if (names==NULL || out==NULL) {
+    return;
+  }
+  uint32_t lens[MANY_CHUNK];
+  uint32_t hashes[MANY_CHUNK];
+  for (size_t base=0;base<count;base+=MANY_CHUNK) {
+    size_t n=count-base<MANY_CHUNK ? count-base : MANY_CHUNK;
+    hash_chunk(env==NULL ? NULL : env->local, names+base, n, lens, hashes);
+    for (size_t i=0;i<n;i++) {
+      ZynkEnvEntry *entry=NULL;
+      if (names[base+i]!=NULL) entry=lookup_chain(env, names[base+i], lens[i], hashes[i], NULL, NULL);
+      out[base+i]=entry==NULL ? zynkNull() : entry->value;
+    }
+  }
+}
+
+size_t zynkTableSetMany(ArenaManager *manager, ZynkEnv *env, const char *const *names, const Value *values, size_t count) {
+  if (env==NULL || !ready(env->local) || names==NULL || values==NULL) {
+    return 0;
+  }
+  uint32_t lens[MANY_CHUNK];
+  uint32_t hashes[MANY_CHUNK];
+  size_t done=0;
+  for (size_t base=0;base<count;base+=MANY_CHUNK) {
+    size_t n=count-base<MANY_CHUNK ? count-base : MANY_CHUNK;
+    rehash_step(manager, env->local, TABLE_REHASH_STEP*n);
+    hash_chunk(env->local, names+base, n, lens, hashes);
+    for (size_t i=0;i<n;i++) {
+      if (names[base+i]==NULL) continue;
+      ZynkEnvTable *holder;
+      ZynkEnvEntry *entry=lookup_chain(env, names[base+i], lens[i], hashes[i], NULL, &holder);
+      if (entry!=NULL && set_entry(manager, holder, entry, values[base+i])) done++;
+    }
+  }
+  return done;
 }
+
+size_t zynkTableNewMany(ZynkEnv *env, const char *const *names, const Value *values, size_t count, ArenaManager *manager) {
+  if (env==NULL || !ready(env->local) || names==NULL || values==NULL || count==0) {
+    return 0;
+  }
+  if (persistent(env->local)) { // leaves hold their own copy of the name
+    size_t done=0;
+    for (size_t i=0;i<count;i++) {
+      if (names[i]!=NULL && zynkTableNew(env, names[i], values[i], manager)) done++;
+    }
+    return done;
+  }
+  size_t size=sizeof(NameBlock);
+  for (size_t i=0;i<count;i++) {
+    if (names[i]!=NULL) size+=sizeof(uint32_t)+zynk_len(names[i], END_CHAR)+1;
+  }
+  if (size>UINT32_MAX) {
+    return 0;
+  }
+  NameBlock *block=(NameBlock *)sysarena_alloc(manager, size);
+  if (block==NULL) {
+    return 0;
+  }
+  block->refs=0;
+  uint32_t offset=sizeof(NameBlock);
+  uint32_t lens[MANY_CHUNK];
+  uint32_t hashes[MANY_CHUNK];
+  for (size_t base=0;base<count;base+=MANY_CHUNK) {
+    size_t n=count-base<MANY_CHUNK ? count-base : MANY_CHUNK;
+    hash_chunk(env->local, names+base, n, lens, hashes);
+    for (size_t i=0;i<n;i++) {
+      const char *key=names[base+i];
+      if (key==NULL) continue;
+      uint32_t name_at=offset+sizeof(uint32_t);
+      char *name=(char *)block+name_at;
+      zynk_cpy((uint8_t *)block+offset, (const uint8_t *)&name_at, sizeof(uint32_t));
+      zynk_cpy((uint8_t *)name, (const uint8_t *)key, lens[i]+1);
+      offset=name_at+lens[i]+1;
+      if (insert(manager, env->local, key, lens[i], hashes[i], values[base+i], name, ZYNK_NAME_BATCHED)) {
+        block->refs++;
+      }
+    }
+  }
+  size_t done=block->refs;
+  if (done==0) {
+    sysarena_free(manager, block);
+  }
+  return done;
+}
+
+// like lookup_chain, for an atom
+static ZynkEnvEntry *lookup_atom(ZynkEnv *env, const ZynkAtomInfo *info, ZynkEnvTable **holder) {
+  STAT(stats.lookups++);
+  for (uint32_t d=0;env!=NULL;env=env->enclosing, d++) {
+    if (!ready(env->local)) continue;
+    if (!may_hold(env->local, info->hash)) {
+      STAT(stats.skipped++);
+      continue;
+    }
+    STAT(stats.probed++);
+    ZynkEnvEntry *entry=lookup(env->local, info->name, info->len, info->hash, NULL, true);
+    if (entry!=NULL) {
+      STAT(stats.depths[d<ZYNK_ENV_STATS_DEPTHS ? d : ZYNK_ENV_STATS_DEPTHS-1]++);
+      if (holder!=NULL) *holder=env->local;
+      return entry;
+    }
+    STAT(stats.false_positives++);
+  }
+  STAT(stats.misses++);
+  return NULL;
+}
+
+Value zynkTableGetAtom(ZynkEnv *env, ZynkAtom atom) {
+  const ZynkAtomInfo *info=zynk_atom_info(atom);
+  if (env==NULL || info==NULL) {
+    return zynkNull();
+  }
+  ZynkEnvEntry *entry=lookup_atom(env, info, NULL);
+  return entry==NULL ? zynkNull() : entry->value;
+}
+
+bool zynkTableSetAtom(ArenaManager *manager, ZynkEnv *env, ZynkAtom atom, Value value) {
+  const ZynkAtomInfo *info=zynk_atom_info(atom);
+  if (env==NULL || info==NULL || !ready(env->local)) {
+    return false;
+  }
+  rehash_step(manager, env->local, TABLE_REHASH_STEP);
+  ZynkEnvTable *holder;
+  ZynkEnvEntry *entry=lookup_atom(env, info, &holder);
+  if (entry==NULL) {
+    return false;
+  }
+  return set_entry(manager, holder, entry, value);
+}
+
+bool zynkTableNewAtom(ZynkEnv *env, ZynkAtom atom, Value value, ArenaManager *manager) {
+  const ZynkAtomInfo *info=zynk_atom_info(atom);
+  if (env==NULL || info==NULL || !ready(env->local)) {
+    return false;
+  }
+  return insert(manager, env->local, info->name, info->len, info->hash, value, (char *)info->name, ZYNK_NAME_ATOM);
+}
+
+bool zynkTableDeleteAtom(ZynkEnv *env, ZynkAtom atom, ArenaManager *manager) {
+  const ZynkAtomInfo *info=zynk_atom_info(atom);
+  if (env==NULL || info==NULL || !ready(env->local)) {
+    return false;
+  }
+  return remove_key(manager, env->local, info->name, info->len, info->hash, true);
+}
+
+bool zynkFramePoolInit(ZynkFramePool *pool, ArenaManager *manager, size_t capacity, uint32_t max_idle) {
+  if (pool==NULL || manager==NULL || max_idle==0) {
+    return false;
+  }
+  pool->tables=(ZynkEnvTable **)sysarena_alloc(manager, sizeof(ZynkEnvTable *)*max_idle);
+  if (pool->tables==NULL) {
+    return false;
+  }
+  size_t slots=ZYNK_ENV_GROUP;
+  while (slots<capacity) slots<<=1;
+  pool->manager=manager;
+  pool->len=0;
+  pool->max=max_idle;
+  pool->capacity=slots;
+  return true;
+}
+
+bool zynkFramePush(ZynkFramePool *pool, ZynkEnv *env, ZynkEnv *enclosing) {
+  if (pool==NULL || env==NULL) {
+    return false;
+  }
+  ZynkEnvTable *table;
+  if (pool->len>0) {
+    table=pool->tables[--pool->len];
+    restamp(table); // above the frame it may replace in a cached chain
+  } else {
+    table=(ZynkEnvTable *)sysarena_alloc(pool->manager, sizeof(ZynkEnvTable));
+    if (table==NULL || !initZynkTable(table, pool->capacity, pool->manager)) {
+      if (table!=NULL) sysarena_free(pool->manager, table);
+      return false;
+    }
+    // without room for the names they get their own allocations
+    uint32_t size=(uint32_t)(pool->capacity*FRAME_NAME_BYTES);
+    table->names=(char *)sysarena_alloc(pool->manager, size);
+    table->names_size=table->names==NULL ? 0 : size;
+  }
+  env->local=table;
+  env->enclosing=enclosing;
+  return true;
+}
+
+// Drops the entries in one pass: only objects are released, names in the
+// frame buffer need nothing. layout and version take a new stamp, so
+// addresses and caches taken in the previous frame stay stale.
+static void clear_frame(ArenaManager *manager, ZynkEnvTable *table) {
+  if (table->old_ctrl!=NULL) {
+    free_slots(manager, table->old_ctrl, table->old_entries, table->old_capacity);
+    table->old_ctrl=NULL;
+    table->old_entries=NULL;
+    table->old_capacity=0;
+    table->old_count=0;
+    table->migrated=0;
+  }
+  if (table->count!=0 || table->deleted!=0) {
+    for (size_t pos=0;pos<table->capacity;pos+=ZYNK_ENV_GROUP) {
+      uint32_t full=~group_free(table->ctrl+pos) & 0xFFFF;
+      for (;full!=0;full&=full-1) {
+        ZynkEnvEntry *entry=&table->entries[pos+zynk_ctz(full)];
+        if (entry->value.type==ZYNK_OBJ) zynk_release(entry->value, manager);
+        free_name(manager, entry);
+      }
+    }
+    for (size_t i=0;i<table->capacity+ZYNK_ENV_GROUP;i++) table->ctrl[i]=ZYNK_CTRL_EMPTY;
+  }
+  table->count=0;
+  table->deleted=0;
+  table->bloom=0;
+  table->names_used=0;
+  restamp(table);
+}
+
+void zynkFramePop(ZynkFramePool *pool, ZynkEnv *env) {
+  if (pool==NULL || env==NULL || env->local==NULL) {
+    return;
+  }
+  ZynkEnvTable *table=env->local;
+  env->local=NULL;
+  if (pool->len==pool->max || table->frozen!=NULL) {
+    freeZynkTable(pool->manager, table);
+    return;
+  }
+  clear_frame(pool->manager, table);
+  pool->tables[pool->len++]=table;
+}
+
+void zynkFramePoolFree(ZynkFramePool *pool) {
+  if (pool==NULL || pool->tables==NULL) {
+    return;
+  }
+  while (pool->len>0) {
+    freeZynkTable(pool->manager, pool->tables[--pool->len]);
+  }
+  sysarena_free(pool->manager, pool->tables);
+  pool->tables=NULL;
+  pool->max=0;
+}
+
+bool zynkEnvGetStats(ZynkEnvStats *out) {
+#ifdef ZYNK_ENV_STATS
+  if (out==NULL) {
+    return false;
+  }
+  *out=stats;
+  return true;
+#else
+  (void)out;
+  return false;
+#endif
+}
+
+void zynkEnvResetStats(void) {
+#ifdef ZYNK_ENV_STATS
+  stats=(ZynkEnvStats){0};
+#endif
+}
+
+#undef H1
+#undef H2
+#undef NO_SLOT
+#undef MANY_CHUNK
+#undef BLOOM_BITS
+#undef STAT
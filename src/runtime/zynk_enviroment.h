@@ -14,16 +14,64 @@
 #include "realloc.h"
 #include "object_rf.h"
 #include "object_mng.h"
+#include "atom.h"
+
+// Swiss table: entries live inline in one array and a parallel array of
+// control bytes says what each slot holds. A full slot stores the low 7
+// bits of the key hash, so a probe compares 16 control bytes at once and
+// only reads the entries whose fragment matches. Misses never touch them.
+#define ZYNK_ENV_GROUP 16
+#define ZYNK_CTRL_EMPTY 0x80
+#define ZYNK_CTRL_DELETED 0xFE // tombstone
+
+// who owns the name of an entry
+#define ZYNK_NAME_COPY 0 // its own allocation
+#define ZYNK_NAME_BATCHED 1 // a block shared with others (zynkTableNewMany)
+#define ZYNK_NAME_ATOM 2 // the atom table, it's the interned name (atom.h)
+#define ZYNK_NAME_BUFFER 3 // the name buffer of the table (frame and frozen tables)
 
 struct ZynkEnvEntry {
   char *name;
+  uint32_t hash; // zynk_hash_bytes(name, len)
+  uint32_t len : 30;
+  uint32_t owner : 2; // ZYNK_NAME_*
   Value value; 
 };
 
+// Past TABLE_MAX_LOAD (common.h) zynkTableNew moves the slots to new arrays,
+// twice as big unless most of the load was tombstones. The move is
+// incremental: every New/Set/Delete carries TABLE_REHASH_STEP old slots
+// over, and until the old arrays are empty lookups search both.
 struct ZynkEnvTable {
-  struct ZynkEnvEntry** entries;
-  size_t capacity;
-  size_t count;
+  uint8_t *ctrl; // capacity+ZYNK_ENV_GROUP bytes, the tail mirrors the first group
+  struct ZynkEnvEntry *entries;
+  size_t capacity; // power of two, at least ZYNK_ENV_GROUP
+  size_t count; // live entries, old ones included
+  size_t deleted; // tombstones in ctrl
+  uint8_t *old_ctrl; // arrays being emptied by a rehash, NULL otherwise
+  struct ZynkEnvEntry *old_entries;
+  size_t old_capacity;
+  size_t old_count; // live entries still in them
+  size_t migrated; // next old slot to move
+  uint32_t layout; // new process-wide stamp whenever an entry moves or goes away
+  uint32_t version; // same, and on zynkTableNew too
+  ZynkHamtNode *root; // persistent table (see hamt.h) if not NULL, the arrays are unused then
+  ZynkRcu *rcu; // concurrent table (see rcu.h) if not NULL, root is then only the writers'
+  ZynkFrozen *frozen; // frozen table (see frozen.h) if not NULL, the arrays are unused then
+  uint64_t bloom; // 2 bits per key ever added, lookups skip the table if one is clear
+  char *names; // frame and frozen tables: buffer for the names of their entries, NULL otherwise
+  uint32_t names_used;
+  uint32_t names_size;
+};
+
+// Recycles frame tables (zynkFramePush/Pop) so a call doesn't allocate:
+// a popped table keeps its arrays and name buffer for the next push.
+struct ZynkFramePool {
+  ArenaManager *manager;
+  ZynkEnvTable **tables; // idle tables, a stack
+  uint32_t len;
+  uint32_t max; // idle tables kept, the rest are freed
+  size_t capacity; // slots of new frame tables
 };
 
 struct ZynkEnv {
@@ -31,13 +79,100 @@ struct ZynkEnv {
   struct ZynkEnv *enclosing; 
 };
 
+// Where a name lives, resolved once by zynkEnvResolve so GetAt/SetAt can
+// skip the hashing. It stays valid until that table moves or deletes
+// entries (a rehash or zynkTableDelete), after which GetAt returns null
+// and SetAt false and the name has to be resolved again.
+struct ZynkEnvAddr {
+  uint32_t depth; // enclosing envs to walk up
+  uint32_t slot; // from capacity on, a slot of the arrays being rehashed
+  uint32_t layout;
+};
+
+// Per call site cache of a name lookup. It keeps the entry found and the
+// version of its table, plus the sum of the versions of the tables in
+// front of it (a new name there would shadow it). While the chain still
+// leads to that table and they match, a lookup is a short walk and a few
+// compares. Use one cache per name.
+struct ZynkLookupCache {
+  ZynkEnv *env; // NULL while empty
+  ZynkEnvTable *table; // holding the entry
+  ZynkEnvEntry *entry;
+  uint32_t depth;
+  uint32_t version;
+  uint32_t shadow;
+};
+
 bool zynkEnvInit(ZynkEnv *env, size_t capacity, ZynkEnv *enclosing, ArenaManager *manager);
+// zynkEnvInit allocates env->local when it is NULL, initZynkTable allocates
+// the slots (capacity is rounded up to a power of two)
 bool initZynkTable(ZynkEnvTable *table, size_t capacity, ArenaManager *manager);
+// Persistent env: same Get/Set/New/Delete, but the table is a HAMT, so
+// zynkEnvSnapshot is O(1) and updates copy O(log n) nodes, only the ones
+// still shared with a snapshot. (depth, slot) addresses
+// aren't available for them.
+bool zynkEnvInitPersistent(ZynkEnv *env, ZynkEnv *enclosing, ArenaManager *manager);
+bool zynkEnvSnapshot(ArenaManager *manager, ZynkEnv *env, ZynkEnv *snapshot);
+// Rebuilds a table whose names are all known (the globals, once the
+// natives are in) as a minimal perfect hash: one probe per lookup, never
+// more. Set works as before, New and Delete turn it back into a normal
+// table first. False if it can't be built, the table is left as it was.
+bool zynkEnvFreeze(ArenaManager *manager, ZynkEnv *env);
+// Persistent env shared by threads: Get never locks, writers publish new
+// roots atomically. Every access needs a read section (see rcu.h).
+bool zynkEnvInitConcurrent(ZynkEnv *env, ZynkEnv *enclosing, ArenaManager *manager);
 bool freeZynkTable(ArenaManager *manager, ZynkEnvTable *table);
+// Frame envs for calls: Push gives env a table from the pool (arrays of
+// `capacity` slots, grown as usual), Pop empties it in one pass and keeps
+// it for the next call. Pop every pushed frame before the pool is freed.
+bool zynkFramePoolInit(ZynkFramePool *pool, ArenaManager *manager, size_t capacity, uint32_t max_idle);
+bool zynkFramePush(ZynkFramePool *pool, ZynkEnv *env, ZynkEnv *enclosing);
+void zynkFramePop(ZynkFramePool *pool, ZynkEnv *env);
+void zynkFramePoolFree(ZynkFramePool *pool);
 bool zynkTableSet(ArenaManager *manager, ZynkEnv *env, const char *str, Value value);
 bool zynkTableNew(ZynkEnv *env, const char *str, Value value, ArenaManager *manager);
 Value zynkTableGet(ZynkEnv *env, const char *str);
 bool zynkTableDelete(ZynkEnv *env, const char *str, ArenaManager *manager);
-ZynkEnvEntry* zynkFindEntry(ZynkEnv *env, const char *key, bool niu);
+// Get/Set look the name up through the enclosing envs too, New/Delete
+// only touch the local table.
+// entry of the nearest env holding key, NULL if none does. New entries
+// only come from zynkTableNew, which fills in the control byte too.
+ZynkEnvEntry* zynkFindEntry(ZynkEnv *env, const char *key);
+bool zynkEnvResolve(ZynkEnv *env, const char *name, ZynkEnvAddr *addr);
+Value zynkEnvGetAt(ZynkEnv *env, ZynkEnvAddr addr);
+bool zynkEnvSetAt(ArenaManager *manager, ZynkEnv *env, ZynkEnvAddr addr, Value value);
+void zynkLookupCacheInit(ZynkLookupCache *cache);
+ZynkEnvEntry *zynkFindEntryCached(ZynkEnv *env, const char *name, ZynkLookupCache *cache);
+Value zynkTableGetCached(ZynkEnv *env, const char *name, ZynkLookupCache *cache);
+bool zynkTableSetCached(ArenaManager *manager, ZynkEnv *env, const char *name, Value value, ZynkLookupCache *cache);
+// Many names at once: every key is hashed and its slot prefetched before
+// any is looked up, so the cache misses overlap. NewMany copies all the
+// names into one allocation. Set/New return how many succeeded.
+void zynkTableGetMany(ZynkEnv *env, const char *const *names, size_t count, Value *out);
+size_t zynkTableSetMany(ArenaManager *manager, ZynkEnv *env, const char *const *names, const Value *values, size_t count);
+size_t zynkTableNewMany(ZynkEnv *env, const char *const *names, const Value *values, size_t count, ArenaManager *manager);
+// Same as Get/Set/New/Delete with an atom instead of a string: nothing is
+// hashed and NewAtom keeps the interned name instead of a copy, so entries
+// made by it are matched by comparing pointers.
+Value zynkTableGetAtom(ZynkEnv *env, ZynkAtom atom);
+bool zynkTableSetAtom(ArenaManager *manager, ZynkEnv *env, ZynkAtom atom, Value value);
+bool zynkTableNewAtom(ZynkEnv *env, ZynkAtom atom, Value value, ArenaManager *manager);
+bool zynkTableDeleteAtom(ZynkEnv *env, ZynkAtom atom, ArenaManager *manager);
+
+// Counters of the lookups through the scope chain (Get, Set, the cached,
+// Many and Atom calls). Only kept when built with ZYNK_ENV_STATS (see
+// common.h), they are process wide and not thread safe.
+#define ZYNK_ENV_STATS_DEPTHS 8
+typedef struct {
+  uint64_t lookups;
+  uint64_t misses; // not found at any level
+  uint64_t probed; // tables searched
+  uint64_t skipped; // tables the bloom filter ruled out without searching them
+  uint64_t false_positives; // tables searched that didn't have the name
+  uint64_t depths[ZYNK_ENV_STATS_DEPTHS]; // hits by depth, the last one counts the deeper too
+} ZynkEnvStats;
+
+bool zynkEnvGetStats(ZynkEnvStats *stats); // false without ZYNK_ENV_STATS
+void zynkEnvResetStats(void);
 
 #endif // ZYNK_ENVIROMENT
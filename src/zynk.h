@@ -6,6 +6,8 @@
 #include "runtime/types.h"
 #include "runtime/objects.h"
 #include "runtime/zynk_enviroment.h"
+#include "runtime/atom.h"
+#include "runtime/rcu.h"
 #include "runtime/memory.h"
 #include "runtime/assign.h"
 #include "runtime/object_mng.h"
@@ -13,5 +15,14 @@
 #include "runtime/realloc.h"
 #include "natives.h"
 #include "runtime/calls.h"
+#include "runtime/vm.h"
+#include "runtime/map.h"
+#include "runtime/buffer.h"
+#include "runtime/utf8.h"
+#include "runtime/search.h"
+#include "runtime/convert.h"
+#include "runtime/sort.h"
+#include "runtime/memo.h"
+#include "runtime/value_inline.h" // keep last
 
 #endif
@@ -0,0 +1,75 @@
+// Pruebas de la tabla de símbolos (atoms): intern, find y name, el
+// crecimiento de la tabla, las operaciones Atom de los entornos y la
+// numeración que vuelve a empezar tras zynkAtomsFree.
+// Compilar: gcc test-atom.c src/libzynk.a -o test-atom
+#include "test.h"
+
+#define N 1000
+
+int main() {
+    printf("--- Pruebas de atoms ---\n");
+    test_init(16 * 1024 * 1024, 8192);
+    char name[32];
+
+    section("intern, find y name");
+    ZynkAtom a = zynkAtomIntern(&manager, "alfa");
+    ZynkAtom b = zynkAtomIntern(&manager, "beta");
+    assert_true(a == 1 && b == 2, "los atoms se numeran desde 1 en orden");
+    assert_true(zynkAtomIntern(&manager, "alfa") == a, "el mismo nombre da el mismo atom");
+    assert_true(zynkAtomFind("beta") == b, "zynkAtomFind lo encuentra");
+    assert_true(zynkAtomFind("gamma") == ZYNK_ATOM_NONE, "un nombre nunca internado no tiene atom");
+    assert_true(zynkAtomName(a) != NULL && strcmp(zynkAtomName(a), "alfa") == 0, "zynkAtomName devuelve el nombre");
+    assert_true(zynkAtomName(ZYNK_ATOM_NONE) == NULL && zynkAtomName(99) == NULL, "atoms desconocidos dan NULL");
+    assert_true(zynkAtomIntern(&manager, NULL) == ZYNK_ATOM_NONE && zynkAtomIntern(NULL, "x") == ZYNK_ATOM_NONE,
+                "argumentos NULL");
+    assert_true(zynkAtomIntern(&manager, "") != ZYNK_ATOM_NONE, "el nombre vacío también es un atom");
+
+    section("muchos nombres");
+    bool ok = true;
+    uint32_t before = zynkAtomCount();
+    for (int i = 0; i < N; ++i) {
+        snprintf(name, sizeof(name), "sym%d", i);
+        ok = ok && zynkAtomIntern(&manager, name) == before + 1 + (uint32_t)i;
+    }
+    assert_true(ok && zynkAtomCount() == before + N, "1000 atoms seguidos tras varios crecimientos");
+    for (int i = 0; i < N; i += 7) {
+        snprintf(name, sizeof(name), "sym%d", i);
+        ZynkAtom atom = zynkAtomFind(name);
+        ok = ok && atom == before + 1 + (uint32_t)i && strcmp(zynkAtomName(atom), name) == 0;
+    }
+    assert_true(ok, "se siguen encontrando con su nombre");
+    assert_true(zynkAtomFind("alfa") == a, "y los primeros también");
+
+    section("entornos con atoms");
+    ZynkEnv *env = new_env(16);
+    assert_true(zynkTableNewAtom(env, a, zynkNumber(1), &manager), "zynkTableNewAtom");
+    assert_true(!zynkTableNewAtom(env, a, zynkNumber(2), &manager), "NewAtom rechaza un atom existente");
+    assert_equal_number(zynkTableGetAtom(env, a), 1, "zynkTableGetAtom");
+    assert_equal_number(zynkTableGet(env, "alfa"), 1, "la entrada se ve por su nombre");
+    ZynkEnvEntry *entry = zynkFindEntry(env, "alfa");
+    assert_true(entry != NULL && entry->owner == ZYNK_NAME_ATOM && entry->name == zynkAtomName(a),
+                "la entrada usa el nombre internado");
+    zynkTableNew(env, "beta", zynkNumber(20), &manager);
+    assert_equal_number(zynkTableGetAtom(env, b), 20, "GetAtom ve las entradas hechas con New");
+    assert_true(zynkTableSetAtom(&manager, env, b, zynkNumber(21)), "zynkTableSetAtom");
+    assert_equal_number(zynkTableGet(env, "beta"), 21, "el cambio se ve por el nombre");
+    ZynkEnv inner;
+    inner.local = NULL;
+    zynkEnvInit(&inner, 16, env, &manager);
+    assert_equal_number(zynkTableGetAtom(&inner, a), 1, "GetAtom busca en los entornos de fuera");
+    assert_true(zynkTableDeleteAtom(env, a, &manager), "zynkTableDeleteAtom");
+    assert_is_null(zynkTableGetAtom(&inner, a), "ya no está");
+    assert_true(!zynkTableSetAtom(&manager, env, a, zynkNumber(3)), "SetAtom de un atom ausente falla");
+
+    section("zynkAtomsFree");
+    freeZynkTable(&manager, inner.local);
+    freeZynkTable(&manager, env->local);
+    free(env);
+    zynkAtomsFree(&manager);
+    assert_true(zynkAtomCount() == 0 && zynkAtomFind("alfa") == ZYNK_ATOM_NONE, "suelta todos los atoms");
+    assert_true(zynkAtomName(a) == NULL, "los atoms de antes ya no tienen nombre");
+    assert_true(zynkAtomIntern(&manager, "otro") == 1, "la numeración vuelve a empezar en 1");
+    assert_true(strcmp(zynkAtomName(1), "otro") == 0, "y el 1 ahora es otro nombre");
+    zynkAtomsFree(&manager);
+    return test_end();
+}
@@ -0,0 +1,113 @@
+// Pruebas de los filtros bloom de la cadena de entornos: cada nombre pone
+// sus dos bits, las búsquedas dan lo mismo con o sin filtro, y las bajas,
+// los marcos reutilizados y las tablas congeladas dejan el filtro bien.
+// Con ZYNK_ENV_STATS (ver common.h) comprueba también los contadores.
+// Compilar: gcc test-bloom.c src/libzynk.a -o test-bloom
+#include "test.h"
+
+#define DEPTH 24
+
+// los dos bits que pone un nombre, como BLOOM_BITS
+static uint64_t bloom_bits(const char *name) {
+    uint32_t hash = zynk_hash_string(name);
+    return (1ull << (hash >> 26)) | (1ull << ((hash >> 20) & 63));
+}
+
+int main() {
+    printf("--- Pruebas de los filtros bloom ---\n");
+    test_init(16 * 1024 * 1024, 8192);
+    char name[32];
+
+    section("bits de cada nombre");
+    ZynkEnv *global = new_env(64);
+    assert_true(global->local->bloom == 0, "una tabla nueva empieza sin bits");
+    zynkTableNew(global, "print", zynkNumber(1), &manager);
+    assert_true((global->local->bloom & bloom_bits("print")) == bloom_bits("print"), "New pone los bits del nombre");
+    zynkTableDelete(global, "print", &manager);
+    assert_true((global->local->bloom & bloom_bits("print")) == bloom_bits("print"), "Delete los deja");
+    assert_is_null(zynkTableGet(global, "print"), "pero el nombre ya no está");
+    zynkTableNew(global, "print", zynkNumber(2), &manager);
+
+    section("cadena de marcos");
+    ZynkFramePool pool;
+    zynkFramePoolInit(&pool, &manager, 16, DEPTH);
+    ZynkEnv frames[DEPTH];
+    ZynkEnv *enclosing = global;
+    for (int d = 0; d < DEPTH; ++d) {
+        zynkFramePush(&pool, &frames[d], enclosing);
+        for (int j = 0; j < 3; ++j) {
+            snprintf(name, sizeof(name), "local_%d_%d", d, j);
+            zynkTableNew(&frames[d], name, zynkNumber(d * 10 + j), &manager);
+        }
+        enclosing = &frames[d];
+    }
+    ZynkEnv *deepest = &frames[DEPTH - 1];
+    // un nombre cuyos bits no están en ningún marco
+    int skip_all = -1;
+    for (int i = 0; i < 1000 && skip_all < 0; ++i) {
+        snprintf(name, sizeof(name), "nadie_%d", i);
+        bool everywhere_out = true;
+        for (int d = 0; d < DEPTH; ++d) everywhere_out = everywhere_out && (frames[d].local->bloom & bloom_bits(name)) != bloom_bits(name);
+        if (everywhere_out) skip_all = i;
+    }
+    assert_true(skip_all >= 0, "hay nombres que todos los filtros descartan");
+    zynkEnvResetStats();
+    assert_equal_number(zynkTableGet(deepest, "print"), 2, "el global desde 24 marcos");
+    assert_equal_number(zynkTableGet(deepest, "local_3_1"), 31, "un local de un marco intermedio");
+    assert_equal_number(zynkTableGet(deepest, "local_23_2"), 232, "uno del marco más interno");
+    assert_is_null(zynkTableGet(deepest, "no_existe"), "un nombre que no está en ninguno");
+    bool ok = true;
+    for (int d = 0; d < DEPTH; ++d) {
+        for (int j = 0; j < 3; ++j) {
+            snprintf(name, sizeof(name), "local_%d_%d", d, j);
+            Value v = zynkTableGet(deepest, name);
+            ok = ok && v.type == ZYNK_NUMBER && v.as.number == d * 10 + j;
+        }
+    }
+    assert_true(ok, "los 72 locales se encuentran");
+
+    ZynkEnvStats stats;
+    if (zynkEnvGetStats(&stats)) {
+        assert_true(stats.skipped > 0, "el filtro se salta tablas");
+        assert_true(stats.probed + stats.skipped >= DEPTH, "cada nivel se busca o se salta");
+        assert_true(stats.misses == 1, "una sola búsqueda fallida");
+        zynkEnvResetStats();
+        snprintf(name, sizeof(name), "nadie_%d", skip_all);
+        zynkTableGet(deepest, name);
+        zynkEnvGetStats(&stats);
+        assert_true(stats.skipped >= DEPTH && stats.false_positives <= 1, "un nombre descartado por todos no busca en ningún marco");
+    } else {
+        assert_true(!zynkEnvGetStats(&stats), "sin ZYNK_ENV_STATS no hay contadores");
+    }
+
+    section("marcos reutilizados");
+    for (int d = DEPTH - 1; d >= 0; --d) zynkFramePop(&pool, &frames[d]);
+    zynkFramePush(&pool, &frames[0], global);
+    assert_true(frames[0].local->bloom == 0, "un marco reutilizado empieza sin bits");
+    assert_equal_number(zynkTableGet(&frames[0], "print"), 2, "y deja pasar al global");
+    zynkFramePop(&pool, &frames[0]);
+
+    section("congelar y concurrentes");
+    zynkTableNew(global, "temporal", zynkNumber(0), &manager);
+    zynkTableDelete(global, "temporal", &manager);
+    zynkEnvFreeze(&manager, global);
+    uint64_t expected = bloom_bits("print");
+    assert_true(global->local->bloom == expected, "congelar recalcula el filtro sin los nombres borrados");
+    ZynkEnv concurrent;
+    concurrent.local = NULL;
+    zynkEnvInitConcurrent(&concurrent, global, &manager);
+    assert_true(concurrent.local->bloom == UINT64_MAX, "una tabla concurrente tiene todos los bits");
+    ZynkRcuReader *slot = zynkRcuRegister(&concurrent);
+    zynkRcuReadLock(slot);
+    zynkTableNew(&concurrent, "c", zynkNumber(1), &manager);
+    assert_true(concurrent.local->bloom == UINT64_MAX, "y New no lo toca");
+    assert_equal_number(zynkTableGet(&concurrent, "print"), 2, "busca en la concurrente y sigue al global");
+    zynkRcuReadUnlock(slot);
+    zynkRcuUnregister(slot);
+
+    freeZynkTable(&manager, concurrent.local);
+    zynkFramePoolFree(&pool);
+    freeZynkTable(&manager, global->local);
+    free(global);
+    return test_end();
+}
@@ -0,0 +1,76 @@
+// Pruebas de ObjBuffer: bytes, rebanadas sin copia y, con ZYNK_POSIX,
+// escritura con pwrite y lectura con pread y mmap.
+// Compilar: gcc test-buffer.c src/libzynk.a -o test-buffer
+#define _POSIX_C_SOURCE 200809L
+#include "test.h"
+#include <unistd.h>
+
+int main() {
+    printf("--- Pruebas de ObjBuffer ---\n");
+    test_init(8 * 1024 * 1024, 4096);
+
+    section("zynkBufferGet / zynkBufferSet");
+    Value buf = zynkCreateBuffer(&manager, 16);
+    ZynkBuffer *b = buf.as.obj->obj.buffer;
+    assert_true(b->len == 16, "zynkCreateBuffer: 16 bytes");
+    bool ok = true;
+    for (int i = 0; i < 16; ++i) ok = ok && zynkBufferSet(buf, zynkNumber(i), zynkNumber('a' + i));
+    assert_true(ok, "zynkBufferSet: acepta números");
+    assert_true(zynkBufferSet(buf, zynkNumber(0), zynkByte('A')), "zynkBufferSet: acepta bytes");
+    Value first = zynkBufferGet(buf, zynkNumber(0));
+    assert_true(first.type == ZYNK_BYTE && first.as.byte == 'A', "zynkBufferGet: devuelve un byte");
+    assert_is_null(zynkBufferGet(buf, zynkNumber(16)), "zynkBufferGet: fuera de rango da null");
+    assert_is_null(zynkBufferGet(buf, zynkNumber(-1)), "zynkBufferGet: índice negativo da null");
+    assert_true(!zynkBufferSet(buf, zynkNumber(16), zynkNumber(0)), "zynkBufferSet: fuera de rango falla");
+    assert_true(!zynkBufferSet(buf, zynkNumber(0), zynkNull()), "zynkBufferSet: un valor que no es byte falla");
+
+    section("zynkBufferSlice");
+    Value slice = zynkBufferSlice(&manager, buf, 4, 8);
+    ZynkBuffer *s = slice.as.obj->obj.buffer;
+    assert_true(s->len == 4 && s->data == b->data + 4, "la rebanada apunta dentro del buffer, sin copiar");
+    Value inner = zynkBufferSlice(&manager, slice, 1, 100);
+    ZynkBuffer *in = inner.as.obj->obj.buffer;
+    assert_true(in->len == 3 && in->parent == buf.as.obj, "una rebanada de rebanada apunta al dueño, el final se recorta");
+    zynkBufferSet(inner, zynkNumber(0), zynkNumber('Z'));
+    assert_true(b->data[5] == 'Z', "escribir en la rebanada cambia el buffer");
+    zynk_release(buf, &manager);
+    assert_true(in->data[0] == 'Z', "la rebanada mantiene vivo al dueño");
+    zynk_release(slice, &manager);
+
+    section("nativas buffer_*");
+    ZynkEnv *env = new_env(0);
+    init_native_funcs(&manager, env);
+    Value slice_args[] = {inner, zynkNumber(1)};
+    Value tail = call_native(env, "buffer_slice", 2, slice_args);
+    assert_true(tail.type == ZYNK_OBJ && tail.as.obj->obj.buffer->len == 2, "buffer_slice: sin end llega al final");
+    zynk_release(tail, &manager);
+    Value huge = zynkNumber(1e30);
+    assert_is_null(call_native(env, "buffer", 1, &huge), "buffer: un tamaño imposible da null");
+    Value get_args[] = {inner, zynkNumber(0)};
+    Value byte = call_native(env, "get_index", 2, get_args);
+    assert_true(byte.type == ZYNK_BYTE && byte.as.byte == 'Z', "get_index: lee un byte del buffer");
+    assert_equal_number(call_native(env, "len", 1, &inner), 3, "len: bytes del buffer");
+
+#ifdef ZYNK_POSIX
+    section("zynkBufferWriteFile / ReadFile / MapFile");
+    char path[] = "/tmp/zynk-test-bufferXXXXXX";
+    int fd = mkstemp(path);
+    assert_true(fd >= 0, "archivo temporal creado");
+    if (fd >= 0) close(fd);
+    assert_true(zynkBufferWriteFile(inner, path, 2) == 3, "zynkBufferWriteFile: escribe 3 bytes en el desplazamiento 2");
+    Value read = zynkBufferReadFile(&manager, path, 2, 10);
+    assert_true(read.type == ZYNK_OBJ && read.as.obj->obj.buffer->len == 3 &&
+                memcmp(read.as.obj->obj.buffer->data, in->data, 3) == 0, "zynkBufferReadFile: lee hasta el final del archivo");
+    Value mapped = zynkBufferMapFile(&manager, path);
+    ZynkBuffer *m = mapped.type == ZYNK_OBJ ? mapped.as.obj->obj.buffer : NULL;
+    assert_true(m != NULL && m->len == 5 && m->data[2] == 'Z', "zynkBufferMapFile: mapea el archivo entero");
+    assert_true(m != NULL && !zynkBufferSet(mapped, zynkNumber(0), zynkNumber(1)), "zynkBufferSet: un archivo mapeado es de solo lectura");
+    assert_is_null(zynkBufferMapFile(&manager, "/tmp/zynk-no-existe/archivo"), "zynkBufferMapFile: archivo inexistente da null");
+    zynk_release(read, &manager);
+    zynk_release(mapped, &manager);
+    unlink(path);
+#endif
+
+    zynk_release(inner, &manager);
+    return test_end();
+}
@@ -0,0 +1,72 @@
+// Pruebas de las cachés de búsqueda por sitio de llamada: aciertan mientras
+// nada cambia y se invalidan cuando un nombre nuevo tapa al guardado, cuando
+// se borra o cuando la tabla se reorganiza.
+// Compilar: gcc test-cache.c src/libzynk.a -o test-cache
+#include "test.h"
+
+int main() {
+    printf("--- Pruebas de las cachés de búsqueda ---\n");
+    test_init(16 * 1024 * 1024, 8192);
+
+    ZynkEnv *global = new_env(64);
+    zynkTableNew(global, "x", zynkNumber(100), &manager);
+    ZynkEnv mid, inner;
+    mid.local = NULL;
+    inner.local = NULL;
+    zynkEnvInit(&mid, 16, global, &manager);
+    zynkEnvInit(&inner, 16, &mid, &manager);
+
+    section("aciertos");
+    ZynkLookupCache cache;
+    zynkLookupCacheInit(&cache);
+    assert_equal_number(zynkTableGetCached(&inner, "x", &cache), 100, "primera búsqueda, dos niveles arriba");
+    assert_true(cache.env == &inner && cache.depth == 2, "la caché guarda entorno y profundidad");
+    ZynkEnvEntry *cached = cache.entry;
+    assert_true(zynkFindEntryCached(&inner, "x", &cache) == cached, "la segunda sale de la caché");
+    zynkTableSet(&manager, global, "x", zynkNumber(101));
+    assert_equal_number(zynkTableGetCached(&inner, "x", &cache), 101, "un Set no invalida y se ve el valor nuevo");
+    assert_true(zynkTableSetCached(&manager, &inner, "x", zynkNumber(102), &cache), "zynkTableSetCached");
+    assert_equal_number(zynkTableGet(global, "x"), 102, "escribe en la tabla que tiene el nombre");
+
+    section("invalidación");
+    zynkTableNew(&mid, "x", zynkNumber(5), &manager);
+    assert_equal_number(zynkTableGetCached(&inner, "x", &cache), 5, "un nombre nuevo en medio tapa al guardado");
+    zynkTableDelete(&mid, "x", &manager);
+    assert_equal_number(zynkTableGetCached(&inner, "x", &cache), 102, "borrarlo vuelve al global");
+    zynkTableNew(&inner, "x", zynkNumber(7), &manager);
+    assert_equal_number(zynkTableGetCached(&inner, "x", &cache), 7, "un nombre nuevo en el local también");
+    zynkTableDelete(&inner, "x", &manager);
+    zynkTableDelete(global, "x", &manager);
+    assert_is_null(zynkTableGetCached(&inner, "x", &cache), "borrado en todas partes da null");
+    assert_true(!zynkTableSetCached(&manager, &inner, "x", zynkNumber(1), &cache), "y SetCached falla");
+    zynkTableNew(global, "x", zynkNumber(200), &manager);
+    assert_equal_number(zynkTableGetCached(&inner, "x", &cache), 200, "los fallos no se guardan");
+
+    ZynkLookupCache other;
+    zynkLookupCacheInit(&other);
+    zynkTableGetCached(&mid, "x", &other);
+    assert_equal_number(zynkTableGetCached(&inner, "x", &other), 200, "la caché de otro entorno no se usa");
+    assert_true(other.env == &inner, "y se rellena para el nuevo");
+
+    section("rehash");
+    char name[32];
+    for (int i = 0; global->local->old_ctrl == NULL; ++i) {
+        snprintf(name, sizeof(name), "g%d", i);
+        zynkTableNew(global, name, zynkNumber(i), &manager);
+    }
+    // terminar el rehash para que la entrada cambie de sitio
+    for (int i = 0; i < 100000 && global->local->old_ctrl != NULL; ++i) zynkTableSet(&manager, global, "g0", zynkNumber(0));
+    assert_equal_number(zynkTableGetCached(&inner, "x", &cache), 200, "tras un rehash la caché vuelve a buscar");
+    assert_true(zynkTableSetCached(&manager, &inner, "x", zynkNumber(201), &cache) &&
+                zynkTableGet(global, "x").as.number == 201, "y escribe en la entrada movida");
+
+    section("zynkLookupCacheInit");
+    zynkLookupCacheInit(&cache);
+    assert_true(cache.env == NULL && cache.entry == NULL, "deja la caché vacía");
+
+    freeZynkTable(&manager, inner.local);
+    freeZynkTable(&manager, mid.local);
+    freeZynkTable(&manager, global->local);
+    free(global);
+    return test_end();
+}
@@ -0,0 +1,101 @@
+// Pruebas de las llamadas sin array de argumentos (zynkCallValue,
+// zynkCallCached): el nativo ve argv tal cual, nada se retiene ni se
+// reserva, los nativos aguantan argv cortos, y las llamadas por nombre
+// siguen a la caché del sitio.
+// Compilar: gcc test-calls.c src/libzynk.a -o test-calls
+#include "test.h"
+
+static ZynkArray *seen;
+static Value *seen_array;
+static uint32_t seen_len;
+
+// suma sus argumentos y guarda cómo los vio
+static Value sum(ArenaManager *m, ZynkEnv *env, ZynkArray *args) {
+    (void)m; (void)env;
+    seen = args;
+    seen_array = args->array;
+    seen_len = args->len;
+    double total = 0;
+    for (uint32_t i = 0; i < args->len; ++i) {
+        if (args->array[i].type == ZYNK_NUMBER) total += args->array[i].as.number;
+    }
+    return zynkNumber(total);
+}
+
+static Value other(ArenaManager *m, ZynkEnv *env, ZynkArray *args) {
+    (void)m; (void)env; (void)args;
+    return zynkNumber(-1);
+}
+
+int main() {
+    printf("--- Pruebas de llamadas ---\n");
+    test_init(16 * 1024 * 1024, 8192);
+
+    ZynkEnv *global = new_env(64);
+    init_native_funcs(&manager, global);
+    Value sum_fn = zynkCreateNativeFunction(&manager, "__sum__", sum);
+    zynkTableNew(global, "sum", sum_fn, &manager);
+
+    section("zynkCallValue");
+    Value argv[3] = {zynkNumber(1), zynkNumber(2), zynkNumber(3)};
+    assert_equal_number(zynkCallValue(&manager, global, sum_fn, 3, argv), 6, "suma tres argumentos");
+    assert_true(seen_array == argv && seen_len == 3, "el nativo lee argv directamente");
+    assert_true(seen->shared == NULL, "la vista no comparte nada");
+    assert_equal_number(zynkCallValue(&manager, global, sum_fn, 0, NULL), 0, "sin argumentos");
+    assert_is_null(zynkCallValue(&manager, global, sum_fn, 2, NULL), "argv NULL con argc > 0 da null");
+    assert_is_null(zynkCallValue(&manager, global, zynkNumber(1), 0, NULL), "llamar a algo que no es función da null");
+    Value str = zynkCreateString(&manager, "prestado");
+    uint32_t refs = str.as.obj->ref_count;
+    Value one[1] = {str};
+    assert_equal_number(zynkCallValue(&manager, global, zynkTableGet(global, "len"), 1, one), 8, "un nativo de la biblioteca");
+    assert_true(str.as.obj->ref_count == refs, "los argumentos no se retienen ni se sueltan");
+
+    section("argumentos de menos");
+    Value list = zynkCreateArray(&manager, 1);
+    zynkArrayPush(&manager, list, zynkNumber(1));
+    Value only[1] = {list};
+    assert_is_null(zynkCallValue(&manager, global, zynkTableGet(global, "len"), 0, NULL), "len sin argumentos ni argv");
+    assert_true(zynkCallValue(&manager, global, zynkTableGet(global, "push"), 1, only).as.boolean == false, "push con uno");
+    assert_is_null(zynkCallValue(&manager, global, zynkTableGet(global, "pop"), 0, NULL), "pop sin argumentos");
+    assert_is_null(zynkCallValue(&manager, global, zynkTableGet(global, "get_index"), 1, only), "get_index con uno");
+    Value two[2] = {list, zynkNumber(0)};
+    assert_is_null(zynkCallValue(&manager, global, zynkTableGet(global, "set_index"), 2, two), "set_index con dos");
+    assert_equal_number(zynkArrayGet(list, zynkNumber(0)), 1, "el array queda igual");
+    zynk_release(list, &manager);
+
+    section("zynkCallCached");
+    ZynkEnv inner;
+    inner.local = NULL;
+    zynkEnvInit(&inner, 16, global, &manager);
+    ZynkLookupCache cache;
+    zynkLookupCacheInit(&cache);
+    assert_equal_number(zynkCallCached(&manager, &inner, "sum", 2, argv, &cache), 3, "por nombre, a través de la caché");
+    assert_true(cache.env == &inner && cache.depth == 1, "la caché queda llena");
+    assert_equal_number(zynkCallCached(&manager, &inner, "sum", 3, argv, &cache), 6, "la segunda llamada sale de la caché");
+    Value other_fn = zynkCreateNativeFunction(&manager, "__other__", other);
+    zynkTableNew(&inner, "sum", other_fn, &manager);
+    assert_equal_number(zynkCallCached(&manager, &inner, "sum", 3, argv, &cache), -1, "un nombre que tapa al global cambia la llamada");
+    ZynkLookupCache missing;
+    zynkLookupCacheInit(&missing);
+    assert_is_null(zynkCallCached(&manager, &inner, "no_existe", 0, NULL, &missing), "un nombre ausente da null");
+
+    section("zynkCallFunction con array");
+    Value arr = zynkCreateArray(&manager, 4);
+    zynkArrayPush(&manager, arr, zynkNumber(10));
+    zynkArrayPush(&manager, arr, zynkNumber(20));
+    assert_equal_number(zynkCallFunction(&manager, global, "sum", arr), 30, "zynkCallFunction");
+    assert_true(seen == arr.as.obj->obj.array, "el nativo recibe el array tal cual");
+    ZynkLookupCache fcache;
+    zynkLookupCacheInit(&fcache);
+    assert_equal_number(zynkCallFunctionCached(&manager, global, "sum", arr, &fcache), 30, "zynkCallFunctionCached");
+    assert_is_null(zynkCallFunction(&manager, global, "sum", zynkNumber(1)), "los argumentos tienen que ser un array");
+
+    zynk_release(arr, &manager);
+    zynk_release(str, &manager);
+    zynk_release(sum_fn, &manager);
+    zynk_release(other_fn, &manager);
+    freeZynkTable(&manager, inner.local);
+    freeZynkTable(&manager, global->local);
+    free(global);
+    return test_end();
+}
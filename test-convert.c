@@ -0,0 +1,106 @@
+// Pruebas de las conversiones número <-> cadena: el formato se relee al
+// mismo double, y el análisis coincide con strtod también en números largos.
+// Compilar: gcc test-convert.c src/libzynk.a -o test-convert
+#include "test.h"
+
+static bool parses_to(const char *text, double expected) {
+    double value;
+    return zynk_parse_number(text, strlen(text), &value) && memcmp(&value, &expected, sizeof(double)) == 0;
+}
+
+static bool same_as_strtod(const char *text) {
+    return parses_to(text, strtod(text, NULL));
+}
+
+static void format_is(double number, const char *expected) {
+    char text[ZYNK_NUMBER_CHARS + 1];
+    text[zynk_format_number(number, text)] = '\0';
+    char message[96];
+    snprintf(message, sizeof(message), "zynk_format_number: %s", expected);
+    assert_true(strcmp(text, expected) == 0, message);
+}
+
+int main() {
+    printf("--- Pruebas de conversiones ---\n");
+    test_init(8 * 1024 * 1024, 4096);
+
+    section("zynk_format_number");
+    format_is(0, "0");
+    format_is(0.1, "0.1");
+    format_is(100, "100");
+    format_is(-42, "-42");
+    format_is(123.456, "123.456");
+    format_is(1e21, "1e+21");
+    format_is(1e-7, "1e-7");
+    format_is(5e-324, "5e-324");
+    format_is(1.7976931348623157e308, "1.7976931348623157e+308");
+    format_is(1.0 / 0.0, "inf");
+
+    section("ida y vuelta");
+    srand(11);
+    bool round_trip = true;
+    for (int i = 0; i < 20000 && round_trip; ++i) {
+        uint64_t bits = ((uint64_t)rand() << 42) ^ ((uint64_t)rand() << 21) ^ (uint64_t)rand();
+        double number;
+        memcpy(&number, &bits, sizeof(double));
+        if (number != number || number - number != 0) continue; // nan e inf
+        char text[ZYNK_NUMBER_CHARS + 1];
+        text[zynk_format_number(number, text)] = '\0';
+        round_trip = parses_to(text, number) || (number == 0 && parses_to(text, 0));
+    }
+    assert_true(round_trip, "20000 doubles aleatorios se releen iguales");
+
+    section("zynk_parse_number");
+    assert_true(parses_to("0.1", 0.1), "0.1");
+    assert_true(parses_to("-2.5e3", -2500), "-2.5e3");
+    assert_true(parses_to("9007199254740993", 9007199254740992.0), "2^53+1 redondea al par");
+    assert_true(same_as_strtod("1e23") && same_as_strtod("8.98846567431158e307") && same_as_strtod("2.2250738585072011e-308"),
+                "casos difíciles del camino lento");
+    double ignored;
+    assert_true(!zynk_parse_number("1.2.3", 5, &ignored), "dos puntos no es un número");
+    assert_true(!zynk_parse_number("1e", 2, &ignored), "exponente vacío no es un número");
+    assert_true(!zynk_parse_number(".", 1, &ignored), "un punto solo no es un número");
+
+    section("números largos");
+    char text[1200];
+    memset(text, '7', 200);
+    text[200] = '\0';
+    assert_true(same_as_strtod(text), "entero de 200 dígitos");
+    strcpy(text, "0.");
+    memset(text + 2, '0', 129);
+    strcpy(text + 131, "1");
+    assert_true(parses_to(text, 1e-130), "0.000...1 con 130 decimales");
+    // 2^53+1 es el punto medio entre dos doubles: con 800 decimales a cero y
+    // un 1 queda por encima, sin el dígito pegajoso redondearía al par de abajo
+    strcpy(text, "9007199254740993.");
+    memset(text + 17, '0', 800);
+    strcpy(text + 817, "1");
+    assert_true(parses_to(text, 9007199254740994.0), "punto medio desempatado por el decimal 801");
+    text[817] = '\0';
+    assert_true(parses_to(text, 9007199254740992.0), "punto medio exacto con 800 decimales redondea al par");
+    bool long_ok = true;
+    for (int i = 0; i < 300 && long_ok; ++i) {
+        size_t digits = 100 + (size_t)(rand() % 1000);
+        size_t n = 0;
+        if (rand() % 2) text[n++] = '-';
+        for (size_t d = 0; d < digits; ++d) text[n++] = (char)('0' + rand() % 10);
+        size_t point = (size_t)rand() % digits;
+        memmove(text + n - point + 1, text + n - point, point);
+        text[n - point] = '.';
+        n++;
+        n += (size_t)snprintf(text + n, 16, "e%d", rand() % 700 - 350);
+        long_ok = same_as_strtod(text);
+    }
+    assert_true(long_ok, "300 números de 100 a 1100 dígitos coinciden con strtod");
+
+    section("zynkStringToNumber / zynkValueToString");
+    Value str = zynkCreateString(&manager, "  12.5\n");
+    assert_equal_number(zynkStringToNumber(str), 12.5, "zynkStringToNumber: con blancos alrededor");
+    Value bad = zynkCreateString(&manager, "12abc");
+    assert_is_null(zynkStringToNumber(bad), "zynkStringToNumber: basura al final da null");
+    assert_equal_string(zynkValueToString(&manager, zynkNumber(0.3)), "0.3", "zynkValueToString: número");
+    assert_equal_string(zynkValueToString(&manager, zynkBool(false)), "false", "zynkValueToString: booleano");
+    assert_equal_string(zynkValueToString(&manager, zynkNull()), "null", "zynkValueToString: null");
+
+    return test_end();
+}
@@ -0,0 +1,66 @@
+// Pruebas de los arrays copy-on-write: una copia comparte el buffer hasta
+// que una de las dos cambia, y las referencias de los elementos cuadran.
+// Compilar: gcc test-cow.c src/libzynk.a -o test-cow
+#include "test.h"
+
+static Value numbers(int n) {
+    Value arr = zynkCreateArray(&manager, 4);
+    for (int i = 0; i < n; ++i) zynkArrayPush(&manager, arr, zynkNumber(i));
+    return arr;
+}
+
+int main() {
+    printf("--- Pruebas de arrays copy-on-write ---\n");
+    test_init(8 * 1024 * 1024, 4096);
+
+    section("zynkArrayCopy comparte el buffer");
+    Value a = numbers(8);
+    Value b = zynkArrayCopy(&manager, a);
+    ZynkArray *aa = a.as.obj->obj.array, *ba = b.as.obj->obj.array;
+    assert_true(aa->array == ba->array, "la copia usa el mismo buffer");
+    assert_true(aa->shared != NULL && *aa->shared == 2, "el contador compartido vale 2");
+    assert_true(zynkValuesEqual(a, b), "zynkValuesEqual: original y copia son iguales mientras comparten");
+
+    section("escribir deja de compartir");
+    zynkArraySet(&manager, b, zynkNumber(0), zynkNumber(100));
+    assert_true(aa->array != ba->array, "zynkArraySet: la copia tiene su propio buffer");
+    assert_equal_number(zynkArrayGet(a, zynkNumber(0)), 0, "el original no ve el cambio");
+    assert_equal_number(zynkArrayGet(b, zynkNumber(0)), 100, "la copia sí");
+    assert_true(aa->shared == NULL || *aa->shared == 1, "el original vuelve a ser el único dueño");
+
+    Value c = zynkArrayCopy(&manager, a);
+    zynkArrayPush(&manager, c, zynkNumber(8));
+    assert_true(aa->len == 8 && c.as.obj->obj.array->len == 9, "zynkArrayPush: solo crece la copia");
+    Value d = zynkArrayCopy(&manager, a);
+    assert_equal_number(zynkArrayPop(&manager, d), 7, "zynkArrayPop: saca el último de la copia");
+    assert_true(aa->len == 8, "zynkArrayPop: el original conserva sus elementos");
+    assert_equal_number(zynkArrayGet(a, zynkNumber(7)), 7, "zynkArrayPop: el último del original sigue ahí");
+
+    section("referencias de los elementos");
+    Value s = zynkCreateString(&manager, "compartido");
+    Value holder = zynkCreateArray(&manager, 2);
+    zynkArrayPush(&manager, holder, s);
+    uint32_t base = s.as.obj->ref_count;
+    Value copies[4];
+    for (int i = 0; i < 4; ++i) copies[i] = zynkArrayCopy(&manager, holder);
+    assert_true(s.as.obj->ref_count == base, "copiar no retiene los elementos");
+    zynkArrayPush(&manager, copies[0], zynkNumber(1));
+    assert_true(s.as.obj->ref_count == base + 1, "dejar de compartir retiene los elementos una vez");
+    for (int i = 0; i < 4; ++i) zynk_release(copies[i], &manager);
+    assert_true(s.as.obj->ref_count == base, "liberar las copias devuelve las referencias");
+    zynk_release(holder, &manager);
+    assert_true(s.as.obj->ref_count == base - 1, "liberar el último dueño suelta el elemento");
+
+    section("array vacío");
+    Value empty = zynkCreateArray(&manager, 0);
+    Value empty_copy = zynkArrayCopy(&manager, empty);
+    assert_is_null(zynkArrayGet(empty_copy, zynkNumber(0)), "zynkArrayGet: índice en un array vacío da null");
+    zynkArraySet(&manager, empty_copy, zynkNumber(0), zynkNumber(1));
+    assert_true(empty_copy.as.obj->obj.array->len == 0, "zynkArraySet: no hace nada en un array vacío");
+    assert_is_null(zynkArrayPop(&manager, empty_copy), "zynkArrayPop: array vacío da null");
+
+    zynk_release(s, &manager);
+    Value all[] = {a, b, c, d, empty, empty_copy};
+    for (int i = 0; i < 6; ++i) zynk_release(all[i], &manager);
+    return test_end();
+}
@@ -0,0 +1,97 @@
+// Pruebas del pool de marcos (zynkFramePush / Pop): tablas que se reciclan
+// sin perder valores ni nombres, y cachés y direcciones de un marco que ya
+// no está, aunque su tabla se haya liberado o reutilizado.
+// Compilar: gcc test-frame.c src/libzynk.a -o test-frame
+#include "test.h"
+
+int main() {
+    printf("--- Pruebas del pool de marcos ---\n");
+    test_init(16 * 1024 * 1024, 8192);
+
+    ZynkEnv *global = new_env(64);
+    zynkTableNew(global, "x", zynkNumber(100), &manager);
+    ZynkFramePool pool;
+    assert_true(!zynkFramePoolInit(&pool, &manager, 16, 0), "max_idle 0 no vale");
+    assert_true(zynkFramePoolInit(&pool, &manager, 16, 1), "zynkFramePoolInit con un marco libre como mucho");
+
+    section("push y pop");
+    ZynkEnv a, b;
+    assert_true(zynkFramePush(&pool, &a, global), "zynkFramePush");
+    zynkTableNew(&a, "local", zynkNumber(1), &manager);
+    Value str = zynkCreateString(&manager, "marco");
+    zynkTableNew(&a, "s", str, &manager);
+    uint32_t refs = str.as.obj->ref_count;
+    assert_equal_number(zynkTableGet(&a, "x"), 100, "el marco ve el global");
+    ZynkEnvTable *first = a.local;
+    zynkFramePop(&pool, &a);
+    assert_true(a.local == NULL && pool.len == 1, "pop deja la tabla en el pool");
+    assert_true(str.as.obj->ref_count == refs - 1, "y suelta los valores");
+    zynkFramePush(&pool, &a, global);
+    assert_true(a.local == first, "el siguiente push la reutiliza");
+    assert_is_null(zynkTableGet(&a, "local"), "vacía");
+    char name[32];
+    bool ok = true;
+    for (int i = 0; i < 40; ++i) {
+        snprintf(name, sizeof(name), "nombre_largo_del_marco_%d", i);
+        ok = ok && zynkTableNew(&a, name, zynkNumber(i), &manager);
+    }
+    assert_true(ok && zynkTableGet(&a, "nombre_largo_del_marco_39").as.number == 39, "más nombres de los que caben en el búfer");
+    zynkFramePop(&pool, &a);
+    zynkFramePush(&pool, &a, global);
+    assert_is_null(zynkTableGet(&a, "nombre_largo_del_marco_0"), "y se van con el pop");
+    zynkFramePop(&pool, &a);
+
+    section("cachés de un marco liberado");
+    // el pool guarda un marco; b vuelve a él y a se libera al salir
+    zynkFramePush(&pool, &a, global);
+    zynkFramePush(&pool, &b, global);
+    zynkFramePop(&pool, &b);
+    zynkTableNew(&a, "x", zynkNumber(1), &manager);
+    ZynkLookupCache cache;
+    zynkLookupCacheInit(&cache);
+    assert_equal_number(zynkTableGetCached(&a, "x", &cache), 1, "la caché guarda la x del marco");
+    ZynkEnvAddr addr;
+    assert_true(zynkEnvResolve(&a, "x", &addr), "y una dirección");
+    zynkFramePop(&pool, &a); // el pool está lleno: se libera
+    zynkFramePush(&pool, &a, global);
+    assert_equal_number(zynkTableGetCached(&a, "x", &cache), 100, "en el marco nuevo la caché da el global");
+    assert_is_null(zynkEnvGetAt(&a, addr), "la dirección vieja no vale");
+    assert_true(!zynkEnvSetAt(&manager, &a, addr, zynkNumber(2)), "ni para escribir");
+
+    section("tablas nuevas donde había otras");
+    zynkFramePush(&pool, &b, global); // el pool está vacío: tabla nueva
+    zynkTableNew(&b, "x", zynkNumber(3), &manager);
+    zynkLookupCacheInit(&cache);
+    zynkTableGetCached(&b, "x", &cache);
+    zynkEnvResolve(&b, "x", &addr);
+    zynkFramePop(&pool, &a);
+    zynkFramePop(&pool, &b); // se libera
+    ZynkEnv c;
+    c.local = NULL;
+    zynkEnvInit(&c, 16, global, &manager); // puede caer donde estaba la de b
+    zynkTableNew(&c, "x", zynkNumber(4), &manager);
+    b = c;
+    assert_equal_number(zynkTableGetCached(&b, "x", &cache), 4, "la caché no confunde la tabla nueva con la vieja");
+    assert_is_null(zynkEnvGetAt(&b, addr), "ni la dirección");
+
+    section("marcos intermedios");
+    ZynkEnv inner;
+    inner.local = NULL;
+    zynkFramePush(&pool, &a, global);
+    zynkEnvInit(&inner, 16, &a, &manager);
+    zynkLookupCacheInit(&cache);
+    assert_equal_number(zynkTableGetCached(&inner, "x", &cache), 100, "x del global a través de un marco");
+    zynkFramePop(&pool, &a);
+    zynkFramePush(&pool, &a, global);
+    zynkTableNew(&a, "x", zynkNumber(5), &manager);
+    assert_equal_number(zynkTableGetCached(&inner, "x", &cache), 5, "el marco que entra en la cadena tapa al global");
+
+    zynk_release(str, &manager);
+    freeZynkTable(&manager, inner.local);
+    zynkFramePop(&pool, &a);
+    freeZynkTable(&manager, c.local);
+    zynkFramePoolFree(&pool);
+    freeZynkTable(&manager, global->local);
+    free(global);
+    return test_end();
+}
@@ -0,0 +1,105 @@
+// Pruebas de zynkEnvFreeze: la tabla congelada encuentra todos sus nombres
+// con un solo acceso, Set, las cachés, las direcciones y los atoms siguen
+// valiendo, y New o Delete la devuelven a una tabla normal.
+// Compilar: gcc test-freeze.c src/libzynk.a -o test-freeze
+#include "test.h"
+#include "src/runtime/frozen.h" // el layout de los slots
+
+#define N 1000
+
+static bool all_there(ZynkEnv *env, int n, int skip) {
+    char name[32];
+    for (int i = 0; i < n; ++i) {
+        snprintf(name, sizeof(name), "global_%d", i);
+        Value v = zynkTableGet(env, name);
+        if (i == skip ? v.type != ZYNK_NULL : (v.type != ZYNK_NUMBER || v.as.number != i)) return false;
+    }
+    return true;
+}
+
+int main() {
+    printf("--- Pruebas de entornos congelados ---\n");
+    test_init(32 * 1024 * 1024, 16384);
+    char name[32];
+
+    section("congelar");
+    ZynkEnv *env = new_env(16);
+    for (int i = 0; i < N; ++i) {
+        snprintf(name, sizeof(name), "global_%d", i);
+        zynkTableNew(env, name, zynkNumber(i), &manager);
+    }
+    zynkTableNew(env, "borrado", zynkNumber(0), &manager);
+    zynkTableDelete(env, "borrado", &manager);
+    assert_true(zynkEnvFreeze(&manager, env), "zynkEnvFreeze con 1000 nombres");
+    assert_true(env->local->frozen != NULL && env->local->frozen->count == N, "tantos slots como nombres");
+    assert_true(all_there(env, N, -1), "todos se encuentran");
+    assert_is_null(zynkTableGet(env, "borrado"), "los borrados no vuelven");
+    assert_is_null(zynkTableGet(env, "global_x"), "un nombre ausente da null");
+    bool ok = true;
+    for (uint32_t i = 0; i < env->local->frozen->count; ++i) {
+        ZynkEnvEntry *e = &env->local->frozen->entries[i];
+        uint32_t seed = env->local->frozen->seeds[zynk_frozen_bucket(e->hash, env->local->frozen->buckets)];
+        ok = ok && zynk_frozen_slot(e->hash, seed, env->local->frozen->count) == i;
+    }
+    assert_true(ok, "cada nombre está en el slot de su primer acceso");
+    ZynkEnv empty_env;
+    empty_env.local = NULL;
+    zynkEnvInit(&empty_env, 16, NULL, &manager);
+    assert_true(zynkEnvFreeze(&manager, &empty_env), "una tabla vacía también se congela");
+    assert_is_null(zynkTableGet(&empty_env, "x"), "y no encuentra nada");
+
+    section("lo que sigue funcionando");
+    assert_true(zynkTableSet(&manager, env, "global_5", zynkNumber(-5)), "Set en una tabla congelada");
+    assert_equal_number(zynkTableGet(env, "global_5"), -5, "cambia el valor en su sitio");
+    assert_true(env->local->frozen != NULL, "sin descongelarla");
+    ZynkEnv inner;
+    inner.local = NULL;
+    zynkEnvInit(&inner, 16, env, &manager);
+    ZynkLookupCache cache;
+    zynkLookupCacheInit(&cache);
+    assert_equal_number(zynkTableGetCached(&inner, "global_7", &cache), 7, "caché sobre una tabla congelada");
+    assert_true(zynkTableSetCached(&manager, &inner, "global_7", zynkNumber(70), &cache) && zynkTableGet(env, "global_7").as.number == 70,
+                "SetCached escribe en ella");
+    ZynkEnvAddr addr;
+    assert_true(zynkEnvResolve(&inner, "global_9", &addr) && addr.depth == 1, "zynkEnvResolve");
+    assert_equal_number(zynkEnvGetAt(&inner, addr), 9, "zynkEnvGetAt");
+    ZynkAtom atom = zynkAtomIntern(&manager, "global_11");
+    assert_equal_number(zynkTableGetAtom(&inner, atom), 11, "GetAtom con un nombre copiado");
+    zynkTableSet(&manager, env, "global_5", zynkNumber(5));
+    zynkTableSet(&manager, env, "global_7", zynkNumber(7));
+
+    section("descongelar");
+    assert_true(!zynkTableNew(env, "global_3", zynkNumber(0), &manager), "New de un nombre existente falla sin descongelar");
+    assert_true(env->local->frozen != NULL, "y la tabla sigue congelada");
+    assert_true(zynkTableNew(env, "nuevo", zynkNumber(1), &manager), "New de un nombre nuevo");
+    assert_true(env->local->frozen == NULL, "la devuelve a una tabla normal");
+    assert_true(all_there(env, N, -1) && zynkTableGet(env, "nuevo").as.number == 1, "con todo lo que tenía y lo nuevo");
+    assert_equal_number(zynkTableGetCached(&inner, "global_7", &cache), 7, "la caché vuelve a buscar");
+    assert_is_null(zynkEnvGetAt(&inner, addr), "la dirección queda vieja");
+    assert_true(zynkEnvFreeze(&manager, env), "se vuelve a congelar");
+    assert_true(zynkTableDelete(env, "global_3", &manager) && env->local->frozen == NULL, "Delete también descongela");
+    assert_true(all_there(env, N, 3), "y borra");
+
+    section("nombres de atoms");
+    ZynkEnv atoms;
+    atoms.local = NULL;
+    zynkEnvInit(&atoms, 16, NULL, &manager);
+    ZynkAtom ids[50];
+    for (int i = 0; i < 50; ++i) {
+        snprintf(name, sizeof(name), "atom_%d", i);
+        ids[i] = zynkAtomIntern(&manager, name);
+        zynkTableNewAtom(&atoms, ids[i], zynkNumber(i), &manager);
+    }
+    assert_true(zynkEnvFreeze(&manager, &atoms), "congelar una tabla de atoms");
+    ok = true;
+    for (int i = 0; i < 50; ++i) ok = ok && zynkTableGetAtom(&atoms, ids[i]).as.number == i;
+    assert_true(ok && zynkTableGet(&atoms, "atom_20").as.number == 20, "se encuentran por atom y por nombre");
+
+    freeZynkTable(&manager, atoms.local);
+    freeZynkTable(&manager, inner.local);
+    freeZynkTable(&manager, empty_env.local);
+    freeZynkTable(&manager, env->local);
+    free(env);
+    zynkAtomsFree(&manager);
+    return test_end();
+}
@@ -0,0 +1,120 @@
+// Pruebas de los entornos persistentes (HAMT): operaciones normales,
+// instantáneas O(1) aisladas en los dos sentidos, referencias de los
+// valores y cachés de búsqueda sobre entradas que se copian.
+// Compilar: gcc test-hamt.c src/libzynk.a -o test-hamt
+#include "test.h"
+
+#define N 3000
+
+static void key_name(char *out, int i) {
+    snprintf(out, 32, "p%d", i);
+}
+
+static bool matches(ZynkEnv *env, const double *expected) {
+    char name[32];
+    for (int i = 0; i < N; ++i) {
+        key_name(name, i);
+        Value v = zynkTableGet(env, name);
+        if (expected[i] != expected[i] ? v.type != ZYNK_NULL : (v.type != ZYNK_NUMBER || v.as.number != expected[i])) return false;
+    }
+    return true;
+}
+
+static double base[N], changed[N];
+
+int main() {
+    printf("--- Pruebas de entornos persistentes ---\n");
+    zynk_hash_seed(1234); // reproducible
+    test_init(64 * 1024 * 1024, 32768);
+    char name[32];
+
+    section("operaciones");
+    ZynkEnv env;
+    env.local = NULL;
+    assert_true(zynkEnvInitPersistent(&env, NULL, &manager), "zynkEnvInitPersistent");
+    bool ok = true;
+    for (int i = 0; i < N; ++i) {
+        key_name(name, i);
+        ok = ok && zynkTableNew(&env, name, zynkNumber(i), &manager);
+        base[i] = i;
+    }
+    assert_true(ok && env.local->count == N, "3000 altas");
+    assert_true(!zynkTableNew(&env, "p1", zynkNumber(0), &manager), "New rechaza una clave existente");
+    for (int i = 0; i < N; i += 3) {
+        key_name(name, i);
+        ok = ok && zynkTableDelete(&env, name, &manager);
+        base[i] = 0.0 / 0.0;
+    }
+    for (int i = 1; i < N; i += 3) {
+        key_name(name, i);
+        ok = ok && zynkTableSet(&manager, &env, name, zynkNumber(-i));
+        base[i] = -i;
+    }
+    assert_true(ok && env.local->count == N - N / 3, "bajas y cambios");
+    assert_true(matches(&env, base), "todo cuadra");
+
+    section("instantáneas");
+    ZynkEnv snap;
+    snap.local = NULL;
+    assert_true(zynkEnvSnapshot(&manager, &env, &snap), "zynkEnvSnapshot");
+    assert_true(snap.local->root == env.local->root, "comparte la raíz, sin copiar");
+    memcpy(changed, base, sizeof(base));
+    for (int i = 0; i < N; i += 7) {
+        key_name(name, i);
+        if (changed[i] != changed[i]) {
+            zynkTableNew(&env, name, zynkNumber(1000 + i), &manager);
+            changed[i] = 1000 + i;
+        } else if (i % 2) {
+            zynkTableDelete(&env, name, &manager);
+            changed[i] = 0.0 / 0.0;
+        } else {
+            zynkTableSet(&manager, &env, name, zynkNumber(2000 + i));
+            changed[i] = 2000 + i;
+        }
+    }
+    assert_true(matches(&env, changed), "el original ve sus cambios");
+    assert_true(matches(&snap, base), "la instantánea no los ve");
+    zynkTableSet(&manager, &snap, "p1", zynkNumber(77));
+    assert_equal_number(zynkTableGet(&env, "p1"), changed[1], "un cambio en la instantánea no llega al original");
+
+    ZynkEnv snap2;
+    snap2.local = NULL;
+    zynkEnvSnapshot(&manager, &snap, &snap2);
+    freeZynkTable(&manager, snap.local);
+    assert_equal_number(zynkTableGet(&snap2, "p1"), 77, "una instantánea de otra sobrevive a la primera");
+    base[1] = 77;
+    assert_true(matches(&snap2, base), "con todo su contenido");
+
+    section("referencias de los valores");
+    Value str = zynkCreateString(&manager, "compartido");
+    zynkTableNew(&env, "s", str, &manager);
+    ZynkEnv snap3;
+    snap3.local = NULL;
+    zynkEnvSnapshot(&manager, &env, &snap3);
+    uint32_t refs = str.as.obj->ref_count;
+    zynkTableSet(&manager, &env, "s", zynkNumber(0));
+    assert_true(str.as.obj->ref_count == refs, "la instantánea sigue reteniendo el valor cambiado");
+    assert_true(zynkTableGet(&snap3, "s").as.obj == str.as.obj, "y lo devuelve");
+    freeZynkTable(&manager, snap3.local);
+    assert_true(str.as.obj->ref_count == refs - 1, "al liberar la instantánea lo suelta");
+
+    section("cachés sobre entradas copiadas");
+    ZynkLookupCache cache;
+    zynkLookupCacheInit(&cache);
+    zynkTableSet(&manager, &env, "p2", zynkNumber(2));
+    assert_equal_number(zynkTableGetCached(&env, "p2", &cache), 2, "búsqueda guardada");
+    ZynkEnv snap4;
+    snap4.local = NULL;
+    zynkEnvSnapshot(&manager, &env, &snap4);
+    zynkTableSet(&manager, &env, "p2", zynkNumber(22)); // copia la hoja compartida
+    assert_equal_number(zynkTableGetCached(&env, "p2", &cache), 22, "la caché ve la hoja copiada");
+    assert_equal_number(zynkTableGet(&snap4, "p2"), 2, "la instantánea conserva la suya");
+    freeZynkTable(&manager, snap4.local);
+    assert_true(zynkTableSetCached(&manager, &env, "p2", zynkNumber(23), &cache), "SetCached tras liberar la instantánea");
+    assert_equal_number(zynkTableGet(&env, "p2"), 23, "escribe en la hoja viva");
+
+    zynk_release(str, &manager);
+    freeZynkTable(&manager, snap2.local);
+    freeZynkTable(&manager, env.local);
+    return test_end();
+}
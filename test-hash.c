@@ -0,0 +1,71 @@
+// Pruebas de wyhash (zynk_hash64) y zynkValueHash: dependencia de la
+// semilla, de cada bit y de la longitud, y nada de lo que hay después.
+// Compilar: gcc test-hash.c src/libzynk.a -o test-hash
+#include "test.h"
+
+static int popcount64(uint64_t x) {
+    int n = 0;
+    for (; x; x &= x - 1) n++;
+    return n;
+}
+
+int main() {
+    printf("--- Pruebas de hash ---\n");
+    zynk_hash_seed(42); // antes de crear tablas
+    test_init(8 * 1024 * 1024, 4096);
+
+    section("semilla");
+    assert_true(zynk_hash_get_seed() == 42, "zynk_hash_get_seed devuelve la semilla fijada");
+    uint64_t with_42 = zynk_hash64("zynk", 4);
+    assert_true(zynk_hash64("zynk", 4) == with_42, "mismo texto, mismo hash");
+    zynk_hash_seed(43);
+    assert_true(zynk_hash64("zynk", 4) != with_42, "otra semilla cambia el hash");
+    zynk_hash_seed(42);
+    assert_true(zynk_hash64("zynk", 4) == with_42, "volver a la semilla recupera el hash");
+
+    section("longitudes y bits");
+    uint8_t data[300];
+    for (size_t i = 0; i < sizeof(data); ++i) data[i] = (uint8_t)(i * 37 + 11);
+    bool bits_ok = true, tail_ok = true, len_ok = true;
+    long flipped = 0, tested = 0;
+    for (size_t len = 0; len <= 200; ++len) {
+        uint64_t base = zynk_hash64(data, len);
+        // los bytes después de len no cuentan
+        data[len] ^= 0xFF;
+        tail_ok = tail_ok && zynk_hash64(data, len) == base;
+        data[len] ^= 0xFF;
+        len_ok = len_ok && (len == 0 || zynk_hash64(data, len - 1) != base);
+        for (size_t bit = 0; bit < len * 8; bit += (len < 20 ? 1 : 7)) {
+            data[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+            uint64_t changed = zynk_hash64(data, len);
+            data[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+            bits_ok = bits_ok && changed != base;
+            flipped += popcount64(changed ^ base);
+            tested++;
+        }
+    }
+    assert_true(bits_ok, "cambiar cualquier bit cambia el hash (longitudes 0 a 200)");
+    assert_true(tail_ok, "los bytes después de la longitud no cuentan");
+    assert_true(len_ok, "quitar el último byte cambia el hash");
+    double average = (double)flipped / (double)tested;
+    printf("bits cambiados de media: %.2f de 64\n", average);
+    assert_true(average > 30 && average < 34, "avalancha: cambia cerca de la mitad de los bits");
+    assert_true(zynk_hash_string("abc") == zynk_hash_bytes("abc", 3), "zynk_hash_string mide y hashea igual");
+
+    section("zynkValueHash");
+    Value s1 = zynkCreateString(&manager, "clave");
+    Value s2 = zynkCreateString(&manager, "clave");
+    assert_true(zynkValueHash(s1) == zynkValueHash(s2), "strings iguales, mismo hash");
+    assert_true(zynkValueHash(zynkNumber(0)) == zynkValueHash(zynkNumber(-0.0)), "0 y -0, mismo hash");
+    assert_true(zynkValueHash(zynkNumber(1)) != zynkValueHash(zynkNumber(2)), "números distintos");
+    assert_true(zynkValueHash(zynkByte(1)) != zynkValueHash(zynkNumber(1)), "byte y número no se mezclan");
+    Value arr = zynkCreateArray(&manager, 1);
+    uint32_t arr_hash = zynkValueHash(arr);
+    for (int i = 0; i < 50; ++i) zynkArrayPush(&manager, arr, zynkNumber(i));
+    assert_true(zynkValueHash(arr) == arr_hash, "un array conserva su hash al crecer");
+
+    zynk_release(s1, &manager);
+    zynk_release(s2, &manager);
+    zynk_release(arr, &manager);
+    return test_end();
+}
@@ -0,0 +1,172 @@
+// Pruebas del compilador a x86-64: cada función se ejecuta en la VM y
+// compilada y los resultados tienen que coincidir, también cuando un guard
+// de tipo falla y la instrucción vuelve a la VM (strings, null, bools,
+// índices raros, arrays compartidos). Sin JIT solo comprueba que
+// zynkCompileFunction dice que no y que todo sigue en la VM.
+// Compilar: gcc test-jit.c src/libzynk.a -o test-jit
+#include <math.h>
+#include "test.h"
+#include "src/runtime/jit.h"
+
+#ifdef ZYNK_JIT_X64
+#define HAS_JIT true
+#else
+#define HAS_JIT false
+#endif
+
+static ZynkEnv *global;
+static bool compiled_all = true;
+
+static bool same(Value x, Value y) {
+    if (x.type != y.type) return false;
+    if (x.type == ZYNK_NUMBER) return (isnan(x.as.number) && isnan(y.as.number)) || x.as.number == y.as.number;
+    if (x.type == ZYNK_BOOL) return x.as.boolean == y.as.boolean;
+    if (x.type == ZYNK_OBJ) return zynkValuesEqual(x, y);
+    return true;
+}
+
+// la misma función dos veces, una en la VM y otra compilada
+static bool twin(uint32_t *code, uint32_t len, uint8_t arity, uint16_t registers, Value *argv) {
+    Value vm = zynkCreateFunction(&manager, "vm", arity, registers, code, len, NULL, 0);
+    Value jit = zynkCreateFunction(&manager, "jit", arity, registers, code, len, NULL, 0);
+    compiled_all = compiled_all && zynkCompileFunction(&manager, jit) == HAS_JIT;
+    Value r1 = zynkCallValue(&manager, global, vm, arity, argv);
+    Value r2 = zynkCallValue(&manager, global, jit, arity, argv);
+    bool ok = same(r1, r2);
+    zynk_release(r1, &manager);
+    zynk_release(r2, &manager);
+    zynk_release(vm, &manager);
+    zynk_release(jit, &manager);
+    return ok;
+}
+
+int main() {
+    printf("--- Pruebas del JIT ---\n");
+    test_init(64 * 1024 * 1024, 32768);
+    global = new_env(64);
+    init_native_funcs(&manager, global);
+
+    section("operaciones, con y sin guard");
+    Value vals[] = {zynkNumber(3), zynkNumber(0), zynkNumber(NAN), zynkBool(true),
+                    zynkNull(), zynkCreateString(&manager, "s"), zynkNumber(-2.5), zynkBool(false)};
+    int ops[] = {ZYNK_OP_ADD, ZYNK_OP_SUB, ZYNK_OP_MUL, ZYNK_OP_DIV, ZYNK_OP_EQ, ZYNK_OP_LT, ZYNK_OP_LE};
+    bool ok = true;
+    for (int o = 0; o < 7; ++o) {
+        for (int i = 0; i < 8; ++i) {
+            for (int j = 0; j < 8; ++j) {
+                Value argv[] = {vals[i], vals[j]};
+                uint32_t code[] = {ZYNK_ABC(ops[o], 2, 0, 1), ZYNK_ABC(ZYNK_OP_RETURN, 2, 0, 0)};
+                ok = ok && twin(code, 2, 2, 3, argv);
+                // el destino tiene un objeto: se escribe sobre R0
+                uint32_t self[] = {ZYNK_ABC(ops[o], 0, 0, 1), ZYNK_ABC(ZYNK_OP_RETURN, 0, 0, 0)};
+                ok = ok && twin(self, 2, 2, 3, argv);
+            }
+        }
+    }
+    assert_true(ok, "7 operaciones sobre 64 pares de valores dan lo mismo");
+    ok = true;
+    for (int i = 0; i < 8; ++i) {
+        uint32_t not_code[] = {ZYNK_ABC(ZYNK_OP_NOT, 1, 0, 0), ZYNK_ABC(ZYNK_OP_RETURN, 1, 0, 0)};
+        ok = ok && twin(not_code, 2, 1, 2, &vals[i]);
+        uint32_t branch[] = {ZYNK_ABX(ZYNK_OP_JMPIF, 0, 2), ZYNK_ABC(ZYNK_OP_LOADBOOL, 1, 0, 0), ZYNK_ABC(ZYNK_OP_RETURN, 1, 0, 0),
+                             ZYNK_ABC(ZYNK_OP_LOADBOOL, 1, 1, 0), ZYNK_ABC(ZYNK_OP_RETURN, 1, 0, 0)};
+        ok = ok && twin(branch, 5, 1, 2, &vals[i]);
+        branch[0] = ZYNK_ABX(ZYNK_OP_JMPIFNOT, 0, 2);
+        ok = ok && twin(branch, 5, 1, 2, &vals[i]);
+        uint32_t moves[] = {ZYNK_ABC(ZYNK_OP_MOVE, 1, 0, 0), ZYNK_ABC(ZYNK_OP_MOVE, 2, 1, 0), ZYNK_ABC(ZYNK_OP_RETURN, 2, 0, 0)};
+        ok = ok && twin(moves, 3, 1, 3, &vals[i]);
+    }
+    assert_true(ok, "NOT, saltos y MOVE con todos los tipos");
+    assert_true(vals[5].as.obj->ref_count == 1, "ninguna vuelta a la VM pierde ni deja referencias");
+
+    section("arrays");
+    Value s = vals[5];
+    Value arr = zynkCreateArray(&manager, 8);
+    for (int i = 0; i < 4; ++i) zynkArrayPush(&manager, arr, zynkNumber(i * 10));
+    zynkArrayPush(&manager, arr, s);
+    Value idx[] = {zynkNumber(0), zynkNumber(3), zynkNumber(3.7), zynkNumber(4), zynkNumber(5),
+                   zynkNumber(-1), zynkNumber(NAN), zynkNull(), zynkNumber(1e20)};
+    ok = true;
+    for (int i = 0; i < 9; ++i) {
+        Value argv[] = {arr, idx[i]};
+        uint32_t get[] = {ZYNK_ABC(ZYNK_OP_GETINDEX, 2, 0, 1), ZYNK_ABC(ZYNK_OP_RETURN, 2, 0, 0)};
+        ok = ok && twin(get, 2, 2, 3, argv);
+    }
+    Value not_array[] = {zynkNumber(1), zynkNumber(0)};
+    uint32_t get[] = {ZYNK_ABC(ZYNK_OP_GETINDEX, 2, 0, 1), ZYNK_ABC(ZYNK_OP_RETURN, 2, 0, 0)};
+    ok = ok && twin(get, 2, 2, 3, not_array);
+    assert_true(ok, "GETINDEX con índices fuera de rango, no enteros y no números");
+    Value elems[] = {zynkNumber(7), s, zynkBool(true)};
+    uint32_t set[] = {ZYNK_ABC(ZYNK_OP_SETINDEX, 0, 1, 2), ZYNK_ABC(ZYNK_OP_RETURN, 0, 0, 0)};
+    ok = true;
+    for (int i = 0; i < 6; ++i) {
+        for (int v = 0; v < 3; ++v) {
+            Value a1 = zynkCreateArray(&manager, 4), a2 = zynkCreateArray(&manager, 4);
+            for (int q = 0; q < 4; ++q) {
+                zynkArrayPush(&manager, a1, q == 2 ? s : zynkNumber(q));
+                zynkArrayPush(&manager, a2, q == 2 ? s : zynkNumber(q));
+            }
+            Value vm = zynkCreateFunction(&manager, "vm", 3, 3, set, 2, NULL, 0);
+            Value jit = zynkCreateFunction(&manager, "jit", 3, 3, set, 2, NULL, 0);
+            compiled_all = compiled_all && zynkCompileFunction(&manager, jit) == HAS_JIT;
+            Value x1[] = {a1, idx[i], elems[v]}, x2[] = {a2, idx[i], elems[v]};
+            zynk_release(zynkCallValue(&manager, global, vm, 3, x1), &manager);
+            zynk_release(zynkCallValue(&manager, global, jit, 3, x2), &manager);
+            for (int q = 0; q < 4; ++q) ok = ok && same(zynkArrayGet(a1, zynkNumber(q)), zynkArrayGet(a2, zynkNumber(q)));
+            zynk_release(a1, &manager);
+            zynk_release(a2, &manager);
+            zynk_release(vm, &manager);
+            zynk_release(jit, &manager);
+        }
+    }
+    assert_true(ok, "SETINDEX deja los dos arrays iguales");
+    assert_true(s.as.obj->ref_count == 2, "y las referencias de los elementos cuadran");
+    Value copy = zynkCallValue(&manager, global, zynkTableGet(global, "copy"), 1, &arr);
+    uint32_t set_ret[] = {ZYNK_ABC(ZYNK_OP_SETINDEX, 0, 1, 2), ZYNK_ABC(ZYNK_OP_RETURN, 1, 0, 0)};
+    Value setter = zynkCreateFunction(&manager, "set", 3, 3, set_ret, 2, NULL, 0);
+    zynkCompileFunction(&manager, setter);
+    Value x[] = {copy, zynkNumber(0), zynkNumber(99)};
+    zynkCallValue(&manager, global, setter, 3, x);
+    assert_true(zynkArrayGet(copy, zynkNumber(0)).as.number == 99 && zynkArrayGet(arr, zynkNumber(0)).as.number == 0,
+                "un array compartido se copia antes de escribir");
+    zynk_release(setter, &manager);
+    zynk_release(copy, &manager);
+
+    section("llamadas y umbral");
+    Value fib_k[] = {zynkNumber(2), zynkNumber(1), zynkCreateString(&manager, "fib")};
+    uint32_t fib_code[] = {ZYNK_ABX(ZYNK_OP_LOADK, 1, 0), ZYNK_ABC(ZYNK_OP_LT, 2, 0, 1), ZYNK_ABX(ZYNK_OP_JMPIFNOT, 2, 1),
+                           ZYNK_ABC(ZYNK_OP_RETURN, 0, 0, 0), ZYNK_ABX(ZYNK_OP_GETGLOBAL, 3, 2), ZYNK_ABX(ZYNK_OP_LOADK, 1, 1),
+                           ZYNK_ABC(ZYNK_OP_SUB, 4, 0, 1), ZYNK_ABC(ZYNK_OP_CALL, 2, 3, 1), ZYNK_ABX(ZYNK_OP_GETGLOBAL, 3, 2),
+                           ZYNK_ABX(ZYNK_OP_LOADK, 1, 0), ZYNK_ABC(ZYNK_OP_SUB, 4, 0, 1), ZYNK_ABC(ZYNK_OP_CALL, 5, 3, 1),
+                           ZYNK_ABC(ZYNK_OP_ADD, 2, 2, 5), ZYNK_ABC(ZYNK_OP_RETURN, 2, 0, 0)};
+    Value fib = zynkCreateFunction(&manager, "fib", 1, 6, fib_code, 14, fib_k, 3);
+    zynk_release(fib_k[2], &manager);
+    zynkTableNew(global, "fib", fib, &manager);
+    Value n = zynkNumber(20);
+    assert_equal_number(zynkCallValue(&manager, global, fib, 1, &n), 6765, "fib(20), cruzando el umbral a mitad");
+    assert_true((fib.as.obj->obj.function->jit != NULL) == HAS_JIT, "se compiló tras ZYNK_JIT_THRESHOLD llamadas");
+    assert_equal_number(zynkCallValue(&manager, global, fib, 1, &n), 6765, "fib(20) compilada");
+
+    section("constantes devueltas");
+    Value sk[] = {zynkCreateString(&manager, "hola")};
+    uint32_t ret_code[] = {ZYNK_ABX(ZYNK_OP_LOADK, 0, 0), ZYNK_ABC(ZYNK_OP_MOVE, 1, 0, 0), ZYNK_ABC(ZYNK_OP_RETURN, 1, 0, 0)};
+    Value sf = zynkCreateFunction(&manager, "s", 0, 2, ret_code, 3, sk, 1);
+    zynkCompileFunction(&manager, sf);
+    ok = true;
+    for (int i = 0; i < 100; ++i) {
+        Value v = zynkCallValue(&manager, global, sf, 0, NULL);
+        ok = ok && v.type == ZYNK_OBJ && v.as.obj->type == ObjString;
+        zynk_release(v, &manager);
+    }
+    assert_true(ok && sk[0].as.obj->ref_count == 2, "LOADK y MOVE de un string retienen y sueltan bien");
+    zynk_release(sf, &manager);
+    assert_true(sk[0].as.obj->ref_count == 1, "liberar la función compilada suelta su constante");
+    assert_true(compiled_all, HAS_JIT ? "todas las funciones se compilaron" : "sin JIT zynkCompileFunction da false");
+
+    zynk_release(sk[0], &manager);
+    zynk_release(arr, &manager);
+    zynk_release(s, &manager);
+    freeZynkTable(&manager, global->local);
+    free(global);
+    return test_end();
+}
@@ -0,0 +1,75 @@
+// Pruebas de zynkTableGetMany / SetMany / NewMany: lotes más grandes que un
+// bloque de 32, nombres repetidos o NULL, y los nombres compartidos de un
+// NewMany que se liberan con el último.
+// Compilar: gcc test-many.c src/libzynk.a -o test-many
+#include "test.h"
+
+#define N 100
+
+int main() {
+    printf("--- Pruebas de operaciones por lotes ---\n");
+    test_init(16 * 1024 * 1024, 8192);
+
+    static char storage[N][16];
+    const char *names[N];
+    Value values[N], out[N];
+    for (int i = 0; i < N; ++i) {
+        snprintf(storage[i], sizeof(storage[i]), "lote%d", i);
+        names[i] = storage[i];
+        values[i] = zynkNumber(i);
+    }
+
+    section("zynkTableNewMany");
+    ZynkEnv *env = new_env(16);
+    zynkTableNew(env, "lote5", zynkNumber(-5), &manager);
+    assert_true(zynkTableNewMany(env, names, values, N, &manager) == N - 1, "inserta todos menos el que ya estaba");
+    assert_equal_number(zynkTableGet(env, "lote5"), -5, "el que ya estaba conserva su valor");
+    assert_equal_number(zynkTableGet(env, "lote99"), 99, "el último del lote");
+    ZynkEnvEntry *entry = zynkFindEntry(env, "lote42");
+    assert_true(entry != NULL && entry->owner == ZYNK_NAME_BATCHED, "los nombres viven en el bloque del lote");
+    const char *twice[] = {"doble", "doble", NULL, "otro"};
+    Value twice_values[] = {zynkNumber(1), zynkNumber(2), zynkNumber(3), zynkNumber(4)};
+    assert_true(zynkTableNewMany(env, twice, twice_values, 4, &manager) == 2, "un nombre repetido en el lote y NULL no cuentan");
+    assert_equal_number(zynkTableGet(env, "doble"), 1, "gana la primera aparición");
+
+    section("zynkTableGetMany");
+    const char *lookups[N];
+    for (int i = 0; i < N; ++i) lookups[i] = (i % 10 == 9) ? "no_existe" : names[i];
+    zynkTableGetMany(env, lookups, N, out);
+    bool ok = true;
+    for (int i = 0; i < N; ++i) {
+        if (i % 10 == 9) ok = ok && out[i].type == ZYNK_NULL;
+        else ok = ok && out[i].as.number == (i == 5 ? -5 : i);
+    }
+    assert_true(ok, "100 búsquedas en bloques de 32, las ausentes dan null");
+    ZynkEnv inner;
+    inner.local = NULL;
+    zynkEnvInit(&inner, 16, env, &manager);
+    zynkTableNew(&inner, "lote1", zynkNumber(1000), &manager);
+    zynkTableGetMany(&inner, names, 3, out);
+    assert_true(out[0].as.number == 0 && out[1].as.number == 1000 && out[2].as.number == 2, "busca en los entornos de fuera y respeta los tapados");
+
+    section("zynkTableSetMany");
+    Value doubled[N];
+    for (int i = 0; i < N; ++i) doubled[i] = zynkNumber(i * 2);
+    assert_true(zynkTableSetMany(&manager, env, lookups, doubled, N) == N - N / 10, "cambia las existentes, no crea las ausentes");
+    assert_is_null(zynkTableGet(env, "no_existe"), "no_existe sigue sin existir");
+    assert_equal_number(zynkTableGet(env, "lote50"), 100, "lote50 cambiado");
+    assert_true(zynkTableSetMany(&manager, &inner, names, doubled, 2) == 2 && zynkTableGet(&inner, "lote1").as.number == 2 &&
+                zynkTableGet(env, "lote1").as.number == 2, "SetMany escribe en el entorno más cercano");
+
+    section("nombres compartidos");
+    ok = true;
+    for (int i = 0; i < N; ++i) {
+        if (i != 5) ok = ok && zynkTableDelete(env, names[i], &manager);
+    }
+    assert_true(ok, "borrar todos los nombres del lote");
+    assert_true(zynkTableNewMany(env, names, values, N, &manager) == N - 1, "el mismo lote se vuelve a insertar");
+    for (int i = 0; i < N; i += 3) zynkTableDelete(env, names[i], &manager);
+    assert_equal_number(zynkTableGet(env, "lote31"), 31, "los demás nombres del bloque siguen bien");
+
+    freeZynkTable(&manager, inner.local);
+    freeZynkTable(&manager, env->local);
+    free(env);
+    return test_end();
+}
@@ -0,0 +1,72 @@
+// Pruebas de ObjMap: altas, bajas, orden de inserción, crecimiento e
+// identidad de las claves que son arrays.
+// Compilar: gcc test-map.c src/libzynk.a -o test-map
+#include "test.h"
+
+int main() {
+    printf("--- Pruebas de ObjMap ---\n");
+    test_init(8 * 1024 * 1024, 4096);
+
+    section("zynkMapSet / zynkMapGet");
+    Value map = zynkCreateMap(&manager, 0);
+    Value name = zynkCreateString(&manager, "nombre");
+    assert_true(zynkMapSet(&manager, map, name, zynkNumber(1)), "zynkMapSet: clave string nueva");
+    assert_true(zynkMapSet(&manager, map, zynkNumber(2), zynkBool(true)), "zynkMapSet: clave numérica");
+    Value same_name = zynkCreateString(&manager, "nombre");
+    assert_equal_number(zynkMapGet(map, same_name), 1, "zynkMapGet: un string igual encuentra la clave");
+    assert_equal_bool(zynkMapGet(map, zynkNumber(2)), true, "zynkMapGet: clave numérica");
+    assert_true(zynkMapGet(map, zynkNumber(-0.0)).type == ZYNK_NULL, "zynkMapGet: clave ausente da null");
+    zynkMapSet(&manager, map, zynkNumber(0), zynkNumber(5));
+    assert_equal_number(zynkMapGet(map, zynkNumber(-0.0)), 5, "zynkMapGet: -0 y 0 son la misma clave");
+    zynkMapSet(&manager, map, same_name, zynkNumber(10));
+    assert_equal_number(zynkMapGet(map, name), 10, "zynkMapSet: reemplaza el valor de una clave existente");
+    assert_true(map.as.obj->obj.map->len == 3, "zynkMapSet: el reemplazo no añade entradas");
+
+    section("zynkMapDelete y orden de inserción");
+    assert_true(zynkMapDelete(&manager, map, zynkNumber(2)), "zynkMapDelete: clave existente");
+    assert_true(!zynkMapDelete(&manager, map, zynkNumber(2)), "zynkMapDelete: la segunda vez falla");
+    assert_true(!zynkMapHas(map, zynkNumber(2)), "zynkMapHas: la clave borrada ya no está");
+    zynkMapSet(&manager, map, zynkNumber(2), zynkNumber(20));
+    Value keys = zynkMapKeys(&manager, map);
+    ZynkArray *k = keys.as.obj->obj.array;
+    assert_true(k->len == 3, "zynkMapKeys: tres claves");
+    assert_true(k->len == 3 && zynkValuesEqual(k->array[0], name) && k->array[1].as.number == 0 &&
+                k->array[2].as.number == 2, "zynkMapKeys: orden de inserción, la reinsertada al final");
+    zynk_release(keys, &manager);
+    uint32_t cursor = 0, seen = 0;
+    Value key, value;
+    while (zynkMapNext(map, &cursor, &key, &value)) seen++;
+    assert_true(seen == 3, "zynkMapNext: recorre las entradas vivas");
+
+    section("crecimiento");
+    Value big = zynkCreateMap(&manager, 0);
+    bool ok = true;
+    for (int i = 0; i < 1000; ++i) ok = ok && zynkMapSet(&manager, big, zynkNumber(i), zynkNumber(i * 2));
+    for (int i = 0; i < 1000; i += 2) ok = ok && zynkMapDelete(&manager, big, zynkNumber(i));
+    for (int i = 0; i < 1000; ++i) {
+        Value v = zynkMapGet(big, zynkNumber(i));
+        ok = ok && (i % 2 == 0 ? v.type == ZYNK_NULL : v.as.number == i * 2);
+    }
+    assert_true(ok, "1000 claves con la mitad borradas se encuentran tras crecer");
+
+    section("claves array por identidad");
+    Value arr = zynkCreateArray(&manager, 1);
+    zynkArrayPush(&manager, arr, zynkNumber(1));
+    zynkMapSet(&manager, map, arr, zynkNumber(99));
+    for (int i = 0; i < 40; ++i) zynkArrayPush(&manager, arr, zynkNumber(i));
+    assert_true(zynkMapHas(map, arr), "zynkMapHas: el array sigue siendo clave después de crecer");
+    ZynkEnv *env = new_env(0);
+    init_native_funcs(&manager, env);
+    Value copy = call_native(env, "copy", 1, &arr);
+    assert_true(!zynkMapHas(map, copy), "zynkMapHas: una copia (mismo buffer compartido) es otra clave");
+    zynkArraySet(&manager, arr, zynkNumber(0), zynkNumber(7)); // deja de compartir el buffer
+    assert_equal_number(zynkMapGet(map, arr), 99, "zynkMapGet: el array sigue siendo clave tras dejar de compartir");
+    zynk_release(copy, &manager);
+
+    zynk_release(name, &manager);
+    zynk_release(same_name, &manager);
+    zynk_release(map, &manager);
+    zynk_release(big, &manager);
+    zynk_release(arr, &manager);
+    return test_end();
+}
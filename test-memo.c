@@ -0,0 +1,156 @@
+// Pruebas de memoize: aciertos, LRU, invalidación y que los argumentos y
+// resultados mutables nunca compartan estado con la caché.
+// Compilar: gcc test-memo.c src/libzynk.a -o test-memo
+#include "test.h"
+
+static uint32_t calls;
+
+static Value square(ArenaManager *m, ZynkEnv *env, ZynkArray *args) {
+    (void)m; (void)env;
+    calls++;
+    return zynkNumber(args->array[0].as.number * args->array[0].as.number);
+}
+
+// entradas del map que recibe
+static Value map_size(ArenaManager *m, ZynkEnv *env, ZynkArray *args) {
+    (void)m; (void)env;
+    calls++;
+    return zynkNumber(args->array[0].as.obj->obj.map->len);
+}
+
+static Value greeting(ArenaManager *m, ZynkEnv *env, ZynkArray *args) {
+    (void)env; (void)args;
+    calls++;
+    return zynkCreateString(m, "hola");
+}
+
+static Value new_map(ArenaManager *m, ZynkEnv *env, ZynkArray *args) {
+    (void)env; (void)args;
+    calls++;
+    return zynkCreateMap(m, 0);
+}
+
+// suma los elementos del array, o los bytes del string
+static Value total(ArenaManager *m, ZynkEnv *env, ZynkArray *args) {
+    (void)m; (void)env;
+    calls++;
+    Value val = args->array[0];
+    double sum = 0;
+    if (val.as.obj->type == ObjString) {
+        for (uint32_t i = 0; i < val.as.obj->obj.string->len; ++i) sum += (uint8_t)val.as.obj->obj.string->string[i];
+    } else {
+        ZynkArray *a = val.as.obj->obj.array;
+        for (uint32_t i = 0; i < a->len; ++i) sum += a->array[i].as.number;
+    }
+    return zynkNumber(sum);
+}
+
+// fib(n) recursiva a través del entorno, así pasa por su propia caché
+static Value fib(ArenaManager *m, ZynkEnv *env, ZynkArray *args) {
+    (void)m;
+    calls++;
+    double n = args->array[0].as.number;
+    if (n < 2) return zynkNumber(n);
+    Value a = zynkNumber(n - 1), b = zynkNumber(n - 2);
+    return zynkNumber(call_native(env, "fib", 1, &a).as.number + call_native(env, "fib", 1, &b).as.number);
+}
+
+static Value memoized(ZynkEnv *env, const char *name, ZynkFuncPtr ptr, uint32_t capacity) {
+    Value func = zynkCreateNativeFunction(&manager, name, ptr);
+    zynkMemoEnable(&manager, func, capacity);
+    zynkTableNew(env, name, func, &manager);
+    return func;
+}
+
+int main() {
+    printf("--- Pruebas de memoize ---\n");
+    test_init(8 * 1024 * 1024, 4096);
+    ZynkEnv *env = new_env(0);
+    init_native_funcs(&manager, env);
+
+    section("aciertos y LRU");
+    Value sq = memoized(env, "square", (ZynkFuncPtr)square, 2);
+    Value three = zynkNumber(3);
+    calls = 0;
+    call_native(env, "square", 1, &three);
+    assert_equal_number(call_native(env, "square", 1, &three), 9, "square(3)");
+    assert_true(calls == 1, "la segunda llamada sale de la caché");
+    Value zero = zynkNumber(0), neg_zero = zynkNumber(-0.0);
+    call_native(env, "square", 1, &zero);
+    call_native(env, "square", 1, &neg_zero);
+    assert_true(calls == 3, "-0 y 0 son claves distintas");
+    call_native(env, "square", 1, &three);
+    assert_true(calls == 4, "con capacidad 2 la entrada más antigua se desaloja");
+    ZynkMemoStats stats;
+    zynkMemoGetStats(sq, &stats);
+    assert_true(stats.hits == 1 && stats.misses == 4 && stats.evictions == 2 && stats.len == 2, "estadísticas");
+    zynkMemoInvalidate(&manager, sq);
+    call_native(env, "square", 1, &three);
+    assert_true(calls == 5, "zynkMemoInvalidate vacía la caché");
+
+    section("fib recursiva");
+    memoized(env, "fib", (ZynkFuncPtr)fib, 0);
+    calls = 0;
+    Value ninety = zynkNumber(90);
+    assert_equal_number(call_native(env, "fib", 1, &ninety), 2880067194370816120.0, "fib(90)");
+    assert_true(calls == 91, "cada n se calcula una vez");
+
+    section("argumentos mutables");
+    memoized(env, "map_size", (ZynkFuncPtr)map_size, 0);
+    Value map = zynkCreateMap(&manager, 0);
+    calls = 0;
+    assert_equal_number(call_native(env, "map_size", 1, &map), 0, "map vacío");
+    zynkMapSet(&manager, map, zynkNumber(1), zynkNumber(1));
+    assert_equal_number(call_native(env, "map_size", 1, &map), 1, "tras zynkMapSet la llamada ve la entrada nueva");
+    Value ms = zynkTableGet(env, "map_size");
+    zynkMemoGetStats(ms, &stats);
+    assert_true(calls == 2 && stats.skipped == 2 && stats.len == 0, "las llamadas con un map no se guardan");
+
+    memoized(env, "total", (ZynkFuncPtr)total, 0);
+    Value arr = zynkCreateArray(&manager, 2);
+    zynkArrayPush(&manager, arr, zynkNumber(1));
+    zynkArrayPush(&manager, arr, zynkNumber(2));
+    call_native(env, "total", 1, &arr);
+    zynkArraySet(&manager, arr, zynkNumber(0), zynkNumber(10));
+    assert_equal_number(call_native(env, "total", 1, &arr), 12, "cambiar el array argumento da otra clave");
+    Value str = zynkCreateString(&manager, "ab");
+    calls = 0;
+    call_native(env, "total", 1, &str);
+    str.as.obj->obj.string->string[0] = 'b'; // cambio en el sitio
+    assert_equal_number(call_native(env, "total", 1, &str), 'b' + 'b', "cambiar el string argumento da otra clave");
+    assert_true(calls == 2, "el string guardado es una copia");
+
+    Value holder = zynkCreateArray(&manager, 1);
+    zynkArrayPush(&manager, holder, map);
+    uint32_t before = calls;
+    call_native(env, "total", 1, &holder);
+    call_native(env, "total", 1, &holder);
+    assert_true(calls == before + 2, "un map dentro de un array tampoco se guarda");
+
+    section("resultados mutables");
+    memoized(env, "greeting", (ZynkFuncPtr)greeting, 0);
+    calls = 0;
+    Value first = call_native(env, "greeting", 0, NULL);
+    first.as.obj->obj.string->string[0] = 'X';
+    Value second = call_native(env, "greeting", 0, NULL);
+    assert_equal_string(second, "hola", "cambiar un resultado string no llega a la caché");
+    Value third = call_native(env, "greeting", 0, NULL);
+    assert_true(calls == 1 && second.as.obj != third.as.obj, "cada acierto da su propio string");
+
+    memoized(env, "new_map", (ZynkFuncPtr)new_map, 0);
+    calls = 0;
+    Value map_a = call_native(env, "new_map", 0, NULL);
+    zynkMapSet(&manager, map_a, zynkNumber(1), zynkNumber(1));
+    Value map_b = call_native(env, "new_map", 0, NULL);
+    assert_true(calls == 2 && map_b.as.obj != map_a.as.obj && map_b.as.obj->obj.map->len == 0,
+                "un resultado map no se comparte");
+
+    Value memo_stats = zynkTableGet(env, "map_size");
+    Value stats_map = call_native(env, "memo_stats", 1, &memo_stats);
+    Value key = zynkCreateString(&manager, "skipped");
+    assert_equal_number(zynkMapGet(stats_map, key), 2, "memo_stats: incluye skipped");
+
+    Value values[] = {map, arr, str, holder, first, second, third, map_a, map_b, stats_map, key};
+    for (int i = 0; i < 11; ++i) zynk_release(values[i], &manager);
+    return test_end();
+}
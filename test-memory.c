@@ -0,0 +1,110 @@
+// Pruebas de zynk_cpy, zynk_move, zynk_strcmp y zynk_len contra memcpy,
+// memmove, memcmp y strlen, en todas las longitudes y alineaciones cortas,
+// y con cadenas que acaban justo antes de una página protegida.
+// Compilar: gcc test-memory.c src/libzynk.a -o test-memory
+#define _DEFAULT_SOURCE
+#include "test.h"
+#ifdef ZYNK_POSIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#define SIZE 1200
+
+static uint8_t src[SIZE + 128], dst[SIZE + 128], ref[SIZE + 128];
+
+static void fill(uint8_t *p, size_t n, unsigned seed) {
+    for (size_t i = 0; i < n; ++i) p[i] = (uint8_t)(i * 131 + seed * 7 + 1);
+}
+
+int main() {
+    printf("--- Pruebas de las primitivas de bytes ---\n");
+    test_init(1024 * 1024, 256);
+    zynk_memory_init();
+    printf("implementación: %s\n", zynk_memory_impl());
+
+    section("zynk_cpy");
+    bool ok = true;
+    for (uint32_t len = 0; len <= SIZE && ok; len += (len < 300 ? 1 : 37)) {
+        for (int s = 0; s < 64 && ok; s += 7) {
+            for (int d = 0; d < 64 && ok; d += 5) {
+                fill(src, sizeof(src), len);
+                memset(dst, 0xEE, sizeof(dst));
+                memset(ref, 0xEE, sizeof(ref));
+                zynk_cpy(dst + d, src + s, len);
+                memcpy(ref + d, src + s, len);
+                ok = memcmp(dst, ref, sizeof(dst)) == 0;
+            }
+        }
+    }
+    assert_true(ok, "igual que memcpy y sin escribir fuera del destino");
+    assert_true(!zynk_cpy(NULL, src, 1) && !zynk_cpy(dst, NULL, 1), "punteros NULL devuelven false");
+
+    section("zynk_move");
+    ok = true;
+    for (uint32_t len = 0; len <= SIZE - 200 && ok; len += (len < 300 ? 1 : 37)) {
+        for (int shift = -70; shift <= 70 && ok; shift += 3) {
+            fill(dst, sizeof(dst), len);
+            memcpy(ref, dst, sizeof(dst));
+            zynk_move(dst + 96 + shift, dst + 96, len);
+            memmove(ref + 96 + shift, ref + 96, len);
+            ok = memcmp(dst, ref, sizeof(dst)) == 0;
+        }
+    }
+    assert_true(ok, "igual que memmove con solapes hacia delante y hacia atrás");
+
+    section("zynk_strcmp");
+    ok = true;
+    for (uint32_t len = 1; len <= SIZE && ok; len += (len < 300 ? 1 : 37)) {
+        fill(src, len, 1);
+        memcpy(dst + 3, src, len);
+        ok = zynk_strcmp((const char *)src, (const char *)dst + 3, len);
+        for (uint32_t at = 0; at < len && ok; at += 1 + len / 9) {
+            dst[3 + at] ^= 0x80;
+            ok = !zynk_strcmp((const char *)src, (const char *)dst + 3, len);
+            dst[3 + at] ^= 0x80;
+        }
+    }
+    assert_true(ok, "iguales en todas las longitudes, distinto en cualquier posición");
+    assert_true(zynk_strcmp("abc", "abd", 0), "longitud 0 siempre es igual");
+
+    section("zynk_len");
+    ok = true;
+    for (uint32_t len = 0; len < SIZE && ok; len += (len < 300 ? 1 : 37)) {
+        for (int s = 0; s < 32 && ok; s += 3) {
+            memset(src, 'x', sizeof(src));
+            src[s + len] = '\0';
+            ok = zynk_len((const char *)src + s, '\0') == len && zynk_len((const char *)src + s, '\0') == strlen((const char *)src + s);
+        }
+    }
+    assert_true(ok, "igual que strlen en todas las longitudes y alineaciones");
+    assert_true(zynk_len("clave=valor", '=') == 5, "otro carácter de fin");
+    assert_true(zynk_len(NULL, '\0') == 0, "NULL mide 0");
+
+#ifdef ZYNK_POSIX
+    section("lecturas junto a una página protegida");
+    long page = sysconf(_SC_PAGESIZE);
+    uint8_t *pages = mmap(NULL, (size_t)page * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    assert_true(pages != MAP_FAILED, "dos páginas mapeadas");
+    if (pages != MAP_FAILED) {
+        mprotect(pages + page, (size_t)page, PROT_NONE);
+        uint8_t *end = pages + page;
+        ok = true;
+        for (uint32_t len = 0; len < 200 && ok; ++len) {
+            memset(pages, 'y', (size_t)page);
+            end[-1] = '\0';
+            ok = zynk_len((const char *)end - 1 - len, '\0') == len;
+            if (len > 0) {
+                memcpy(dst, end - len, len);
+                ok = ok && zynk_strcmp((const char *)end - len, (const char *)dst, len);
+                zynk_cpy(dst, end - len, len);
+                zynk_move((uint8_t *)end - len - 1, end - len, len);
+            }
+        }
+        assert_true(ok, "zynk_len, zynk_strcmp, zynk_cpy y zynk_move no leen la página siguiente");
+        munmap(pages, (size_t)page * 2);
+    }
+#endif
+
+    return test_end();
+}
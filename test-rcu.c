@@ -0,0 +1,193 @@
+// Pruebas de los entornos concurrentes (RCU): la semilla del hash que se
+// saca una sola vez aunque varios hilos hagan su primer hash a la vez, y
+// lectores sin cerrojo que solo ven valores enteros mientras un escritor
+// cambia, añade y borra nombres, también a través de las cachés, y que
+// se queda sin memoria dentro de su propia lectura.
+// Compilar: gcc -pthread test-rcu.c src/libzynk.a -o test-rcu
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <stdatomic.h>
+#include "test.h"
+
+#define THREADS 8
+#define N 512
+#define ROUNDS 4000 // cada escritura copia un camino del trie, y las arenas se gastan
+
+static char names[N][32];
+static ZynkEnv env;
+static atomic_bool running;
+static atomic_bool go;
+static atomic_long bad_reads;
+
+static uint64_t seeds[THREADS];
+static uint32_t hashes[THREADS];
+
+static void *first_hash(void *arg) {
+    int t = (int)(intptr_t)arg;
+    while (!atomic_load(&go)) {
+    }
+    hashes[t] = zynk_hash_string("primer hash");
+    seeds[t] = zynk_hash_get_seed();
+    return NULL;
+}
+
+// los nombres fijos valen i + N * vuelta, nunca otra cosa
+static void *reader(void *arg) {
+    ZynkRcuReader *slot = arg;
+    unsigned seed = 1;
+    while (atomic_load_explicit(&running, memory_order_relaxed)) {
+        zynkRcuReadLock(slot);
+        for (int j = 0; j < 64; ++j) {
+            seed = seed * 1103515245 + 12345;
+            int i = (int)((seed >> 8) % N);
+            Value v = zynkTableGet(&env, names[i]);
+            if (v.type != ZYNK_NUMBER || (long)v.as.number % N != i) atomic_fetch_add(&bad_reads, 1);
+        }
+        Value extra = zynkTableGet(&env, "extra");
+        if (extra.type != ZYNK_NULL && extra.type != ZYNK_NUMBER) atomic_fetch_add(&bad_reads, 1);
+        zynkRcuReadUnlock(slot);
+    }
+    return NULL;
+}
+
+int main() {
+    printf("--- Pruebas de entornos concurrentes ---\n");
+    test_init(64 * 1024 * 1024, 65536);
+
+    section("semilla del hash");
+    pthread_t ids[THREADS];
+    for (int t = 0; t < THREADS; ++t) pthread_create(&ids[t], NULL, first_hash, (void *)(intptr_t)t);
+    atomic_store(&go, true);
+    for (int t = 0; t < THREADS; ++t) pthread_join(ids[t], NULL);
+    bool same = true;
+    for (int t = 1; t < THREADS; ++t) same = same && seeds[t] == seeds[0] && hashes[t] == hashes[0];
+    assert_true(same, "todos los hilos ven la misma semilla y el mismo hash");
+    assert_true(zynk_hash_get_seed() == seeds[0], "y no cambia después");
+
+    section("registro");
+    env.local = NULL;
+    assert_true(zynkEnvInitConcurrent(&env, NULL, &manager), "zynkEnvInitConcurrent");
+    ZynkEnv *plain = new_env(16);
+    assert_true(zynkRcuRegister(plain) == NULL, "una tabla normal no admite lectores");
+    ZynkRcuReader *slots[ZYNK_RCU_READERS];
+    int taken = 0;
+    while (taken < ZYNK_RCU_READERS && (slots[taken] = zynkRcuRegister(&env)) != NULL) taken++;
+    assert_true(taken == ZYNK_RCU_READERS && zynkRcuRegister(&env) == NULL, "hay ZYNK_RCU_READERS huecos");
+    zynkRcuUnregister(slots[0]);
+    assert_true((slots[0] = zynkRcuRegister(&env)) != NULL, "un hueco liberado se reutiliza");
+    for (int i = 0; i < taken; ++i) zynkRcuUnregister(slots[i]);
+
+    section("lectores y un escritor");
+    ZynkRcuReader *writer = zynkRcuRegister(&env);
+    bool ok = true;
+    zynkRcuReadLock(writer);
+    for (int i = 0; i < N; ++i) {
+        snprintf(names[i], sizeof(names[i]), "conc%d", i);
+        ok = ok && zynkTableNew(&env, names[i], zynkNumber(i), &manager);
+    }
+    zynkRcuReadUnlock(writer);
+    assert_true(ok, "512 altas");
+    ZynkRcuReader *reader_slots[THREADS];
+    atomic_store(&running, true);
+    for (int t = 0; t < THREADS; ++t) {
+        reader_slots[t] = zynkRcuRegister(&env);
+        pthread_create(&ids[t], NULL, reader, reader_slots[t]);
+    }
+    for (int r = 1; r <= ROUNDS; ++r) {
+        int i = r % N;
+        zynkRcuReadLock(writer);
+        ok = ok && zynkTableSet(&manager, &env, names[i], zynkNumber(i + (double)N * r));
+        if (r % 2) ok = ok && zynkTableNew(&env, "extra", zynkNumber(r), &manager);
+        else ok = ok && zynkTableDelete(&env, "extra", &manager);
+        zynkRcuReadUnlock(writer);
+    }
+    atomic_store(&running, false);
+    for (int t = 0; t < THREADS; ++t) {
+        pthread_join(ids[t], NULL);
+        zynkRcuUnregister(reader_slots[t]);
+    }
+    assert_true(ok, "4000 cambios, altas y bajas del escritor");
+    assert_true(atomic_load(&bad_reads) == 0, "los lectores solo vieron valores válidos");
+    zynkRcuReadLock(writer);
+    assert_equal_number(zynkTableGet(&env, names[ROUNDS % N]), ROUNDS % N + (double)N * ROUNDS, "el último cambio queda");
+    assert_is_null(zynkTableGet(&env, "extra"), "y la última baja también");
+    zynkRcuReadUnlock(writer);
+
+    section("cachés sobre una tabla concurrente");
+    ZynkEnv inner;
+    inner.local = NULL;
+    zynkEnvInit(&inner, 16, &env, &manager);
+    ZynkLookupCache cache;
+    zynkLookupCacheInit(&cache);
+    zynkRcuReadLock(writer);
+    assert_true(zynkTableSetCached(&manager, &inner, names[1], zynkNumber(-1), &cache), "SetCached con la caché vacía");
+    assert_equal_number(zynkTableGetCached(&inner, names[1], &cache), -1, "escribe en la tabla concurrente");
+    assert_true(cache.env == NULL, "sin guardar la entrada");
+    assert_true(zynkTableSetCached(&manager, &inner, names[1], zynkNumber(1), &cache) && zynkTableGet(&env, names[1]).as.number == 1,
+                "y la siguiente vuelve a buscar");
+    // contador = contador + 1 con GETGLOBAL y SETGLOBAL
+    zynkTableNew(&env, "contador", zynkNumber(0), &manager);
+    Value gk[] = {zynkCreateString(&manager, "contador"), zynkNumber(1)};
+    uint32_t inc_code[] = {ZYNK_ABX(ZYNK_OP_GETGLOBAL, 0, 0), ZYNK_ABX(ZYNK_OP_LOADK, 1, 1), ZYNK_ABC(ZYNK_OP_ADD, 0, 0, 1),
+                           ZYNK_ABX(ZYNK_OP_SETGLOBAL, 0, 0), ZYNK_ABC(ZYNK_OP_RETURN, 0, 0, 0)};
+    Value inc = zynkCreateFunction(&manager, "inc", 0, 2, inc_code, 5, gk, 2);
+    zynk_release(gk[0], &manager);
+    for (int i = 0; i < 10; ++i) zynkCallValue(&manager, &inner, inc, 0, NULL);
+    assert_equal_number(zynkTableGet(&env, "contador"), 10, "SETGLOBAL de la VM en una tabla concurrente");
+    zynkRcuReadUnlock(writer);
+    zynkRcuUnregister(writer);
+    zynk_release(inc, &manager);
+    freeZynkTable(&manager, inner.local);
+
+    section("sin memoria");
+    // dentro de su propia lectura el escritor no deja liberar ninguna raíz:
+    // si no hay memoria para apuntar la vieja, la alta falla en vez de
+    // esperarse a sí mismo
+    ArenaManager small;
+    size_t small_size = 1024 * 1024, small_arenas = 65536;
+    uint8_t *small_memory = malloc(small_size);
+    Arena *small_list = malloc(sizeof(Arena) * small_arenas);
+    sysarena_init(&small, small_memory, small_list, small_size, small_arenas);
+    ZynkEnv tight;
+    tight.local = NULL;
+    zynkEnvInitConcurrent(&tight, NULL, &small);
+    ZynkRcu *rcu = tight.local->rcu;
+    ZynkRcuReader *own = zynkRcuRegister(&tight);
+    char name[32];
+    int added = 0;
+    zynkRcuReadLock(own);
+    ok = true;
+    while (ok && (rcu->retired_cap < 256 || rcu->retired_len < rcu->retired_cap)) {
+        snprintf(name, sizeof(name), "lleno%d", added);
+        ok = zynkTableNew(&tight, name, zynkNumber(added), &small);
+        added += ok;
+    }
+    assert_true(ok, "la lista de raíces retiradas se llena");
+    // sysarena no reutiliza lo liberado: se gasta todo menos 4 KB, donde
+    // caben los nodos de una alta pero no una lista el doble de grande
+    size_t left = 0;
+    for (size_t i = 0; i < small.max_arenas; ++i) {
+        if (small.arenas[i].in_use) left += small.arenas[i].size - small.arenas[i].used;
+    }
+    assert_true(left > 4096 && sysarena_alloc(&small, left - 4096) != NULL, "queda poca memoria");
+    uint32_t retired = rcu->retired_len;
+    assert_true(!zynkTableNew(&tight, "una_mas", zynkNumber(-1), &small), "sin memoria para retirar la raíz la alta falla");
+    assert_true(rcu->retired_len == retired, "sin publicar nada");
+    assert_is_null(zynkTableGet(&tight, "una_mas"), "la que falla no queda");
+    ok = true;
+    for (int i = 0; i < added; ++i) {
+        snprintf(name, sizeof(name), "lleno%d", i);
+        ok = ok && zynkTableGet(&tight, name).as.number == i;
+    }
+    assert_true(ok, "y las anteriores siguen ahí");
+    zynkRcuReadUnlock(own);
+    zynkRcuUnregister(own);
+    freeZynkTable(&small, tight.local);
+    free(small_memory);
+    free(small_list);
+
+    freeZynkTable(&manager, env.local);
+    freeZynkTable(&manager, plain->local);
+    free(plain);
+    return test_end();
+}
@@ -0,0 +1,111 @@
+// Pruebas del rehash incremental: mientras los slots viejos se mueven, las
+// búsquedas, altas, cambios y bajas ven las dos mitades de la tabla.
+// Compilar: gcc test-rehash.c src/libzynk.a -o test-rehash
+#include "test.h"
+
+static void key_name(char *out, int i) {
+    snprintf(out, 32, "k%d", i);
+}
+
+// valor esperado de cada clave, NAN si no debe estar
+static double expected[4000];
+
+static bool all_match(ZynkEnv *env, int n) {
+    char name[32];
+    for (int i = 0; i < n; ++i) {
+        key_name(name, i);
+        Value v = zynkTableGet(env, name);
+        if (expected[i] != expected[i] ? v.type != ZYNK_NULL : (v.type != ZYNK_NUMBER || v.as.number != expected[i])) return false;
+    }
+    return true;
+}
+
+int main() {
+    printf("--- Pruebas del rehash incremental ---\n");
+    test_init(32 * 1024 * 1024, 16384);
+    char name[32];
+    for (int i = 0; i < 4000; ++i) expected[i] = 0.0 / 0.0;
+
+    section("crecer poco a poco");
+    ZynkEnv *env = new_env(16);
+    ZynkEnvTable *t = env->local;
+    bool seen_rehash = false, ok = true;
+    int n = 0;
+    for (; n < 3000; ++n) {
+        key_name(name, n);
+        ok = ok && zynkTableNew(env, name, zynkNumber(n), &manager);
+        expected[n] = n;
+        if (t->old_ctrl != NULL) {
+            seen_rehash = true;
+            // en medio del rehash todo sigue a la vista
+            if (n % 97 == 0) ok = ok && all_match(env, n + 1);
+        }
+    }
+    assert_true(ok, "3000 altas, todas visibles también a mitad de cada rehash");
+    assert_true(seen_rehash, "hubo rehash incrementales");
+    assert_true(t->capacity >= 3000 * 100 / TABLE_MAX_LOAD, "la capacidad respeta TABLE_MAX_LOAD");
+
+    section("operaciones durante un rehash");
+    // forzar un rehash y parar en medio
+    while (t->old_ctrl == NULL) {
+        key_name(name, n);
+        zynkTableNew(env, name, zynkNumber(n), &manager);
+        expected[n] = n;
+        n++;
+    }
+    size_t old_before = t->old_count;
+    assert_true(old_before > TABLE_REHASH_STEP, "quedan slots viejos por mover");
+    // claves que siguen en los slots viejos
+    ok = true;
+    int changed = 0, deleted = 0;
+    for (size_t i = 0; i < t->old_capacity && (changed < 3 || deleted < 3); ++i) {
+        uint8_t c = t->old_ctrl[i];
+        if (c == ZYNK_CTRL_EMPTY || c == ZYNK_CTRL_DELETED) continue;
+        ZynkEnvEntry *e = &t->old_entries[i];
+        int k = atoi(e->name + 1);
+        if (changed < 3) {
+            ok = ok && !zynkTableNew(env, e->name, zynkNumber(0), &manager);
+            ok = ok && zynkTableSet(&manager, env, e->name, zynkNumber(-k));
+            expected[k] = -k;
+            changed++;
+        } else {
+            key_name(name, k);
+            ok = ok && zynkTableDelete(env, name, &manager);
+            expected[k] = 0.0 / 0.0;
+            deleted++;
+        }
+    }
+    assert_true(ok, "New rechaza, Set cambia y Delete borra claves aún en los slots viejos");
+    assert_true(all_match(env, n), "todo cuadra a mitad del rehash");
+    for (int i = 0; i < 100000 && t->old_ctrl != NULL; ++i) zynkTableSet(&manager, env, "k1", zynkNumber(1));
+    assert_true(t->old_ctrl == NULL && t->old_count == 0, "el rehash termina y suelta los arrays viejos");
+    assert_true(all_match(env, n), "todo cuadra al terminar");
+
+    section("lápidas");
+    // muchas altas y bajas con pocas claves vivas (menos del 40%): el
+    // rehash limpia lápidas sin doblar la capacidad
+    ZynkEnv *churn = new_env(64);
+    ZynkEnvTable *c = churn->local;
+    for (int i = 0; i < 20; ++i) {
+        key_name(name, i);
+        zynkTableNew(churn, name, zynkNumber(i), &manager);
+    }
+    size_t capacity = c->capacity;
+    ok = true;
+    for (int i = 20; i < 5000; ++i) {
+        key_name(name, i - 20);
+        ok = ok && zynkTableDelete(churn, name, &manager);
+        key_name(name, i);
+        ok = ok && zynkTableNew(churn, name, zynkNumber(i), &manager);
+    }
+    assert_true(ok && c->count == 20, "5000 vueltas de alta y baja");
+    assert_true(c->capacity == capacity, "la capacidad no crece con solo lápidas");
+    key_name(name, 4999);
+    assert_equal_number(zynkTableGet(churn, name), 4999, "la última clave se encuentra");
+
+    freeZynkTable(&manager, churn->local);
+    freeZynkTable(&manager, env->local);
+    free(churn);
+    free(env);
+    return test_end();
+}
@@ -0,0 +1,75 @@
+// Pruebas de las direcciones resueltas (zynkEnvResolve, GetAt, SetAt):
+// siguen valiendo mientras la tabla no mueve ni borra entradas.
+// Compilar: gcc test-resolve.c src/libzynk.a -o test-resolve
+#include "test.h"
+
+int main() {
+    printf("--- Pruebas de direcciones resueltas ---\n");
+    test_init(16 * 1024 * 1024, 8192);
+
+    ZynkEnv *global = new_env(64);
+    zynkTableNew(global, "g", zynkNumber(1), &manager);
+    zynkTableNew(global, "h", zynkNumber(2), &manager);
+    ZynkEnv local;
+    local.local = NULL;
+    zynkEnvInit(&local, 16, global, &manager);
+    zynkTableNew(&local, "x", zynkNumber(10), &manager);
+
+    section("resolver y leer");
+    ZynkEnvAddr ax, ag;
+    assert_true(zynkEnvResolve(&local, "x", &ax) && ax.depth == 0, "x en el entorno local");
+    assert_true(zynkEnvResolve(&local, "g", &ag) && ag.depth == 1, "g un nivel más arriba");
+    ZynkEnvAddr missing;
+    assert_true(!zynkEnvResolve(&local, "nada", &missing), "resolver un nombre ausente falla");
+    assert_equal_number(zynkEnvGetAt(&local, ax), 10, "zynkEnvGetAt local");
+    assert_equal_number(zynkEnvGetAt(&local, ag), 1, "zynkEnvGetAt del global");
+    assert_true(zynkEnvSetAt(&manager, &local, ag, zynkNumber(5)), "zynkEnvSetAt del global");
+    assert_equal_number(zynkTableGet(global, "g"), 5, "el global ve el cambio");
+
+    section("qué invalida una dirección");
+    zynkTableSet(&manager, global, "g", zynkNumber(6));
+    zynkTableNew(global, "nueva", zynkNumber(0), &manager);
+    assert_equal_number(zynkEnvGetAt(&local, ag), 6, "Set y New sin rehash no la invalidan");
+    zynkTableDelete(global, "h", &manager);
+    assert_is_null(zynkEnvGetAt(&local, ag), "un Delete en su tabla sí");
+    assert_true(!zynkEnvSetAt(&manager, &local, ag, zynkNumber(7)), "zynkEnvSetAt con una dirección vieja falla");
+    assert_equal_number(zynkTableGet(global, "g"), 6, "y no escribe nada");
+    assert_true(zynkEnvResolve(&local, "g", &ag), "se vuelve a resolver");
+    assert_equal_number(zynkEnvGetAt(&local, ag), 6, "la nueva dirección vale");
+    zynkTableDelete(&local, "x", &manager);
+    assert_equal_number(zynkEnvGetAt(&local, ag), 6, "un Delete en otra tabla no la invalida");
+
+    section("durante un rehash");
+    char name[32];
+    int n = 0;
+    while (global->local->old_ctrl == NULL) {
+        snprintf(name, sizeof(name), "relleno%d", n++);
+        zynkTableNew(global, name, zynkNumber(n), &manager);
+    }
+    assert_is_null(zynkEnvGetAt(&local, ag), "empezar un rehash invalida las direcciones");
+    // una clave que sigue en los slots viejos se resuelve a ellos
+    ZynkEnvAddr old_addr;
+    bool found_old = false;
+    for (int i = 0; i < n && !found_old; ++i) {
+        snprintf(name, sizeof(name), "relleno%d", i);
+        found_old = zynkEnvResolve(global, name, &old_addr) && old_addr.slot >= global->local->capacity;
+    }
+    assert_true(found_old, "una dirección puede apuntar a los slots viejos");
+    Value before = zynkEnvGetAt(global, old_addr);
+    assert_true(before.type == ZYNK_NUMBER && zynkEnvSetAt(&manager, global, old_addr, zynkNumber(-1)),
+                "GetAt y SetAt funcionan sobre los slots viejos");
+
+    section("entornos persistentes");
+    ZynkEnv persistent;
+    persistent.local = NULL;
+    zynkEnvInitPersistent(&persistent, NULL, &manager);
+    zynkTableNew(&persistent, "p", zynkNumber(1), &manager);
+    ZynkEnvAddr ap;
+    assert_true(!zynkEnvResolve(&persistent, "p", &ap), "una tabla HAMT no tiene direcciones");
+
+    freeZynkTable(&manager, persistent.local);
+    freeZynkTable(&manager, local.local);
+    freeZynkTable(&manager, global->local);
+    free(global);
+    return test_end();
+}
@@ -0,0 +1,109 @@
+// Pruebas de la búsqueda en cadenas: zynk_find/rfind/count comparadas con
+// una búsqueda ingenua (agujas cortas y de dos vías), split y replace.
+// Compilar: gcc test-search.c src/libzynk.a -o test-search
+#include "test.h"
+
+static int64_t naive_find(const uint8_t *hay, size_t hay_len, const uint8_t *needle, size_t needle_len) {
+    if (needle_len > hay_len) return -1;
+    for (size_t i = 0; i + needle_len <= hay_len; ++i)
+        if (memcmp(hay + i, needle, needle_len) == 0) return (int64_t)i;
+    return -1;
+}
+
+static int64_t naive_rfind(const uint8_t *hay, size_t hay_len, const uint8_t *needle, size_t needle_len) {
+    if (needle_len > hay_len) return -1;
+    for (size_t i = hay_len - needle_len + 1; i-- > 0;)
+        if (memcmp(hay + i, needle, needle_len) == 0) return (int64_t)i;
+    return -1;
+}
+
+static size_t naive_count(const uint8_t *hay, size_t hay_len, const uint8_t *needle, size_t needle_len) {
+    size_t count = 0, at = 0;
+    int64_t found;
+    while ((found = naive_find(hay + at, hay_len - at, needle, needle_len)) >= 0) {
+        count++;
+        at += (size_t)found + needle_len;
+    }
+    return count;
+}
+
+int main() {
+    printf("--- Pruebas de búsqueda en cadenas ---\n");
+    test_init(8 * 1024 * 1024, 4096);
+
+    section("zynk_find / zynk_rfind / zynk_count contra la búsqueda ingenua");
+    // alfabeto de dos letras para que haya muchas coincidencias parciales
+    uint8_t hay[600], needle[64];
+    srand(7);
+    bool ok_find = true, ok_rfind = true, ok_count = true;
+    for (int round = 0; round < 3000; ++round) {
+        size_t hay_len = (size_t)(rand() % (int)sizeof(hay));
+        size_t needle_len = 1 + (size_t)(rand() % (int)sizeof(needle));
+        for (size_t i = 0; i < hay_len; ++i) hay[i] = "ab"[rand() % 2];
+        if (hay_len >= needle_len && rand() % 2) {
+            // la mitad de las veces la aguja sale del pajar
+            memcpy(needle, hay + (size_t)rand() % (hay_len - needle_len + 1), needle_len);
+        } else {
+            for (size_t i = 0; i < needle_len; ++i) needle[i] = "ab"[rand() % 2];
+        }
+        ok_find = ok_find && zynk_find(hay, hay_len, needle, needle_len) == naive_find(hay, hay_len, needle, needle_len);
+        ok_rfind = ok_rfind && zynk_rfind(hay, hay_len, needle, needle_len) == naive_rfind(hay, hay_len, needle, needle_len);
+        ok_count = ok_count && zynk_count(hay, hay_len, needle, needle_len) == naive_count(hay, hay_len, needle, needle_len);
+    }
+    assert_true(ok_find, "zynk_find: 3000 casos aleatorios");
+    assert_true(ok_rfind, "zynk_rfind: 3000 casos aleatorios");
+    assert_true(ok_count, "zynk_count: 3000 casos aleatorios");
+    assert_true(zynk_memchr((const uint8_t *)"abcdefghijklmnopqrstuvwxyz", 26, 'y') == 24, "zynk_memchr: más allá del primer bloque");
+    assert_true(zynk_memchr((const uint8_t *)"abc", 3, 'z') == -1, "zynk_memchr: ausente da -1");
+    assert_true(zynk_find((const uint8_t *)"abc", 3, (const uint8_t *)"", 0) == 0, "zynk_find: aguja vacía en 0");
+
+    section("zynkStringFind / RFind / Count");
+    Value str = zynkCreateString(&manager, "uno, dos, tres, cuatro");
+    Value comma = zynkCreateString(&manager, ", ");
+    assert_equal_number(zynkStringFind(str, comma, 0), 3, "zynkStringFind: primera coma");
+    assert_equal_number(zynkStringFind(str, comma, 4), 8, "zynkStringFind: desde un desplazamiento");
+    assert_equal_number(zynkStringFind(str, comma, 1000), -1, "zynkStringFind: desplazamiento pasado el final da -1");
+    assert_equal_number(zynkStringRFind(str, comma), 14, "zynkStringRFind: última coma");
+    assert_equal_number(zynkStringCount(str, comma), 3, "zynkStringCount: tres comas");
+    assert_is_null(zynkStringFind(str, zynkNumber(1), 0), "zynkStringFind: la aguja no es string");
+
+    section("zynkStringSplit");
+    Value parts = zynkStringSplit(&manager, str, comma);
+    ZynkArray *p = parts.as.obj->obj.array;
+    assert_true(p->len == 4, "zynkStringSplit: cuatro trozos");
+    assert_equal_string(p->array[0], "uno", "zynkStringSplit: primer trozo");
+    assert_equal_string(p->array[3], "cuatro", "zynkStringSplit: último trozo");
+    Value kept = p->array[2];
+    zynk_retain(kept);
+    zynk_release(parts, &manager);
+    assert_equal_string(kept, "tres", "un trozo retenido sobrevive al array");
+    zynk_release(kept, &manager);
+    Value edges = zynkCreateString(&manager, ",a,,b,");
+    Value one = zynkCreateString(&manager, ",");
+    Value edge_parts = zynkStringSplit(&manager, edges, one);
+    ZynkArray *e = edge_parts.as.obj->obj.array;
+    assert_true(e->len == 5 && e->array[0].as.obj->obj.string->len == 0 && e->array[2].as.obj->obj.string->len == 0 &&
+                e->array[4].as.obj->obj.string->len == 0, "zynkStringSplit: trozos vacíos en los bordes y en medio");
+    zynk_release(edge_parts, &manager);
+    Value empty = zynkCreateString(&manager, "");
+    assert_is_null(zynkStringSplit(&manager, str, empty), "zynkStringSplit: delimitador vacío da null");
+
+    section("zynkStringReplace");
+    Value dash = zynkCreateString(&manager, " - ");
+    assert_equal_string(zynkStringReplace(&manager, str, comma, dash), "uno - dos - tres - cuatro", "zynkStringReplace: reemplazo más largo");
+    assert_equal_string(zynkStringReplace(&manager, str, comma, empty), "unodostrescuatro", "zynkStringReplace: reemplazo vacío");
+    assert_equal_string(zynkStringReplace(&manager, str, empty, dash), "uno, dos, tres, cuatro", "zynkStringReplace: patrón vacío copia la cadena");
+
+    section("nativas");
+    ZynkEnv *env = new_env(0);
+    init_native_funcs(&manager, env);
+    Value find_args[] = {str, comma, zynkNumber(1e30)};
+    assert_equal_number(call_native(env, "find", 3, find_args), -1, "find: desplazamiento enorme da -1");
+    find_args[2] = zynkNumber(9);
+    assert_equal_number(call_native(env, "find", 3, find_args), 14, "find: desde un desplazamiento");
+    assert_equal_number(call_native(env, "count", 2, find_args), 3, "count");
+    Value replace_args[] = {str, comma, one};
+    assert_equal_string(call_native(env, "replace", 3, replace_args), "uno,dos,tres,cuatro", "replace");
+
+    return test_end();
+}
@@ -0,0 +1,137 @@
+// Pruebas de zynkArraySort: orden total entre tipos, radix para números,
+// patrones que castigan al quicksort y comparadores nativos.
+// Compilar: gcc test-sort.c src/libzynk.a -o test-sort
+#include "test.h"
+
+static Value answer;
+static uint32_t calls;
+
+// ordena al revés
+static Value descending(ArenaManager *m, ZynkEnv *env, ZynkArray *args) {
+    (void)m; (void)env;
+    calls++;
+    return zynkBool(args->array[0].as.number > args->array[1].as.number);
+}
+
+// contesta con un string nuevo (retenido) en cada llamada
+static Value object_answer(ArenaManager *m, ZynkEnv *env, ZynkArray *args) {
+    (void)m; (void)env; (void)args;
+    return zynk_retain(answer);
+}
+
+// no es un orden: a veces sí, a veces no
+static Value random_answer(ArenaManager *m, ZynkEnv *env, ZynkArray *args) {
+    (void)m; (void)env; (void)args;
+    return zynkNumber(rand() % 3 - 1);
+}
+
+static Value numbers(size_t n, int pattern) {
+    Value arr = zynkCreateArray(&manager, (uint32_t)n);
+    for (size_t i = 0; i < n; ++i) {
+        double x;
+        switch (pattern) {
+            case 0: x = (double)i; break;                              // ordenado
+            case 1: x = (double)(n - i); break;                        // al revés
+            case 2: x = (double)(i % 3); break;                        // muchos iguales
+            case 3: x = (double)(i < n / 2 ? i : n - i); break;        // órgano
+            default: x = (double)(rand() % 1000) - 500.5; break;       // aleatorio
+        }
+        zynkArrayPush(&manager, arr, zynkNumber(x));
+    }
+    return arr;
+}
+
+static bool is_sorted(Value arr, bool reversed) {
+    ZynkArray *a = arr.as.obj->obj.array;
+    for (uint32_t i = 1; i < a->len; ++i) {
+        int c = zynkValuesCompare(a->array[i - 1], a->array[i]);
+        if (reversed ? c < 0 : c > 0) return false;
+    }
+    return true;
+}
+
+static double sum(Value arr) {
+    ZynkArray *a = arr.as.obj->obj.array;
+    double total = 0;
+    for (uint32_t i = 0; i < a->len; ++i) total += a->array[i].as.number;
+    return total;
+}
+
+int main() {
+    printf("--- Pruebas de ordenación ---\n");
+    test_init(16 * 1024 * 1024, 8192);
+
+    section("zynkValuesCompare");
+    Value str_a = zynkCreateString(&manager, "abc");
+    Value str_b = zynkCreateString(&manager, "abd");
+    Value str_prefix = zynkCreateString(&manager, "ab");
+    assert_true(zynkValuesCompare(zynkNull(), zynkBool(false)) < 0, "null antes que los booleanos");
+    assert_true(zynkValuesCompare(zynkBool(true), zynkNumber(-1e300)) < 0, "booleanos antes que los números");
+    assert_true(zynkValuesCompare(zynkNumber(1e300), zynkByte(0)) < 0, "números antes que los bytes");
+    assert_true(zynkValuesCompare(zynkByte(255), str_a) < 0, "bytes antes que los strings");
+    assert_true(zynkValuesCompare(zynkNumber(-0.0), zynkNumber(0)) < 0, "-0 antes que 0");
+    assert_true(zynkValuesCompare(zynkNumber(1.0 / 0.0), zynkNumber(0.0 / 0.0)) < 0, "NaN después de inf");
+    assert_true(zynkValuesCompare(str_a, str_b) < 0 && zynkValuesCompare(str_prefix, str_a) < 0, "strings por bytes, el prefijo primero");
+
+    section("patrones");
+    srand(3);
+    const size_t sizes[] = {0, 1, 2, 23, 24, 100, 255, 256, 5000};
+    bool ok = true;
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        for (int pattern = 0; pattern < 5; ++pattern) {
+            Value arr = numbers(sizes[s], pattern);
+            double before = sum(arr);
+            ok = ok && zynkArraySort(&manager, NULL, arr, zynkNull()) && is_sorted(arr, false) && sum(arr) == before;
+            zynk_release(arr, &manager);
+        }
+    }
+    assert_true(ok, "todos los tamaños y patrones quedan ordenados, sin perder elementos");
+
+    Value specials = zynkCreateArray(&manager, 300);
+    for (int i = 0; i < 300; ++i) {
+        double x = i % 4 == 0 ? 0.0 : i % 4 == 1 ? -0.0 : i % 4 == 2 ? 0.0 / 0.0 : -(double)i;
+        zynkArrayPush(&manager, specials, zynkNumber(x));
+    }
+    zynkArraySort(&manager, NULL, specials, zynkNull());
+    ZynkArray *sp = specials.as.obj->obj.array;
+    assert_true(is_sorted(specials, false) && sp->array[299].as.number != sp->array[299].as.number,
+                "radix: -0 antes que 0 y NaN al final");
+    zynk_release(specials, &manager);
+
+    Value mixed = zynkCreateArray(&manager, 8);
+    Value mixed_items[] = {str_b, zynkNumber(2), zynkNull(), str_a, zynkBool(true), zynkByte(1), zynkNumber(-2), zynkBool(false)};
+    for (int i = 0; i < 8; ++i) zynkArrayPush(&manager, mixed, mixed_items[i]);
+    zynkArraySort(&manager, NULL, mixed, zynkNull());
+    ZynkArray *mx = mixed.as.obj->obj.array;
+    assert_true(is_sorted(mixed, false) && mx->array[0].type == ZYNK_NULL && mx->array[6].as.obj == str_a.as.obj,
+                "tipos mezclados en el orden total");
+    zynk_release(mixed, &manager);
+
+    section("comparadores nativos");
+    ZynkEnv *env = new_env(0);
+    init_native_funcs(&manager, env);
+    Value desc = zynkCreateNativeFunction(&manager, "descending", (ZynkFuncPtr)descending);
+    Value arr = numbers(1000, 4);
+    ok = zynkArraySort(&manager, env, arr, desc);
+    assert_true(ok && is_sorted(arr, true) && calls > 0, "zynkArraySort: comparador descendente");
+    Value args[] = {arr};
+    assert_equal_bool(call_native(env, "sort", 1, args), true, "sort: sin comparador");
+    assert_true(is_sorted(arr, false), "sort: vuelve a orden ascendente");
+
+    answer = zynkCreateString(&manager, "no es un booleano");
+    uint32_t base = answer.as.obj->ref_count;
+    Value obj_cmp = zynkCreateNativeFunction(&manager, "object_answer", (ZynkFuncPtr)object_answer);
+    Value shuffled = numbers(500, 4);
+    zynkArraySort(&manager, env, shuffled, obj_cmp);
+    assert_true(answer.as.obj->ref_count == base, "un comparador que devuelve un objeto no lo pierde");
+
+    Value rnd_cmp = zynkCreateNativeFunction(&manager, "random_answer", (ZynkFuncPtr)random_answer);
+    Value chaos = numbers(5000, 4);
+    double before = sum(chaos);
+    zynkArraySort(&manager, env, chaos, rnd_cmp);
+    assert_true(sum(chaos) == before, "un comparador incoherente no pierde ni duplica elementos");
+
+    Value values[] = {arr, shuffled, chaos, desc, obj_cmp, rnd_cmp, answer, str_a, str_b, str_prefix};
+    for (int i = 0; i < 10; ++i) zynk_release(values[i], &manager);
+    return test_end();
+}
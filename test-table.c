@@ -0,0 +1,117 @@
+// Pruebas de la tabla de entornos (Swiss table): altas, bajas con lápidas,
+// claves duplicadas, bytes de control y búsqueda en los entornos de fuera.
+// Compilar: gcc test-table.c src/libzynk.a -o test-table
+#include "test.h"
+
+static void key_name(char *out, int i) {
+    snprintf(out, 32, "var_%d", i);
+}
+
+// los bytes de control cuadran con count y deleted, y la cola refleja el
+// primer grupo
+static bool ctrl_consistent(ZynkEnvTable *table) {
+    size_t full = 0, deleted = 0;
+    for (size_t i = 0; i < table->capacity; ++i) {
+        uint8_t c = table->ctrl[i];
+        if (c == ZYNK_CTRL_DELETED) deleted++;
+        else if (c != ZYNK_CTRL_EMPTY) {
+            full++;
+            ZynkEnvEntry *e = &table->entries[i];
+            if (e->name == NULL || (e->hash & 0x7F) != c) return false;
+        }
+    }
+    for (size_t i = 0; i < ZYNK_ENV_GROUP; ++i) {
+        if (table->ctrl[table->capacity + i] != table->ctrl[i]) return false;
+    }
+    return full == table->count - table->old_count && deleted == table->deleted;
+}
+
+static void finish_rehash(ZynkEnv *env) {
+    // cada Set mueve algunos slots viejos
+    for (int i = 0; i < 100000 && env->local->old_ctrl != NULL; ++i) zynkTableSet(&manager, env, "var_0", zynkNumber(0));
+}
+
+int main() {
+    printf("--- Pruebas de la tabla de entornos ---\n");
+    test_init(32 * 1024 * 1024, 16384);
+    char name[32];
+
+    section("altas y búsquedas");
+    ZynkEnv *env = new_env(16);
+    assert_true(env->local->capacity == 16, "capacidad mínima de un grupo");
+    bool ok = true;
+    for (int i = 0; i < 5000; ++i) {
+        key_name(name, i);
+        ok = ok && zynkTableNew(env, name, zynkNumber(i), &manager);
+    }
+    assert_true(ok && env->local->count == 5000, "5000 zynkTableNew");
+    finish_rehash(env);
+    assert_true(ctrl_consistent(env->local), "bytes de control coherentes tras crecer");
+    ok = true;
+    for (int i = 0; i < 5000; ++i) {
+        key_name(name, i);
+        Value v = zynkTableGet(env, name);
+        ok = ok && v.type == ZYNK_NUMBER && v.as.number == i;
+    }
+    assert_true(ok, "las 5000 claves se encuentran");
+    assert_is_null(zynkTableGet(env, "no_existe"), "una clave ausente da null");
+    assert_true(!zynkTableNew(env, "var_7", zynkNumber(0), &manager), "zynkTableNew rechaza una clave existente");
+    assert_true(zynkTableSet(&manager, env, "var_7", zynkNumber(70)), "zynkTableSet en una clave existente");
+    assert_equal_number(zynkTableGet(env, "var_7"), 70, "zynkTableSet cambia el valor");
+    assert_true(!zynkTableSet(&manager, env, "no_existe", zynkNumber(1)), "zynkTableSet no crea claves");
+
+    section("bajas y lápidas");
+    ok = true;
+    for (int i = 0; i < 5000; i += 2) {
+        key_name(name, i);
+        ok = ok && zynkTableDelete(env, name, &manager);
+    }
+    assert_true(ok && env->local->count == 2500, "borrar la mitad");
+    assert_true(!zynkTableDelete(env, "var_0", &manager), "borrar dos veces falla");
+    assert_true(ctrl_consistent(env->local), "bytes de control coherentes con lápidas");
+    // una clave detrás de una lápida no se duplica
+    assert_true(zynkTableNew(env, "var_0", zynkNumber(-1), &manager), "reinsertar una clave borrada");
+    assert_true(!zynkTableNew(env, "var_1", zynkNumber(-1), &manager), "una clave viva tras lápidas no se duplica");
+    ok = true;
+    for (int i = 0; i < 5000; ++i) {
+        key_name(name, i);
+        Value v = zynkTableGet(env, name);
+        if (i == 0) ok = ok && v.as.number == -1;
+        else if (i % 2 == 0) ok = ok && v.type == ZYNK_NULL;
+        else ok = ok && v.as.number == (i == 7 ? 70 : i);
+    }
+    assert_true(ok, "las vivas siguen, las borradas no");
+
+    section("zynkFindEntry");
+    ZynkEnvEntry *entry = zynkFindEntry(env, "var_1");
+    assert_true(entry != NULL && strcmp(entry->name, "var_1") == 0 && entry->value.as.number == 1, "devuelve la entrada viva");
+    size_t slot = (size_t)(entry - env->local->entries);
+    assert_true(slot < env->local->capacity && env->local->ctrl[slot] == (entry->hash & 0x7F), "la entrada tiene su byte de control");
+    size_t count = env->local->count;
+    assert_true(zynkFindEntry(env, "nueva") == NULL && env->local->count == count, "una clave ausente da NULL y no crea nada");
+
+    section("entornos anidados");
+    ZynkEnv inner;
+    inner.local = NULL;
+    zynkEnvInit(&inner, 16, env, &manager);
+    zynkTableNew(&inner, "var_1", zynkNumber(100), &manager);
+    assert_equal_number(zynkTableGet(&inner, "var_1"), 100, "el local tapa al de fuera");
+    assert_equal_number(zynkTableGet(&inner, "var_3"), 3, "se busca en el entorno de fuera");
+    zynkTableSet(&manager, &inner, "var_3", zynkNumber(33));
+    assert_equal_number(zynkTableGet(env, "var_3"), 33, "zynkTableSet escribe donde está la clave");
+    assert_true(zynkTableDelete(&inner, "var_1", &manager), "zynkTableDelete borra el local");
+    assert_true(!zynkTableDelete(&inner, "var_3", &manager), "zynkTableDelete no toca los de fuera");
+    assert_equal_number(zynkTableGet(&inner, "var_1"), 1, "tras borrarlo se ve el de fuera");
+
+    section("freeZynkTable libera los valores");
+    Value str = zynkCreateString(&manager, "valor");
+    zynkTableNew(&inner, "s", str, &manager);
+    assert_true(str.as.obj->ref_count == 2, "la tabla retiene el valor");
+    freeZynkTable(&manager, inner.local);
+    assert_true(str.as.obj->ref_count == 1, "freeZynkTable lo suelta");
+    zynk_release(str, &manager);
+
+    freeZynkTable(&manager, env->local);
+    free(env);
+    return test_end();
+}
@@ -0,0 +1,74 @@
+// Pruebas de las cadenas UTF-8: validación, longitud e índices en puntos de
+// código, con cadenas largas para cubrir los bloques de 16 y 64 bytes.
+// Compilar: gcc test-utf8.c src/libzynk.a -o test-utf8
+#include "test.h"
+
+static bool valid(const char *bytes, size_t len) {
+    return zynk_utf8_validate((const uint8_t *)bytes, len);
+}
+
+int main() {
+    printf("--- Pruebas de UTF-8 ---\n");
+    test_init(8 * 1024 * 1024, 4096);
+
+    section("zynk_utf8_validate");
+    assert_true(valid("hola", 4), "ASCII es válido");
+    assert_true(valid("\xC3\xB1", 2), "ñ de dos bytes es válida");
+    assert_true(valid("\xE2\x82\xAC", 3), "€ de tres bytes es válido");
+    assert_true(valid("\xF0\x9F\x98\x80", 4), "emoji de cuatro bytes es válido");
+    assert_true(!valid("\xC0\xAF", 2), "secuencia sobrelarga es inválida");
+    assert_true(!valid("\xED\xA0\x80", 3), "surrogate es inválido");
+    assert_true(!valid("\xF4\x90\x80\x80", 4), "más allá de U+10FFFF es inválido");
+    assert_true(!valid("\xE2\x82", 2), "secuencia truncada es inválida");
+    assert_true(!valid("\x80", 1), "byte de continuación suelto es inválido");
+
+    char long_text[200];
+    memset(long_text, 'a', sizeof(long_text));
+    assert_true(zynk_utf8_is_ascii((const uint8_t *)long_text, sizeof(long_text)), "zynk_utf8_is_ascii: 200 bytes ASCII");
+    long_text[150] = (char)0xC3;
+    long_text[151] = (char)0xB1;
+    assert_true(!zynk_utf8_is_ascii((const uint8_t *)long_text, sizeof(long_text)), "zynk_utf8_is_ascii: ve un byte alto tras tres bloques");
+    assert_true(valid(long_text, sizeof(long_text)), "zynk_utf8_validate: ñ al final de una cadena larga");
+    long_text[151] = 'a';
+    assert_true(!valid(long_text, sizeof(long_text)), "zynk_utf8_validate: error al final de una cadena larga");
+
+    section("longitud e índices");
+    // 20 veces "añ€😀": 4 puntos de código y 10 bytes por vuelta
+    char mixed[201];
+    for (int i = 0; i < 20; ++i) memcpy(mixed + i * 10, "a\xC3\xB1\xE2\x82\xAC\xF0\x9F\x98\x80", 10);
+    mixed[200] = '\0';
+    assert_true(zynk_utf8_count((const uint8_t *)mixed, 200) == 80, "zynk_utf8_count: 80 puntos de código en 200 bytes");
+    assert_true(zynk_utf8_offset((const uint8_t *)mixed, 200, 41) == 101, "zynk_utf8_offset: el punto 41 empieza en el byte 101");
+    assert_true(zynk_utf8_offset((const uint8_t *)mixed, 200, 80) == 200, "zynk_utf8_offset: pasado el final da len");
+
+    Value str = zynkCreateString(&manager, mixed);
+    assert_equal_number(zynkStringCodePointLen(str), 80, "zynkStringCodePointLen: cadena mixta");
+    assert_equal_string(zynkStringCodePointAt(&manager, str, 2), "\xE2\x82\xAC", "zynkStringCodePointAt: el tercero es €");
+    assert_equal_string(zynkStringCodePointAt(&manager, str, 79), "\xF0\x9F\x98\x80", "zynkStringCodePointAt: el último es el emoji");
+    assert_is_null(zynkStringCodePointAt(&manager, str, 80), "zynkStringCodePointAt: fuera de rango da null");
+    assert_equal_string(zynkStringCodePointSub(&manager, str, 1, 3), "\xC3\xB1\xE2\x82\xAC", "zynkStringCodePointSub: [1, 3)");
+    assert_equal_string(zynkStringCodePointSub(&manager, str, 78, 1000), "\xE2\x82\xAC\xF0\x9F\x98\x80", "zynkStringCodePointSub: el final se recorta");
+
+    Value ascii = zynkCreateString(&manager, "abcdef");
+    assert_equal_number(zynkStringCodePointLen(ascii), 6, "zynkStringCodePointLen: ASCII");
+    assert_true(zynkStringKind(ascii.as.obj->obj.string) == ZYNK_STR_ASCII, "zynkStringKind: recuerda que es ASCII");
+    assert_equal_string(zynkStringCodePointSub(&manager, ascii, 4, 2), "", "zynkStringCodePointSub: end < start da vacío");
+
+    Value bad = zynkCreateString(&manager, "a\xFF");
+    assert_is_null(zynkStringCodePointLen(bad), "zynkStringCodePointLen: UTF-8 inválido da null");
+
+    section("nativas utf8_*");
+    ZynkEnv *env = new_env(0);
+    init_native_funcs(&manager, env);
+    assert_equal_bool(call_native(env, "utf8_valid", 1, &str), true, "utf8_valid: cadena mixta");
+    assert_equal_bool(call_native(env, "utf8_valid", 1, &bad), false, "utf8_valid: cadena inválida");
+    assert_equal_number(call_native(env, "utf8_len", 1, &str), 80, "utf8_len");
+    Value index_args[] = {str, zynkNumber(3)};
+    assert_equal_string(call_native(env, "utf8_index", 2, index_args), "\xF0\x9F\x98\x80", "utf8_index");
+    index_args[1] = zynkNumber(-1);
+    assert_is_null(call_native(env, "utf8_index", 2, index_args), "utf8_index: índice negativo da null");
+    Value sub_args[] = {str, zynkNumber(76)};
+    assert_equal_string(call_native(env, "utf8_sub", 2, sub_args), "a\xC3\xB1\xE2\x82\xAC\xF0\x9F\x98\x80", "utf8_sub: sin end llega al final");
+
+    return test_end();
+}
@@ -0,0 +1,72 @@
+// Pruebas de value_inline.h: las versiones inline y las funciones
+// exportadas de la biblioteca dan lo mismo para cada par de valores.
+// Compilar: gcc test-values.c src/libzynk.a -o test-values
+#include "test.h"
+
+static bool same_value(Value a, Value b) {
+    if (a.type != b.type) return false;
+    if (a.type == ZYNK_NUMBER) return memcmp(&a.as.number, &b.as.number, sizeof(double)) == 0;
+    return a.type == ZYNK_NULL || zynkValuesEqual(a, b);
+}
+
+int main() {
+    printf("--- Pruebas de los operadores inline ---\n");
+    test_init(8 * 1024 * 1024, 4096);
+
+    Value str = zynkCreateString(&manager, "uno");
+    Value same_str = zynkCreateString(&manager, "uno");
+    Value other_str = zynkCreateString(&manager, "dos");
+    Value values[] = {
+        zynkNull(), zynkBool(false), zynkBool(true), zynkNumber(0), zynkNumber(-0.0), zynkNumber(1),
+        zynkNumber(-2.5), zynkNumber(1.0 / 0.0), zynkNumber(0.0 / 0.0), zynkByte(0), zynkByte(7),
+        str, same_str, other_str,
+    };
+    const int n = sizeof(values) / sizeof(values[0]);
+
+    section("constructores");
+    assert_true((zynkNull)().type == zynkNull().type, "zynkNull");
+    assert_true(zynkBool(true).as.boolean == (zynkBool)(true).as.boolean, "zynkBool");
+    assert_true(zynkNumber(4.5).as.number == (zynkNumber)(4.5).as.number, "zynkNumber");
+    assert_true(zynkByte(200).as.byte == (zynkByte)(200).as.byte, "zynkByte");
+
+    section("inline contra biblioteca");
+    bool compare = true, logic = true, arith = true;
+    for (int i = 0; i < n; ++i) {
+        Value a = values[i];
+        compare = compare && zynkValuesNot(a) == (zynkValuesNot)(a) && zynkValuesTrue(a) == (zynkValuesTrue)(a);
+        for (int j = 0; j < n; ++j) {
+            Value b = values[j];
+            compare = compare && zynkValuesEqual(a, b) == (zynkValuesEqual)(a, b) &&
+                      zynkValuesNotEqual(a, b) == (zynkValuesNotEqual)(a, b) &&
+                      zynkValuesLess(a, b) == (zynkValuesLess)(a, b) &&
+                      zynkValuesGreater(a, b) == (zynkValuesGreater)(a, b) &&
+                      zynkValuesLessEqual(a, b) == (zynkValuesLessEqual)(a, b) &&
+                      zynkValuesGreaterEqual(a, b) == (zynkValuesGreaterEqual)(a, b);
+            logic = logic && zynkValuesOr(a, b) == (zynkValuesOr)(a, b) && zynkValuesAnd(a, b) == (zynkValuesAnd)(a, b) &&
+                    zynkValuesXor(a, b) == (zynkValuesXor)(a, b) && zynkValuesNand(a, b) == (zynkValuesNand)(a, b) &&
+                    zynkValuesNor(a, b) == (zynkValuesNor)(a, b) && zynkValuesXnor(a, b) == (zynkValuesXnor)(a, b);
+            arith = arith && same_value(zynkValuesAdd(a, b), (zynkValuesAdd)(a, b)) &&
+                    same_value(zynkValuesSub(a, b), (zynkValuesSub)(a, b)) &&
+                    same_value(zynkValuesMul(a, b), (zynkValuesMul)(a, b)) &&
+                    same_value(zynkValuesDiv(a, b), (zynkValuesDiv)(a, b));
+        }
+    }
+    assert_true(compare, "comparaciones y verdad");
+    assert_true(logic, "operadores lógicos");
+    assert_true(arith, "aritmética, bit a bit");
+
+    section("casos concretos");
+    assert_true(zynkValuesEqual(str, same_str), "strings iguales en objetos distintos");
+    assert_true(!zynkValuesEqual(str, other_str), "strings distintos");
+    assert_true(zynkValuesEqual(zynkNumber(0), zynkNumber(-0.0)), "0 == -0");
+    assert_true(!zynkValuesEqual(zynkNumber(0.0 / 0.0), zynkNumber(0.0 / 0.0)), "NaN != NaN");
+    assert_true(!zynkValuesEqual(zynkNumber(7), zynkByte(7)), "número y byte no son iguales");
+    assert_is_null(zynkValuesAdd(zynkNumber(1), zynkByte(1)), "sumar número y byte da null");
+    assert_is_null(zynkValuesDiv(zynkNumber(1), zynkNumber(0)), "dividir entre 0 da null");
+    assert_true(zynkValuesTrue(str) && !zynkValuesTrue(zynkNumber(0)) && !zynkValuesTrue(zynkNull()), "verdad de objetos, 0 y null");
+
+    zynk_release(str, &manager);
+    zynk_release(same_str, &manager);
+    zynk_release(other_str, &manager);
+    return test_end();
+}
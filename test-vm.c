@@ -0,0 +1,147 @@
+// Pruebas de la máquina de registros: el verificador de zynkCreateFunction
+// rechaza código mal formado, y las funciones válidas suman, saltan, leen
+// y escriben globales, llaman y devuelven referencias propias.
+// Compilar: gcc test-vm.c src/libzynk.a -o test-vm
+#include "test.h"
+
+static Value make(uint32_t *code, uint32_t len, uint8_t arity, uint16_t registers, Value *constants, uint32_t constants_len) {
+    return zynkCreateFunction(&manager, "f", arity, registers, code, len, constants, constants_len);
+}
+
+int main() {
+    printf("--- Pruebas de la VM ---\n");
+    test_init(32 * 1024 * 1024, 16384);
+
+    ZynkEnv *global = new_env(64);
+    init_native_funcs(&manager, global);
+
+    section("verificador");
+    Value k[] = {zynkNumber(5)};
+    uint32_t add5[] = {ZYNK_ABX(ZYNK_OP_LOADK, 1, 0), ZYNK_ABC(ZYNK_OP_ADD, 0, 0, 1), ZYNK_ABC(ZYNK_OP_RETURN, 0, 0, 0)};
+    Value f = make(add5, 3, 1, 2, k, 1);
+    assert_true(f.type == ZYNK_OBJ && f.as.obj->type == ObjFunction, "código válido");
+    uint32_t bad_reg[] = {ZYNK_ABX(ZYNK_OP_LOADK, 2, 0), ZYNK_ABC(ZYNK_OP_RETURN, 0, 0, 0)};
+    assert_is_null(make(bad_reg, 2, 1, 2, k, 1), "un registro fuera de los de la función");
+    uint32_t bad_k[] = {ZYNK_ABX(ZYNK_OP_LOADK, 1, 1), ZYNK_ABC(ZYNK_OP_RETURN, 0, 0, 0)};
+    assert_is_null(make(bad_k, 2, 1, 2, k, 1), "una constante fuera del pool");
+    uint32_t bad_jump[] = {ZYNK_ABX(ZYNK_OP_JMP, 0, 5), ZYNK_ABC(ZYNK_OP_RETURN, 0, 0, 0)};
+    assert_is_null(make(bad_jump, 2, 1, 2, k, 1), "un salto fuera del código");
+    uint32_t no_return[] = {ZYNK_ABX(ZYNK_OP_LOADK, 1, 0)};
+    assert_is_null(make(no_return, 1, 1, 2, k, 1), "sin RETURN al final");
+    uint32_t bad_op[] = {ZYNK_OP_COUNT, ZYNK_ABC(ZYNK_OP_RETURN, 0, 0, 0)};
+    assert_is_null(make(bad_op, 2, 1, 2, k, 1), "un opcode desconocido");
+    uint32_t bad_global[] = {ZYNK_ABX(ZYNK_OP_GETGLOBAL, 1, 0), ZYNK_ABC(ZYNK_OP_RETURN, 0, 0, 0)};
+    assert_is_null(make(bad_global, 2, 1, 2, k, 1), "GETGLOBAL con una constante que no es un string");
+    uint32_t bad_call[] = {ZYNK_ABC(ZYNK_OP_CALL, 0, 1, 1), ZYNK_ABC(ZYNK_OP_RETURN, 0, 0, 0)};
+    assert_is_null(make(bad_call, 2, 1, 2, NULL, 0), "CALL con argumentos fuera de los registros");
+    assert_is_null(make(add5, 0, 1, 2, k, 1), "sin código");
+
+    section("ejecución");
+    zynkTableNew(global, "f", f, &manager);
+    Value arr = zynkCreateArray(&manager, 1);
+    zynkArrayPush(&manager, arr, zynkNumber(2));
+    assert_equal_number(zynkCallFunction(&manager, global, "f", arr), 7, "zynkCallFunction con un array");
+    Value one[] = {zynkNumber(1)};
+    assert_equal_number(zynkCallValue(&manager, global, f, 1, one), 6, "zynkCallValue con argv");
+    Value many[] = {zynkNumber(1), zynkNumber(100)};
+    assert_equal_number(zynkCallValue(&manager, global, f, 2, many), 6, "los argumentos de más se ignoran");
+    // max(a, b) con un salto
+    uint32_t max_code[] = {ZYNK_ABC(ZYNK_OP_LT, 2, 0, 1), ZYNK_ABX(ZYNK_OP_JMPIF, 2, 1), ZYNK_ABC(ZYNK_OP_RETURN, 0, 0, 0),
+                           ZYNK_ABC(ZYNK_OP_RETURN, 1, 0, 0)};
+    Value max = make(max_code, 4, 2, 3, NULL, 0);
+    Value ab[] = {zynkNumber(3), zynkNumber(8)}, ba[] = {zynkNumber(8), zynkNumber(3)};
+    assert_true(zynkCallValue(&manager, global, max, 2, ab).as.number == 8 &&
+                zynkCallValue(&manager, global, max, 2, ba).as.number == 8, "saltos condicionales");
+
+    section("globales y llamadas");
+    Value gk[] = {zynkCreateString(&manager, "contador"), zynkNumber(1), zynkCreateString(&manager, "len")};
+    // contador = contador + 1; return len(R0)
+    uint32_t inc_code[] = {ZYNK_ABX(ZYNK_OP_GETGLOBAL, 1, 0), ZYNK_ABX(ZYNK_OP_LOADK, 2, 1), ZYNK_ABC(ZYNK_OP_ADD, 1, 1, 2),
+                           ZYNK_ABX(ZYNK_OP_SETGLOBAL, 1, 0), ZYNK_ABX(ZYNK_OP_GETGLOBAL, 2, 2), ZYNK_ABC(ZYNK_OP_MOVE, 3, 0, 0),
+                           ZYNK_ABC(ZYNK_OP_CALL, 1, 2, 1), ZYNK_ABC(ZYNK_OP_RETURN, 1, 0, 0)};
+    Value inc = make(inc_code, 8, 1, 4, gk, 3);
+    zynk_release(gk[0], &manager);
+    zynk_release(gk[2], &manager);
+    zynkTableNew(global, "contador", zynkNumber(0), &manager);
+    Value word[] = {zynkCreateString(&manager, "hola")};
+    bool ok = true;
+    for (int i = 0; i < 10; ++i) ok = ok && zynkCallValue(&manager, global, inc, 1, word).as.number == 4;
+    assert_true(ok, "llama a un nativo desde la VM");
+    assert_equal_number(zynkTableGet(global, "contador"), 10, "GETGLOBAL y SETGLOBAL a través de su caché");
+    ZynkEnv local;
+    local.local = NULL;
+    zynkEnvInit(&local, 16, global, &manager);
+    zynkTableNew(&local, "contador", zynkNumber(100), &manager);
+    zynkCallValue(&manager, &local, inc, 1, word);
+    assert_true(zynkTableGet(&local, "contador").as.number == 101 && zynkTableGet(global, "contador").as.number == 10,
+                "en otro entorno la caché vuelve a buscar");
+    ZynkFramePool pool;
+    zynkFramePoolInit(&pool, &manager, 16, 1);
+    ZynkEnv a, b;
+    zynkFramePush(&pool, &a, global);
+    zynkFramePush(&pool, &b, global);
+    zynkFramePop(&pool, &b);
+    zynkTableNew(&a, "contador", zynkNumber(50), &manager);
+    zynkCallValue(&manager, &a, inc, 1, word);
+    zynkFramePop(&pool, &a); // el pool está lleno: se libera
+    zynkFramePush(&pool, &a, global);
+    zynkCallValue(&manager, &a, inc, 1, word);
+    assert_equal_number(zynkTableGet(global, "contador"), 11, "tras liberar el marco la caché da el global");
+    zynkFramePop(&pool, &a);
+    zynkFramePoolFree(&pool);
+
+    section("referencias");
+    Value sk[] = {zynkCreateString(&manager, "constante")};
+    uint32_t ret_k[] = {ZYNK_ABX(ZYNK_OP_LOADK, 0, 0), ZYNK_ABC(ZYNK_OP_RETURN, 0, 0, 0)};
+    Value sf = make(ret_k, 2, 0, 1, sk, 1);
+    assert_true(sk[0].as.obj->ref_count == 2, "la función retiene sus constantes");
+    ok = true;
+    for (int i = 0; i < 1000; ++i) {
+        Value s = zynkCallValue(&manager, global, sf, 0, NULL);
+        ok = ok && s.type == ZYNK_OBJ && s.as.obj == sk[0].as.obj;
+        zynk_release(s, &manager);
+    }
+    assert_true(ok && sk[0].as.obj->ref_count == 2, "RETURN entrega una referencia nueva");
+    zynk_release(sf, &manager);
+    assert_true(sk[0].as.obj->ref_count == 1, "liberar la función suelta las constantes");
+    uint32_t refs = word[0].as.obj->ref_count;
+    zynkCallValue(&manager, global, inc, 1, word);
+    assert_true(word[0].as.obj->ref_count == refs, "los argumentos salen como entraron");
+    // return get_index(R0, 0): el nativo saca un string de un array
+    Value ik[] = {zynkCreateString(&manager, "get_index"), zynkNumber(0)};
+    uint32_t first_code[] = {ZYNK_ABX(ZYNK_OP_GETGLOBAL, 1, 0), ZYNK_ABC(ZYNK_OP_MOVE, 2, 0, 0), ZYNK_ABX(ZYNK_OP_LOADK, 3, 1),
+                             ZYNK_ABC(ZYNK_OP_CALL, 1, 1, 2), ZYNK_ABC(ZYNK_OP_RETURN, 1, 0, 0)};
+    Value first = make(first_code, 5, 1, 4, ik, 2);
+    zynk_release(ik[0], &manager);
+    Value holder = zynkCreateArray(&manager, 1);
+    zynkArrayPush(&manager, holder, word[0]);
+    refs = word[0].as.obj->ref_count;
+    ok = true;
+    // más llamadas que ZYNK_JIT_THRESHOLD: pasa también por el JIT
+    for (int i = 0; i < 1500; ++i) {
+        Value s = zynkCallValue(&manager, global, first, 1, &holder);
+        ok = ok && s.type == ZYNK_OBJ && s.as.obj == word[0].as.obj && word[0].as.obj->ref_count == refs + 1;
+        zynk_release(s, &manager);
+    }
+    assert_true(ok && word[0].as.obj->ref_count == refs, "CALL a get_index devuelve una referencia nueva del elemento");
+    zynk_release(holder, &manager);
+    zynk_release(first, &manager);
+
+    section("recursión");
+    Value rk[] = {zynkCreateString(&manager, "sin_fin")};
+    uint32_t rec[] = {ZYNK_ABX(ZYNK_OP_GETGLOBAL, 1, 0), ZYNK_ABC(ZYNK_OP_CALL, 0, 1, 0), ZYNK_ABC(ZYNK_OP_RETURN, 0, 0, 0)};
+    Value rf = make(rec, 3, 0, 2, rk, 1);
+    zynk_release(rk[0], &manager);
+    zynkTableNew(global, "sin_fin", rf, &manager);
+    assert_is_null(zynkCallValue(&manager, global, rf, 0, NULL), "una recursión sin fin se corta en ZYNK_VM_MAX_DEPTH");
+
+    zynk_release(word[0], &manager);
+    zynk_release(sk[0], &manager);
+    zynk_release(arr, &manager);
+    zynk_release(max, &manager);
+    zynk_release(inc, &manager);
+    freeZynkTable(&manager, local.local);
+    freeZynkTable(&manager, global->local);
+    free(global);
+    return test_end();
+}
@@ -0,0 +1,93 @@
+#ifndef ZYNK_TEST
+#define ZYNK_TEST
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+// Ayudas comunes de las pruebas test-*.c: un ArenaManager listo para usar y
+// aserciones que cuentan los fallos, para que el programa termine con error
+// si alguna falla.
+#include "src/zynk.h"
+
+static ArenaManager manager;
+static int failures;
+
+static inline void test_init(size_t memory_size, size_t num_arenas) {
+    uint8_t *memory = malloc(memory_size);
+    Arena *arenas = malloc(sizeof(Arena) * num_arenas);
+    if (memory == NULL || arenas == NULL || !sysarena_init(&manager, memory, arenas, memory_size, num_arenas)) {
+        printf("Fatal: no se pudo inicializar sysarena.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+static inline void section(const char *name) {
+    printf("\n--- Prueba: %s ---\n", name);
+}
+
+static inline void assert_true(bool condition, const char *message) {
+    if (condition) {
+        printf("[EXITO] %s\n", message);
+    } else {
+        printf("[FALLO] %s\n", message);
+        failures++;
+    }
+}
+
+static inline void assert_equal_number(Value val, double expected, const char *message) {
+    if (val.type == ZYNK_NUMBER && val.as.number == expected) {
+        printf("[EXITO] %s (Valor: %g)\n", message, val.as.number);
+    } else {
+        printf("[FALLO] %s (Esperado: %g, Tipo Obtenido: %d, Valor Obtenido: %g)\n",
+               message, expected, val.type, val.type == ZYNK_NUMBER ? val.as.number : 0.0);
+        failures++;
+    }
+}
+
+static inline void assert_equal_bool(Value val, bool expected, const char *message) {
+    assert_true(val.type == ZYNK_BOOL && val.as.boolean == expected, message);
+}
+
+static inline void assert_is_null(Value val, const char *message) {
+    assert_true(val.type == ZYNK_NULL, message);
+}
+
+static inline void assert_equal_string(Value val, const char *expected, const char *message) {
+    bool ok = val.type == ZYNK_OBJ && val.as.obj != NULL && val.as.obj->type == ObjString &&
+              strcmp(val.as.obj->obj.string->string, expected) == 0;
+    if (ok) {
+        printf("[EXITO] %s (Valor: \"%s\")\n", message, expected);
+    } else {
+        printf("[FALLO] %s (Esperado: \"%s\")\n", message, expected);
+        failures++;
+    }
+}
+
+// entorno global nuevo, capacity 0 deja la capacidad por defecto
+static inline ZynkEnv *new_env(size_t capacity) {
+    ZynkEnv *env = malloc(sizeof(ZynkEnv));
+    if (env != NULL) env->local = NULL;
+    if (env == NULL || !zynkEnvInit(env, capacity == 0 ? TABLE_CAPACITY : capacity, NULL, &manager)) {
+        printf("Fatal: no se pudo crear el entorno.\n");
+        exit(EXIT_FAILURE);
+    }
+    return env;
+}
+
+// llama a una nativa registrada en env con argumentos en la pila
+static inline Value call_native(ZynkEnv *env, const char *name, uint32_t argc, Value *argv) {
+    return zynkCallValue(&manager, env, zynkTableGet(env, name), argc, argv);
+}
+
+static inline int test_end(void) {
+    if (failures == 0) {
+        printf("\n--- Todas las pruebas completadas ---\n");
+        return EXIT_SUCCESS;
+    }
+    printf("\n--- %d pruebas fallidas ---\n", failures);
+    return EXIT_FAILURE;
+}
+
+#endif